@@ -0,0 +1,175 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "addrindex.h"
+
+#include <atomic>
+#include <thread>
+
+#include "main.h"
+
+using namespace std;
+
+// keyids of the tx uids and of the receipt parties, receipts exist only with -genreceipt
+static bool GetTxAddrKeyIds(CBaseTx &tx, CCacheWrapper &cw, set<CKeyID> &keyIds) {
+    if (!tx.GetInvolvedKeyIds(cw, keyIds))
+        return false;
+
+    vector<CReceipt> receipts;
+    if (cw.txReceiptCache.GetTxReceipts(tx.GetHash(), receipts)) {
+        for (const auto &receipt : receipts) {
+            for (const CUserID *pUid : {&receipt.from_uid, &receipt.to_uid}) {
+                CKeyID keyId;
+                if (!pUid->IsEmpty() && cw.accountCache.GetKeyId(*pUid, keyId))
+                    keyIds.insert(keyId);
+            }
+        }
+    }
+    return true;
+}
+
+static bool SaveBlockAddrTxs(CBlock &block, CCacheWrapper &cw, CAddrTxDBCache &addrTxCache) {
+    const uint32_t height = block.GetHeight();
+    for (uint32_t index = 0; index < block.vptx.size(); ++index) {
+        CBaseTx &tx = *block.vptx[index];
+        set<CKeyID> keyIds;
+        if (!GetTxAddrKeyIds(tx, cw, keyIds)) {
+            LogPrint(BCLog::ERROR, "%s(), get involved keyids of tx failed! block=%d:%s, txid=%s\n", __FUNCTION__,
+                     height, block.GetHash().ToString(), tx.GetHash().ToString());
+            continue;
+        }
+
+        for (const auto &keyId : keyIds) {
+            if (!addrTxCache.SetAddrTx(keyId, height, index, tx.GetHash()))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool chain::ProcessBlockAddrTxs(CBlock &block, CCacheWrapper &cw, CValidationState &state) {
+    if (!SysCfg().IsAddrIndex())
+        return true;
+
+    if (!SaveBlockAddrTxs(block, cw, cw.addrTxCache))
+        return state.Abort(_("ConnectBlock() : failed to save address tx index"));
+
+    return true;
+}
+
+bool chain::InitAddrIndex() {
+    LOCK(cs_main);
+
+    bool fAddrIndex = SysCfg().GetBoolArg("-addrindex", DEFAULT_ADDR_INDEX);
+    bool fIndexed   = false;
+    pCdMan->pBlockCache->ReadFlag("addrindex", fIndexed);
+    SysCfg().SetAddrIndex(fAddrIndex);
+    LogPrint(BCLog::INFO, "%s(), address tx index %s\n", __FUNCTION__, fAddrIndex ? "enabled" : "disabled");
+
+    if (fAddrIndex == fIndexed)
+        return true;
+
+    if (fAddrIndex) {
+        // the genesis block is never indexed, blocks above the tip will be indexed by ConnectBlock
+        int32_t endHeight = chainActive.Height() + 1;
+        if (endHeight > 1 && !pCdMan->pAddrTxCache->SetBackfillRange(1, endHeight))
+            return ERRORMSG("%s(), save address tx index backfill range failed", __FUNCTION__);
+    } else {
+        pCdMan->pAddrTxCache->EraseBackfillRange();
+    }
+
+    if (!pCdMan->pBlockCache->WriteFlag("addrindex", fAddrIndex))
+        return ERRORMSG("%s(), save address tx index flag failed", __FUNCTION__);
+
+    pCdMan->pAddrTxCache->Flush();
+    pCdMan->pBlockCache->Flush();
+    return true;
+}
+
+static void ThreadAddrIndexBackfill() {
+    uint32_t nextHeight = 0;
+    uint32_t endHeight  = 0;
+    {
+        LOCK(cs_main);
+        if (!pCdMan->pAddrTxCache->GetBackfillRange(nextHeight, endHeight))
+            return;
+    }
+
+    const int32_t threads = std::max<int32_t>(1, SysCfg().GetArg("-addrindexthreads", DEFAULT_ADDR_INDEX_THREADS));
+    LogPrint(BCLog::INFO, "%s(), backfill address tx index of blocks [%u, %u) with %d threads\n", __FUNCTION__,
+             nextHeight, endHeight, threads);
+    int64_t beginTime = GetTimeMillis();
+
+    while (nextHeight < endHeight) {
+        boost::this_thread::interruption_point();
+
+        uint32_t batchEnd = std::min(endHeight, nextHeight + ADDR_INDEX_BACKFILL_BATCH);
+        vector<CBlockIndex *> blockIndexes;
+        {
+            LOCK(cs_main);
+            for (uint32_t height = nextHeight; height < batchEnd; ++height) {
+                CBlockIndex *pIndex = chainActive[height];
+                if (pIndex == nullptr)
+                    break;  // the chain was reorged to a lower tip
+                blockIndexes.push_back(pIndex);
+            }
+        }
+
+        // reading and deserializing blocks dominates the backfill, do it in parallel
+        vector<CBlock> blocks(blockIndexes.size());
+        std::atomic<bool> readFailed(false);
+        vector<std::thread> readers;
+        for (int32_t t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t]() {
+                for (size_t i = t; i < blockIndexes.size() && !readFailed; i += threads) {
+                    if (!ReadBlockFromDisk(blockIndexes[i], blocks[i]))
+                        readFailed = true;
+                }
+            });
+        }
+        for (auto &reader : readers)
+            reader.join();
+
+        if (readFailed) {
+            LogPrint(BCLog::ERROR, "%s(), read block failed, backfill stopped at height=%u\n", __FUNCTION__,
+                     nextHeight);
+            return;
+        }
+
+        {
+            LOCK(cs_main);
+            CCacheWrapper cw(pCdMan);
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                // the blocks reconnected after reading were indexed by ConnectBlock already
+                if (chainActive[blockIndexes[i]->height] != blockIndexes[i])
+                    continue;
+
+                if (!SaveBlockAddrTxs(blocks[i], cw, *pCdMan->pAddrTxCache)) {
+                    LogPrint(BCLog::ERROR, "%s(), save address tx index failed, backfill stopped at height=%u\n",
+                             __FUNCTION__, blockIndexes[i]->height);
+                    return;
+                }
+            }
+
+            nextHeight = blockIndexes.size() < batchEnd - nextHeight ? endHeight : batchEnd;
+            if (nextHeight < endHeight)
+                pCdMan->pAddrTxCache->SetBackfillRange(nextHeight, endHeight);
+            else
+                pCdMan->pAddrTxCache->EraseBackfillRange();
+            pCdMan->pAddrTxCache->Flush();
+        }
+
+        LogPrint(BCLog::DEBUG, "%s(), backfilled address tx index to height=%u\n", __FUNCTION__, nextHeight);
+    }
+
+    LogPrint(BCLog::INFO, "%s(), backfill address tx index done, %lldms\n", __FUNCTION__,
+             GetTimeMillis() - beginTime);
+}
+
+void chain::StartAddrIndexBackfill(boost::thread_group &threadGroup) {
+    if (!SysCfg().IsAddrIndex())
+        return;
+
+    threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "addrindex", &ThreadAddrIndexBackfill));
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+
+#ifndef CHAIN_ADDR_INDEX_H
+#define CHAIN_ADDR_INDEX_H
+
+#include "persistence/cachewrapper.h"
+
+#include <boost/thread.hpp>
+
+static const bool DEFAULT_ADDR_INDEX                = false;
+static const int32_t DEFAULT_ADDR_INDEX_THREADS     = 4;
+static const uint32_t ADDR_INDEX_BACKFILL_BATCH     = 1000;  // blocks of each backfill round
+
+namespace chain {
+
+    // save the address tx index of all txs in block, call in the tail of block executing
+    bool ProcessBlockAddrTxs(CBlock &block, CCacheWrapper &cw, CValidationState &state);
+
+    // apply -addrindex after the block index is loaded, schedule a backfill if the index is newly enabled
+    bool InitAddrIndex();
+
+    // backfill the address tx index of the blocks connected before -addrindex was enabled
+    void StartAddrIndexBackfill(boost::thread_group &threadGroup);
+};
+
+
+#endif //CHAIN_ADDR_INDEX_H
@@ -5,7 +5,9 @@
 
 #include "bloom.h"
 
+#include "commons/random.h"
 #include "crypto/hash.h"
+#include "crypto/siphash.h"
 #include "main.h"
 
 #define LN2SQUARED 0.4804530139182014246671025263266649717305529515945455
@@ -153,3 +155,89 @@ void CBloomFilter::Clear() {
     isFull  = false;
     isEmpty = true;
 }
+
+CRollingBloomFilter::CRollingBloomFilter(uint32_t nElements, double nFPRate) {
+    double logFPRate = log(nFPRate);
+    // the optimal number of hash functions is log(fpRate) / log(0.5), at most MAX_HASH_FUNCS
+    nHashFuncs = max(1, min((int32_t)round(logFPRate / log(0.5)), (int32_t)MAX_HASH_FUNCS));
+    // keep three generations of half the elements, the last two (>= nElements) always being complete
+    nEntriesPerGeneration = (nElements + 1) / 2;
+    uint32_t nMaxElements = nEntriesPerGeneration * 3;
+    // fpRate = (1 - exp(-nHashFuncs * nMaxElements / nFilterBits)) ^ nHashFuncs
+    uint32_t nFilterBits = (uint32_t)ceil(-1.0 * nHashFuncs * nMaxElements / log(1.0 - exp(logFPRate / nHashFuncs)));
+    data.resize(((nFilterBits + 63) / 64) << 1);
+    reset();
+}
+
+void CRollingBloomFilter::InsertHash(uint64_t hash) {
+    if (nEntriesThisGeneration == nEntriesPerGeneration) {
+        nEntriesThisGeneration = 0;
+        nGeneration++;
+        if (nGeneration == 4)
+            nGeneration = 1;
+
+        // wipe the positions of the oldest generation, whose number is taken by the new one
+        uint64_t nGenerationMask1 = 0 - (uint64_t)(nGeneration & 1);
+        uint64_t nGenerationMask2 = 0 - (uint64_t)(nGeneration >> 1);
+        for (uint32_t p = 0; p < data.size(); p += 2) {
+            uint64_t p1 = data[p], p2 = data[p + 1];
+            uint64_t mask = (p1 ^ nGenerationMask1) | (p2 ^ nGenerationMask2);
+            data[p]       = p1 & mask;
+            data[p + 1]   = p2 & mask;
+        }
+    }
+    nEntriesThisGeneration++;
+
+    uint32_t h1 = (uint32_t)hash, h2 = (uint32_t)(hash >> 32);
+    for (uint32_t n = 0; n < nHashFuncs; n++) {
+        uint32_t h   = h1 + n * h2;
+        uint32_t bit = h & 0x3F;
+        // the higher bits map h into [0, data.size()), the lowest bit of pos selects the word of the pair
+        uint32_t pos = ((uint64_t)h * data.size()) >> 32;
+        data[pos & ~1] = (data[pos & ~1] & ~((uint64_t)1 << bit)) | ((uint64_t)(nGeneration & 1)) << bit;
+        data[pos | 1]  = (data[pos | 1] & ~((uint64_t)1 << bit)) | ((uint64_t)(nGeneration >> 1)) << bit;
+    }
+}
+
+bool CRollingBloomFilter::ContainsHash(uint64_t hash) const {
+    uint32_t h1 = (uint32_t)hash, h2 = (uint32_t)(hash >> 32);
+    for (uint32_t n = 0; n < nHashFuncs; n++) {
+        uint32_t h   = h1 + n * h2;
+        uint32_t bit = h & 0x3F;
+        uint32_t pos = ((uint64_t)h * data.size()) >> 32;
+        // a position is set if it carries any generation number
+        if (!(((data[pos & ~1] | data[pos | 1]) >> bit) & 1))
+            return false;
+    }
+    return true;
+}
+
+void CRollingBloomFilter::insert(const vector<uint8_t>& vKey) {
+    InsertHash(CSipHasher(nKey0, nKey1).Write(vKey.data(), vKey.size()).Finalize());
+}
+
+void CRollingBloomFilter::insert(const uint256& hash) { InsertHash(SipHashUint256(nKey0, nKey1, hash)); }
+
+void CRollingBloomFilter::insert(const uint256& hash, uint32_t extra) {
+    InsertHash(SipHashUint256Extra(nKey0, nKey1, hash, extra));
+}
+
+bool CRollingBloomFilter::contains(const vector<uint8_t>& vKey) const {
+    return ContainsHash(CSipHasher(nKey0, nKey1).Write(vKey.data(), vKey.size()).Finalize());
+}
+
+bool CRollingBloomFilter::contains(const uint256& hash) const {
+    return ContainsHash(SipHashUint256(nKey0, nKey1, hash));
+}
+
+bool CRollingBloomFilter::contains(const uint256& hash, uint32_t extra) const {
+    return ContainsHash(SipHashUint256Extra(nKey0, nKey1, hash, extra));
+}
+
+void CRollingBloomFilter::reset() {
+    nKey0                  = GetRand(std::numeric_limits<uint64_t>::max());
+    nKey1                  = GetRand(std::numeric_limits<uint64_t>::max());
+    nEntriesThisGeneration = 0;
+    nGeneration            = 1;
+    std::fill(data.begin(), data.end(), 0);
+}
@@ -86,4 +86,43 @@ public:
     void Clear();
 };
 
+/**
+ * RollingBloomFilter is a probabilistic "keep track of the most recently inserted" set, used to remember
+ * what a peer already knows.
+ * It remembers at least nElements and at most 1.5 * nElements of the last inserted keys with the given
+ * false positive rate in a fixed amount of memory: every bit position carries a 2-bit generation number
+ * and the oldest of the three live generations is wiped when the current one is full.
+ * A key is hashed only once by SipHash with a random key, the positions are derived from it by double hashing.
+ */
+class CRollingBloomFilter {
+public:
+    CRollingBloomFilter(uint32_t nElements, double nFPRate);
+
+    void insert(const vector<uint8_t>& vKey);
+    void insert(const uint256& hash);
+    void insert(const uint256& hash, uint32_t extra);
+
+    bool contains(const vector<uint8_t>& vKey) const;
+    bool contains(const uint256& hash) const;
+    bool contains(const uint256& hash, uint32_t extra) const;
+
+    // forget all the keys and pick a new random SipHash key
+    void reset();
+
+    size_t GetMemoryUsage() const { return data.size() * sizeof(uint64_t); }
+
+private:
+    void InsertHash(uint64_t hash);
+    bool ContainsHash(uint64_t hash) const;
+
+    uint32_t nEntriesPerGeneration;
+    uint32_t nEntriesThisGeneration;
+    uint32_t nGeneration;
+    uint32_t nHashFuncs;
+    uint64_t nKey0;
+    uint64_t nKey1;
+    // bit pairs of (data[2k], data[2k + 1]) keep the generation numbers of 64 positions
+    vector<uint64_t> data;
+};
+
 #endif /* COIN_BLOOM_H */
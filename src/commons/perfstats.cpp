@@ -0,0 +1,57 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "perfstats.h"
+
+#include <algorithm>
+
+CPerfStats perfStats;
+
+void CPerfHistogram::Record(int64_t micros) {
+    uint64_t value = micros > 0 ? micros : 0;
+
+    // value in [2^(i-1), 2^i) goes to bucket i
+    uint32_t bucket = value == 0 ? 0 : std::min<uint32_t>(64 - __builtin_clzll(value), BUCKET_COUNT - 1);
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumMicros.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t prevMax = maxMicros.load(std::memory_order_relaxed);
+    while (value > prevMax && !maxMicros.compare_exchange_weak(prevMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t CPerfHistogram::GetPercentileMicros(double percentile) const {
+    uint64_t total = GetCount();
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(percentile * total);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += GetBucket(i);
+        if (seen > rank)
+            return GetBucketBound(i) != 0 ? GetBucketBound(i) : GetMaxMicros();
+    }
+    return GetMaxMicros();
+}
+
+CPerfHistogram &CPerfStats::GetNetMessage(const std::string &command) {
+    std::lock_guard<std::mutex> lock(cs_netMessages);
+    // the commands come from the peers, do not let them grow the map without a bound
+    auto it = netMessages.find(command);
+    if (it != netMessages.end())
+        return *it->second;
+
+    auto &pHistogram = netMessages[netMessages.size() < MAX_NET_MESSAGE_COMMANDS ? command : "other"];
+    if (!pHistogram)
+        pHistogram = std::make_shared<CPerfHistogram>();
+    return *pHistogram;
+}
+
+std::map<std::string, std::shared_ptr<CPerfHistogram> > CPerfStats::GetNetMessages() const {
+    std::lock_guard<std::mutex> lock(cs_netMessages);
+    return netMessages;
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef COMMONS_PERFSTATS_H
+#define COMMONS_PERFSTATS_H
+
+#include "persistence/dbconf.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Latency histogram of power of 2 buckets in microseconds: bucket 0 counts [0, 1us), bucket i counts
+ * [2^(i-1), 2^i) us and the last bucket counts everything above. Recording is lock free.
+ */
+class CPerfHistogram {
+public:
+    static const uint32_t BUCKET_COUNT = 24;  // the last finite bound is 2^22 us, about 4s
+
+    void Record(int64_t micros);
+
+    uint64_t GetCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t GetSumMicros() const { return sumMicros.load(std::memory_order_relaxed); }
+    uint64_t GetMaxMicros() const { return maxMicros.load(std::memory_order_relaxed); }
+    uint64_t GetBucket(uint32_t i) const { return buckets[i].load(std::memory_order_relaxed); }
+    // exclusive upper bound of the bucket in microseconds, 0 for the unbounded last bucket
+    static uint64_t GetBucketBound(uint32_t i) { return i + 1 < BUCKET_COUNT ? (uint64_t)1 << i : 0; }
+    // upper bound of the bucket holding the given percentile, e.g. 0.99
+    uint64_t GetPercentileMicros(double percentile) const;
+
+private:
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumMicros{0};
+    std::atomic<uint64_t> maxMicros{0};
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+};
+
+// Records the time until it goes out of scope, or until Stop(), into a histogram
+class CPerfTimer {
+public:
+    explicit CPerfTimer(CPerfHistogram &histogramIn)
+        : pHistogram(&histogramIn), start(std::chrono::steady_clock::now()) {}
+    ~CPerfTimer() { Stop(); }
+
+    int64_t Stop() {
+        int64_t micros =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        if (pHistogram != nullptr) {
+            pHistogram->Record(micros);
+            pHistogram = nullptr;
+        }
+        return micros;
+    }
+
+private:
+    CPerfHistogram *pHistogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Lookups of one kind of CCompositeKVCache, counted at every cache level
+struct CPerfCacheCounters {
+    std::atomic<uint64_t> hits{0};     // found in the data map of the level
+    std::atomic<uint64_t> misses{0};   // looked up further in the base cache or the db
+    std::atomic<uint64_t> dbReads{0};  // read from the db
+};
+
+// The pool of wasm linear memory allocators, see wasm::wasm_allocator_pool
+struct CPerfWasmAllocPool {
+    std::atomic<uint64_t> acquired{0};  // handed out to a wasm context
+    std::atomic<uint64_t> reused{0};    // of the acquired, taken from the pool instead of reserved anew
+    std::atomic<uint64_t> idle{0};      // in the pool now
+};
+
+/**
+ * Always-on performance counters of the node, exposed by the getperfstats RPC. The fixed counters are
+ * indexed by tx type or db key prefix so that the hot paths never look anything up by name.
+ */
+class CPerfStats {
+public:
+    static const uint32_t TX_TYPE_COUNT            = 256;
+    static const uint32_t MAX_NET_MESSAGE_COMMANDS = 64;  // the rest is counted as "other"
+
+    CPerfHistogram txCheck[TX_TYPE_COUNT];    // CheckTx() by tx type
+    CPerfHistogram txExecute[TX_TYPE_COUNT];  // ExecuteTx() by tx type
+    CPerfCacheCounters cache[dbk::PREFIX_COUNT + 1];
+
+    // ConnectBlock() phases and the whole ConnectTip()
+    CPerfHistogram blockCheck;
+    CPerfHistogram blockExecute;
+    CPerfHistogram blockUndoWrite;
+    CPerfHistogram blockFlush;
+    CPerfHistogram blockConnect;
+
+    CPerfHistogram mempoolAccept;
+    CPerfHistogram minerPack;
+
+    CPerfWasmAllocPool wasmAllocPool;
+
+    // processing time of a p2p message by command, created on the first message of a command
+    CPerfHistogram &GetNetMessage(const std::string &command);
+    std::map<std::string, std::shared_ptr<CPerfHistogram> > GetNetMessages() const;
+
+private:
+    mutable std::mutex cs_netMessages;
+    std::map<std::string, std::shared_ptr<CPerfHistogram> > netMessages;
+};
+
+extern CPerfStats perfStats;
+
+#endif  // COMMONS_PERFSTATS_H
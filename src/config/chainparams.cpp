@@ -430,6 +430,7 @@ CBaseParams::CBaseParams() {
     fReindex                = false;
     fBenchmark              = false;
     fTxIndex                = false;
+    fAddrIndex              = false;
     fLogFailures            = false;
     nTxCacheHeight          = 500;
     nTimeBestReceived       = 0;
@@ -65,6 +65,7 @@ protected:
     mutable bool fReindex;
     mutable bool fBenchmark;
     mutable bool fTxIndex;
+    mutable bool fAddrIndex;
     mutable bool fLogFailures;
     mutable bool fGenReceipt;
     mutable int64_t nTimeBestReceived;
@@ -100,6 +101,7 @@ public:
         te += strprintf("fReindex:%d\n",                            fReindex);
         te += strprintf("fBenchmark:%d\n",                          fBenchmark);
         te += strprintf("fTxIndex:%d\n",                            fTxIndex);
+        te += strprintf("fAddrIndex:%d\n",                          fAddrIndex);
         te += strprintf("fLogFailures:%d\n",                        fLogFailures);
         te += strprintf("nTimeBestReceived:%llu\n",                 nTimeBestReceived);
         te += strprintf("nBlockIntervalPreStableCoinRelease:%u\n",  nBlockIntervalPreStableCoinRelease);
@@ -153,6 +155,7 @@ public:
     bool IsReindex() const { return fReindex; }
     bool IsBenchmark() const { return fBenchmark; }
     bool IsTxIndex() const { return fTxIndex; }
+    bool IsAddrIndex() const { return fAddrIndex; }
     bool IsLogFailures() const { return fLogFailures; };
     bool IsGenReceipt() const { return fGenReceipt; };
     int64_t GetBestRecvTime() const { return nTimeBestReceived; }
@@ -162,6 +165,7 @@ public:
     void SetReIndex(bool flag) const { fReindex = flag; }
     void SetBenchMark(bool flag) const { fBenchmark = flag; }
     void SetTxIndex(bool flag) const { fTxIndex = flag; }
+    void SetAddrIndex(bool flag) const { fAddrIndex = flag; }
     void SetLogFailures(bool flag) const { fLogFailures = flag; }
     void SetGenReceipt(bool flag) const { fGenReceipt = flag; }
     void SetBestRecvTime(int64_t nTime) const { nTimeBestReceived = nTime; }
@@ -135,6 +135,10 @@ static const int32_t BLOCK_REWARD_MATURITY = 100;
 static const int32_t REG_ID_MATURITY = 100;
 /** NickId's mature period measured by blocks */
 static const int32_t NICK_ID_MATURITY = 100;
+/** Number of blocks kept on disk in addition to the ones connecting a block reads back, for reorgs and -checkblocks */
+static const int32_t MIN_BLOCKS_TO_KEEP = 288;
+/** Minimum -prune target in MiB, the blocks kept on disk and the current block file must fit in */
+static const uint64_t MIN_PRUNE_TARGET_MB = 550;
 
 static const uint16_t MAX_MINED_BLOCK_COUNT      = 100;        // maximun cache size for mined blocks
 static const int32_t MAX_RECENT_BLOCK_COUNT      = 10000;      // most recent block number limit
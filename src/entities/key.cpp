@@ -192,14 +192,22 @@ CKeyID CPubKey::GetKeyId() const { return CKeyID(Hash160(vch, vch + size())); }
 uint256 CPubKey::GetHash() const { return Hash(vch, vch + size()); }
 
 bool CPubKey::Verify(const uint256 &hash, const vector<uint8_t> &vchSig) const {
+    secp256k1_pubkey pubkey;
+    if (!Parse(pubkey))
+        return false;
+
+    return Verify(pubkey, hash, vchSig);
+}
+
+bool CPubKey::Parse(secp256k1_pubkey &pubkey) const {
     if (!IsValid())
         return false;
 
-    secp256k1_pubkey pubkey;
+    return secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkey, vch, size());
+}
+
+bool CPubKey::Verify(const secp256k1_pubkey &pubkey, const uint256 &hash, const vector<uint8_t> &vchSig) {
     secp256k1_ecdsa_signature sig;
-    if (!secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkey, vch, size())) {
-        return false;
-    }
     if (!ecdsa_signature_parse_der_lax(secp256k1_context_verify, &sig, vchSig.data(), vchSig.size())) {
         return false;
     }
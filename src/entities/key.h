@@ -206,6 +206,12 @@ public:
     // If this public key is not fully valid, the return value will be false.
     bool Verify(const uint256 &hash, const vector<uint8_t> &vchSig) const;
 
+    // Parse into the secp256k1 representation, which decompresses the key.
+    bool Parse(secp256k1_pubkey &pubkey) const;
+
+    // Verify a DER signature with a key already parsed by Parse().
+    static bool Verify(const secp256k1_pubkey &pubkey, const uint256 &hash, const vector<uint8_t> &vchSig);
+
     // Recover a public key from a compact signature.
     bool RecoverCompact(const uint256 &hash, const vector<uint8_t> &vchSig);
 
@@ -159,6 +159,7 @@ bool CKeyStore::GetPubKey(const CKeyID& address, CPubKey& vchPubKeyOut, bool IsM
 bool CBasicKeyStore::AddKeyCombi(const CKeyID& keyId, const CKeyCombi& keyCombi) {
     LOCK(cs_KeyStore);
     mapKeys[keyId] = keyCombi;
+    setKeyIds.insert(keyId);
     return true;
 }
 
@@ -7,6 +7,7 @@
 #define ENTITIES_KEYSTORE_H
 
 #include <set>
+#include <unordered_set>
 #include "commons/json/json_spirit_utils.h"
 #include "commons/json/json_spirit_value.h"
 #include "commons/json/json_spirit_writer_template.h"
@@ -88,14 +89,32 @@ public:
 typedef map<CKeyID, CKeyCombi> KeyMap;
 typedef map<CKeyID, CMulsigScript> ScriptMap;
 
+// key ids are hashes, so any 8 bytes of them make a good hash
+struct CKeyIDHasher {
+    size_t operator()(const CKeyID &keyId) const {
+        size_t hash;
+        memcpy(&hash, keyId.begin(), sizeof(hash));
+        return hash;
+    }
+};
+typedef std::unordered_set<CKeyID, CKeyIDHasher> KeyIdSet;
+
 /** Basic key store, that keeps keys in an address->secret map */
 class CBasicKeyStore : public CKeyStore {
 protected:
     KeyMap mapKeys;
     ScriptMap mapScripts;
+    // key ids of the plain and the encrypted keys, a cheap prefilter of HaveKey() when matching the
+    // txs of a block against a wallet of many keys. It may still hold a removed key.
+    KeyIdSet setKeyIds;
 
 public:
     bool AddKeyCombi(const CKeyID &keyId, const CKeyCombi &keyCombi);
+    // false if the key is surely not in the store
+    bool MayHaveKey(const CKeyID &keyId) const {
+        LOCK(cs_KeyStore);
+        return setKeyIds.count(keyId) > 0;
+    }
     bool HaveKey(const CKeyID &address) const {
         bool result;
         {
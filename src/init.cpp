@@ -14,13 +14,19 @@
 #include "p2p/addrman.h"
 
 #include "rpc/core/rpcserver.h"
+#include "rpc/core/rpcstreamwriter.h"
 #include "vm/luavm/lua/lua.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "main.h"
 #include "miner/miner.h"
+#include "miner/dexmatcher.h"
+#include "chain/addrindex.h"
 #include "net.h"
+#include "p2p/blockencodings.h"
 #include "persistence/blockdb.h"
+#include "persistence/blockindexstore.h"
+#include "persistence/snapshot.h"
 #include "persistence/accountdb.h"
 #include "persistence/txdb.h"
 #include "persistence/contractdb.h"
@@ -132,12 +138,16 @@ void Shutdown() {
     StopRPCServer();
 
     GenerateCoinBlock(false, nullptr, 0);
+    GenerateDexSettleTxs(false, nullptr);
     StartCommonGeneration(0, 0);
     StartContractGeneration("", 0, 0);
 
     StopNode();
     UnregisterNodeSignals(GetNodeSignals());
 
+    if (SysCfg().GetBoolArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL))
+        DumpMempool(mempool);
+
     {
         LOCK(cs_main);
 
@@ -148,6 +158,11 @@ void Shutdown() {
 
         if (pCdMan != nullptr) {
             pCdMan->Flush();
+            if (chainActive.Tip() != nullptr &&
+                !pCdMan->pTxCache->Dump(GetDataDir() / TX_CACHE_FILE_NAME, chainActive.Tip()->GetBlockHash()))
+                LogPrint(BCLog::ERROR, "Failed to write transaction memory cache\n");
+            if (!WriteBlockIndexFile(GetDataDir() / BLOCK_INDEX_FILE_NAME, pCdMan->pBlockCache->GetBestBlockHash()))
+                LogPrint(BCLog::ERROR, "Failed to write block index file\n");
             delete pCdMan;
             pCdMan = nullptr;
         }
@@ -164,6 +179,7 @@ void Shutdown() {
     ECC_Stop();
 
     LogPrint(BCLog::INFO, "Shutdown() : done\n");
+    LogInstance().StopAsyncLogging();
 }
 
 //
@@ -175,6 +191,7 @@ void HandleSIGTERM(int32_t) {
 
 void HandleSIGHUP(int32_t) {
     fReopenDebugLog = true;
+    LogInstance().m_reopen_file = true;
 }
 
 bool static InitError(const string &str) {
@@ -200,6 +217,7 @@ string HelpMessage() {
     strUsage += "  -?                     " + _("This help message") + "\n";
     strUsage += "  -alertnotify=<cmd>     " + _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)") + "\n";
     strUsage += "  -blocknotify=<cmd>     " + _("Execute command when the best block changes (%s in cmd is replaced by block hash)") + "\n";
+    strUsage += "  -blockreadthreads=<n>  " + strprintf(_("Number of threads reading blocks at startup (default: %d)"), DEFAULT_BLOCK_READ_THREADS) + "\n";
     strUsage += "  -checkblocks=<n>       " + _("How many blocks to check at startup (default: 288, 0 = all)") + "\n";
     strUsage += "  -checklevel=<n>        " + _("How thorough the block verification of -checkblocks is (0-4, default: 3)") + "\n";
     strUsage += "  -conf=<file>           " + _("Specify configuration file (default: ") + IniCfg().GetCoinName() + ".conf)" + "\n";
@@ -209,9 +227,16 @@ string HelpMessage() {
     strUsage += "  -datadir=<dir>         " + _("Specify data directory") + "\n";
     strUsage += "  -dbcache=<n>           " + strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), MIN_DB_CACHE, MAX_DB_CACHE, DEFAULT_DB_CACHE) + "\n";
     strUsage += "  -loadblock=<file>      " + _("Imports blocks from external blk000??.dat file") + " " + _("on startup") + "\n";
+    strUsage += "  -loadsnapshot=<file>   " + _("Bootstrap the empty data directory from a state snapshot of dumpstatesnapshot") + " " + _("on startup") + "\n";
+    strUsage += "  -mempooldumpinterval=<n> " + strprintf(_("Dump the mempool to mempool.dat every <n> seconds, 0 to dump only on shutdown (default: %d)"), DEFAULT_MEMPOOL_DUMP_INTERVAL) + "\n";
+    strUsage += "  -persistmempool        " + strprintf(_("Save the mempool to mempool.dat and reload it on startup (default: %u)"), DEFAULT_PERSIST_MEMPOOL) + "\n";
     strUsage += "  -pid=<file>            " + _("Specify pid file (default: coin.pid)") + "\n";
+    strUsage += "  -prune=<n>             " + strprintf(_("Delete the block and undo files of finalized blocks to keep them under <n> MiB (0 = disabled, minimum: %u). The txs of the deleted blocks can no longer be read, by the RPCs nor by contracts"), MIN_PRUNE_TARGET_MB) + "\n";
     strUsage += "  -reindex               " + _("Rebuild block chain index from current blk000??.dat files") + " " + _("on startup") + "\n";
+    strUsage += "  -snapshothash=<hash>   " + _("Trusted manifest hash the -loadsnapshot file must match") + "\n";
     strUsage += "  -txindex               " + _("Maintain a full transaction index (default: 0)") + "\n";
+    strUsage += "  -addrindex             " + _("Maintain an address to transaction index, backfilled in background when enabled on an existing chain (default: 0)") + "\n";
+    strUsage += "  -addrindexthreads=<n>  " + strprintf(_("Number of threads reading blocks to backfill the address index (default: %d)"), DEFAULT_ADDR_INDEX_THREADS) + "\n";
     strUsage += "  -logfailures           " + _("Log failures into level db in detail (default: 0)") + "\n";
     strUsage += "  -genreceipt               " + _("Whether generate receipt(default: 0)") + "\n";
 
@@ -219,6 +244,7 @@ string HelpMessage() {
     strUsage += "  -addnode=<ip>          " + _("Add a node to connect to and attempt to keep the connection open") + "\n";
     strUsage += "  -banscore=<n>          " + _("Threshold for disconnecting misbehaving peers (default: 100)") + "\n";
     strUsage += "  -bantime=<n>           " + _("Number of seconds to keep misbehaving peers from reconnecting (default: 86400)") + "\n";
+    strUsage += "  -compactblocks         " + strprintf(_("Relay new blocks to and from peers by compact blocks rebuilt from the mempool (default: %u)"), DEFAULT_COMPACT_BLOCKS) + "\n";
     strUsage += "  -bind=<addr>           " + _("Bind to given address and always listen on it. Use [host]:port notation for IPv6") + "\n";
     strUsage += "  -connect=<ip>          " + _("Connect only to the specified node(s)") + "\n";
     strUsage += "  -discover              " + _("Discover own IP address (default: 1 when listening and no -externalip)") + "\n";
@@ -251,6 +277,7 @@ string HelpMessage() {
     strUsage += "  -disablewallet         " + _("Do not load the wallet and disable wallet RPC calls") + "\n";
     strUsage += "  -genblock              " + _("Generate blocks (default: 0)") + "\n";
     strUsage += "  -genblocklimit=<n>     " + _("Set the processor limit for when generation is on (-1 = unlimited, default: -1)") + "\n";
+    strUsage += "  -pbftverifythreads=<n> " + strprintf(_("Number of threads verifying the received pbft messages (0 = in the message handler, default: %d)"), DEFAULT_PBFT_VERIFY_THREADS) + "\n";
     strUsage += "  -keypool=<n>           " + _("Set key pool size to <n> (default: 100)") + "\n";
     strUsage += "  -paytxfee=<amt>        " + _("Fee per kB to add to transactions you send") + "\n";
     strUsage += "  -rescan                " + _("Rescan the block chain for missing wallet transactions") + " " + _("on startup") + "\n";
@@ -270,6 +297,7 @@ string HelpMessage() {
         strUsage += "  -dropmessagestest=<n>  " + _("Randomly drop 1 of every <n> network messages") + "\n";
         strUsage += "  -fuzzmessagestest=<n>  " + _("Randomly fuzz 1 of every <n> network messages") + "\n";
         strUsage += "  -flushwallet           " + _("Run a thread to flush wallet periodically (default: 1)") + "\n";
+        strUsage += "  -asyncwalletnotify     " + strprintf(_("Sync new blocks into the wallet on a dedicated thread, off block validation (default: %u)"), DEFAULT_ASYNC_WALLET_NOTIFY) + "\n";
     }
     strUsage += "  -debug=<category>      " + _("Output debugging information (default: 0, supplying <category> is optional)") + "\n";
     strUsage += "                         " + _("If <category> is not supplied, output all debugging information.") + "\n";
@@ -277,9 +305,14 @@ string HelpMessage() {
     strUsage += " addrman, alert, coindb, db, lock, rand, rpc, selectcoins, mempool, net";
     strUsage += "  -help-debug            " + _("Show all debugging options (usage: --help -help-debug)") + "\n";
     strUsage += "  -logtimestamps         " + _("Prepend debug output with timestamp (default: 1)") + "\n";
+    strUsage += "  -logasync              " + strprintf(_("Write the debug output on a dedicated thread (default: %u)"), DEFAULT_LOGASYNC) + "\n";
+    strUsage += "  -logasyncqueue=<n>     " + strprintf(_("Queue up to <n> log records for the async log writer (default: %u)"), DEFAULT_LOGASYNC_QUEUE) + "\n";
+    strUsage += "  -logasyncpolicy=<policy> " + strprintf(_("Either block the logging thread or drop the record when the async log queue is full, <policy> can be: block, drop (default: %s)"), DEFAULT_LOGASYNC_POLICY) + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
         strUsage += "  -limitfreerelay=<n>    " + _("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default:15)") + "\n";
         strUsage += "  -maxsigcachesize=<n>   " + _("Limit size of signature cache to <n> entries (default: 50000)") + "\n";
+        strUsage += "  -maxpubkeycachesize=<n> " + strprintf(_("Limit size of parsed public key cache to <n> entries (default: %d)"), DEFAULT_MAX_PUBKEY_CACHE_SIZE) + "\n";
+        strUsage += "  -lockprofiling         " + _("Profile the wait and hold times of the locks per acquisition site from startup, see getlockstats (default: 0)") + "\n";
     }
     strUsage += "  -logprinttoconsole     " + _("Send trace/debug info to console instead of debug.log file") + "\n";
     if (SysCfg().GetBoolArg("-help-debug", false)) {
@@ -296,6 +329,9 @@ string HelpMessage() {
 
     strUsage += "\n" + _("Block creation options:") + "\n";
     strUsage += "  -blockmaxsize=<n>      " + strprintf(_("Set maximum block size in bytes (default: %d)"), DEFAULT_BLOCK_MAX_SIZE) + "\n";
+    strUsage += "  -dexmatch              " + _("Run the built-in dex matching engine and submit settle txs (default: 0)") + "\n";
+    strUsage += "  -dexmatchbatchsize=<n> " + strprintf(_("Max deal items of each settle tx (default: %u)"), DEFAULT_DEX_MATCH_BATCH) + "\n";
+    strUsage += "  -dexmatchmaxtxs=<n>    " + strprintf(_("Max settle txs submitted for each new block (default: %u)"), DEFAULT_DEX_MATCH_TXS) + "\n";
 
     strUsage += "\n" + _("RPC server options:") + "\n";
     strUsage += "  -rpcserver             " + _("Accept command line and JSON-RPC commands") + "\n";
@@ -304,6 +340,8 @@ string HelpMessage() {
     strUsage += "  -rpcport=<port>        " + _("Listen for JSON-RPC connections on <port> (default: 8332 or testnet: 18332)") + "\n";
     strUsage += "  -rpcallowip=<ip>       " + _("Allow JSON-RPC connections from specified IP address") + "\n";
     strUsage += "  -rpcthreads=<n>        " + _("Set the number of threads to service RPC calls (default: 4)") + "\n";
+    strUsage += "  -rpcbatchconcurrency=<n> " + strprintf(_("Max threads executing the read-only requests of one JSON-RPC batch, 1 to disable (default: %d)"), DEFAULT_RPC_BATCH_CONCURRENCY) + "\n";
+    strUsage += "  -rpcstreamchunksize=<n> " + strprintf(_("Send large results of streaming RPC calls as chunked replies of <n> bytes, 0 to disable (default: %u)"), DEFAULT_RPC_STREAM_CHUNK_SIZE) + "\n";
 
     strUsage += "\n" + _("RPC SSL options: (see the Coin Wiki for SSL setup instructions)") + "\n";
     strUsage += "  -rpcssl                                  " + _("Use OpenSSL (https) for JSON-RPC connections") + "\n";
@@ -377,6 +415,44 @@ void ThreadImport(vector<boost::filesystem::path> vImportFiles) {
             LogPrint(BCLog::INFO, "Warning: Could not open blocks file %s\n", path.string());
         }
     }
+
+    if (SysCfg().GetBoolArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
+        CMempoolLoadStats stats;
+        LoadMempool(mempool, stats);
+    }
+}
+
+void ThreadDumpMempool(int64_t nInterval) {
+    RenameThread("coin-mempooldump");
+
+    while (true) {
+        MilliSleep(nInterval * 1000);
+        DumpMempool(mempool);
+    }
+}
+
+// elapsed milliseconds of the startup phases, in the order they are run
+static vector<pair<string, int64_t>> startupPhaseTimes;
+
+static void AddStartupPhaseTime(const string &phase, int64_t nStartTime) {
+    int64_t nElapsed = GetTimeMillis() - nStartTime;
+    for (auto &item : startupPhaseTimes) {
+        if (item.first == phase) {
+            item.second += nElapsed;
+            return;
+        }
+    }
+    startupPhaseTimes.emplace_back(phase, nElapsed);
+}
+
+static void LogStartupPhaseTimes() {
+    string strTimes;
+    int64_t nTotal = 0;
+    for (const auto &item : startupPhaseTimes) {
+        strTimes += strprintf(" %s=%dms", item.first, item.second);
+        nTotal += item.second;
+    }
+    LogPrint(BCLog::INFO, "Startup phase timings:%s total=%dms\n", strTimes, nTotal);
 }
 
 /** Initialize Coin.
@@ -522,6 +598,17 @@ bool AppInit(boost::thread_group &threadGroup) {
     // if (GetBoolArg("-shrinkdebugfile", !fDebug))
     //     ShrinkDebugFile();
 
+    if (SysCfg().GetBoolArg("-logasync", DEFAULT_LOGASYNC)) {
+        string policy = SysCfg().GetArg("-logasyncpolicy", DEFAULT_LOGASYNC_POLICY);
+        if (policy != "block" && policy != "drop")
+            return InitError(strprintf(_("Invalid -logasyncpolicy=%s, it can be: block, drop"), policy));
+
+        int64_t queueSize = SysCfg().GetArg("-logasyncqueue", DEFAULT_LOGASYNC_QUEUE);
+        LogInstance().StartAsyncLogging(std::max<int64_t>(1024, std::min<int64_t>(queueSize, 1 << 24)), policy == "drop");
+    }
+
+    fLockProfiling = SysCfg().GetBoolArg("-lockprofiling", false);
+
      if (!LogInstance().m_log_timestamps)
         LogPrint(BCLog::INFO, "Startup time: %s\n", FormatISO8601DateTime(GetTime()));
 
@@ -659,6 +746,18 @@ bool AppInit(boost::thread_group &threadGroup) {
 
     SysCfg().SetReIndex(SysCfg().GetBoolArg("-reindex", false));
 
+    int64_t nPruneArg = SysCfg().GetArg("-prune", 0);
+    if (nPruneArg < 0)
+        return InitError(_("-prune cannot be negative"));
+    if (nPruneArg > 0) {
+        if ((uint64_t)nPruneArg < MIN_PRUNE_TARGET_MB)
+            return InitError(strprintf(_("-prune is below the minimum of %u MiB"), MIN_PRUNE_TARGET_MB));
+
+        fPruneMode   = true;
+        nPruneTarget = (uint64_t)nPruneArg << 20;
+        LogPrint(BCLog::INFO, "Prune mode enabled, the block files are kept under %d MiB\n", nPruneArg);
+    }
+
     SysCfg().SetLogFailures(SysCfg().GetBoolArg("-logfailures", false));
 
     SysCfg().SetGenReceipt(SysCfg().GetBoolArg("-genreceipt", false));
@@ -676,6 +775,23 @@ bool AppInit(boost::thread_group &threadGroup) {
         std::cout << "load wallet failed: " << e.what() << std::endl;
     }
 
+    if (SysCfg().IsArgCount("-loadsnapshot")) {
+        filesystem::path snapshotPath = SysCfg().GetArg("-loadsnapshot", "");
+        if (SysCfg().IsReindex())
+            return InitError(_("-loadsnapshot is incompatible with -reindex"));
+
+        if (filesystem::exists(blocksDir / "blk00000.dat")) {
+            LogPrint(BCLog::INFO, "The data directory is not empty, ignore -loadsnapshot=%s\n", snapshotPath.string());
+        } else {
+            int64_t nSnapshotStart = GetTimeMillis();
+            CImportingNow imp;
+            CStateSnapshotManifest manifest;
+            if (!LoadStateSnapshot(snapshotPath, uint256S(SysCfg().GetArg("-snapshothash", "")), manifest))
+                return InitError(strprintf(_("Failed to load the state snapshot %s"), snapshotPath.string()));
+            AddStartupPhaseTime("loadsnapshot", nSnapshotStart);
+        }
+    }
+
     int64_t nStart = GetTimeMillis();
     bool fLoaded   = false;
     while (!fLoaded) {
@@ -716,7 +832,12 @@ bool AppInit(boost::thread_group &threadGroup) {
                     break;
                 }
 
-                if (!VerifyDB(SysCfg().GetArg("-checklevel", 3), SysCfg().GetArg("-checkblocks", 288))) {
+                AddStartupPhaseTime("loadblockindex", nStart);
+                nStart = GetTimeMillis();
+                bool fVerified = VerifyDB(SysCfg().GetArg("-checklevel", 3), SysCfg().GetArg("-checkblocks", 288));
+                AddStartupPhaseTime("verifydb", nStart);
+                nStart = GetTimeMillis();
+                if (!fVerified) {
                     strLoadError = _("Corrupted block database detected");
                     break;
                 }
@@ -750,7 +871,11 @@ bool AppInit(boost::thread_group &threadGroup) {
         return false;
     }
 
-    LogPrint(BCLog::INFO, "Build %lu block indexes into memory (%lldms)\n", mapBlockIndex.size(), GetTimeMillis() - nStart);
+    AddStartupPhaseTime("loadblockindex", nStart);
+    LogPrint(BCLog::INFO, "Build %lu block indexes into memory\n", mapBlockIndex.size());
+
+    if (!chain::InitAddrIndex())
+        return InitError(_("Error initializing address tx index"));
 
     if (SysCfg().GetBoolArg("-printblockindex", false) || SysCfg().GetBoolArg("-printblocktree", false)) {
         PrintBlockTree();
@@ -760,7 +885,7 @@ bool AppInit(boost::thread_group &threadGroup) {
     if (SysCfg().IsArgCount("-printblock")) {
         string strMatch = SysCfg().GetArg("-printblock", "");
         int32_t nFound      = 0;
-        for (map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi) {
+        for (BlockMap::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi) {
             uint256 hash = (*mi).first;
             if (strncmp(hash.ToString().c_str(), strMatch.c_str(), strMatch.size()) == 0) {
                 CBlockIndex *pIndex = (*mi).second;
@@ -778,50 +903,59 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
 
     // scan for better chains in the block chain database, that are not yet connected in the active best chain
+    nStart = GetTimeMillis();
     CValidationState state;
     if (!ActivateBestChain(state))
         return InitError("Failed to connect best block");
-
-    nStart                   = GetTimeMillis();
-    CBlockIndex *pBlockIndex = chainActive.Tip();
-    int32_t nCacheHeight     = SysCfg().GetTxCacheHeight();
-    int32_t nCount           = 0;
-    CBlock block;
-    while (pBlockIndex && nCacheHeight-- > 0) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
+    AddStartupPhaseTime("activatebestchain", nStart);
+
+    // Warm up the memory caches. The latest blocks are read in parallel batches and each block is
+    // shared by the transaction cache and the price point cache instead of being read per cache.
+    nStart                     = GetTimeMillis();
+    CBlockIndex *pTipIndex     = chainActive.Tip();
+    bool fTxCacheLoaded        = pTipIndex && pCdMan->pTxCache->Load(GetDataDir() / TX_CACHE_FILE_NAME, pTipIndex->GetBlockHash());
+    int32_t nTxCacheBlocks     = fTxCacheLoaded ? 0 : SysCfg().GetTxCacheHeight();
+    int32_t nPriceCacheBlocks  = 11;  // TODO: parameterize 11.
+    int32_t nWarmUpBlocks      = max(nTxCacheBlocks, nPriceCacheBlocks);
+    int32_t nReadThreads       = SysCfg().GetArg("-blockreadthreads", DEFAULT_BLOCK_READ_THREADS);
+    static const int32_t WARM_UP_BATCH_SIZE = 64;
+
+    int32_t nCount = 0;
+    const CBlockIndex *pBlockIndex = pTipIndex;
+    vector<const CBlockIndex *> batchIndexes;
+    vector<CBlock> batchBlocks;
+    while (pBlockIndex && nCount < nWarmUpBlocks) {
+        batchIndexes.clear();
+        for (; pBlockIndex && nCount + (int32_t)batchIndexes.size() < nWarmUpBlocks &&
+               (int32_t)batchIndexes.size() < WARM_UP_BATCH_SIZE;
+             pBlockIndex = pBlockIndex->pprev)
+            batchIndexes.push_back(pBlockIndex);
+
+        if (!ReadBlocksFromDisk(batchIndexes, batchBlocks, nReadThreads))
             return InitError("Failed to read block from disk");
 
-        if (!pCdMan->pTxCache->AddBlockTx(block))
-            return InitError("Failed to add block to transaction memory cache");
+        for (const auto &block : batchBlocks) {
+            if (nCount == 0)
+                pCdMan->pPpCache->SetLatestBlockMedianPricePoints(block.GetBlockMedianPrice());
 
-        pBlockIndex = pBlockIndex->pprev;
-        ++nCount;
-    }
-    LogPrint(BCLog::INFO, "Added the latest %d blocks to transaction memory cache (%dms)\n", nCount, GetTimeMillis() - nStart);
+            if (nCount < nTxCacheBlocks && !pCdMan->pTxCache->AddBlockTx(block))
+                return InitError("Failed to add block to transaction memory cache");
 
-    nStart       = GetTimeMillis();
-    pBlockIndex  = chainActive.Tip();
-    nCacheHeight = 11;  // TODO: parameterize 11.
-    nCount       = 0;
+            if (nCount < nPriceCacheBlocks && !pCdMan->pPpCache->AddBlockToCache(block))
+                return InitError("Failed to add block to price point memory cache");
 
-
-    if (pBlockIndex) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-        pCdMan->pPpCache->SetLatestBlockMedianPricePoints(block.GetBlockMedianPrice());
+            ++nCount;
+        }
     }
 
-    while (pBlockIndex && nCacheHeight-- > 0) {
-        if (!ReadBlockFromDisk(pBlockIndex, block))
-            return InitError("Failed to read block from disk");
-
-        if (!pCdMan->pPpCache->AddBlockToCache(block))
-            return InitError("Failed to add block to price point memory cache");
-
-        pBlockIndex = pBlockIndex->pprev;
-        ++nCount;
-    }
-    LogPrint(BCLog::INFO, "Added the latest %d blocks to price point memory cache (%dms)\n", nCount, GetTimeMillis() - nStart);
+    if (fTxCacheLoaded)
+        LogPrint(BCLog::INFO, "Loaded %llu txids of the latest blocks to transaction memory cache\n",
+                 pCdMan->pTxCache->GetSize());
+    else
+        LogPrint(BCLog::INFO, "Added the latest %d blocks to transaction memory cache\n", min(nCount, nTxCacheBlocks));
+    LogPrint(BCLog::INFO, "Added the latest %d blocks to price point memory cache (%dms)\n",
+             min(nCount, nPriceCacheBlocks), GetTimeMillis() - nStart);
+    AddStartupPhaseTime("warmupcaches", nStart);
 
     vector<boost::filesystem::path> vImportFiles;
     if (SysCfg().IsArgCount("-loadblock")) {
@@ -833,6 +967,11 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
     threadGroup.create_thread(boost::bind(&ThreadImport, vImportFiles));
 
+    int64_t nMempoolDumpInterval = SysCfg().GetArg("-mempooldumpinterval", DEFAULT_MEMPOOL_DUMP_INTERVAL);
+    if (SysCfg().GetBoolArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL) && nMempoolDumpInterval > 0)
+        threadGroup.create_thread(boost::bind(&ThreadDumpMempool, nMempoolDumpInterval));
+    chain::StartAddrIndexBackfill(threadGroup);
+
 
     nStart = GetTimeMillis();
     {
@@ -843,12 +982,14 @@ bool AppInit(boost::thread_group &threadGroup) {
     }
 
     LogPrint(BCLog::INFO, "Loaded %i addresses from peers.dat (%dms)\n", addrman.size(), GetTimeMillis() - nStart);
+    AddStartupPhaseTime("loadpeers", nStart);
 
     if (!CheckDiskSpace())
         return false;
 
     RandAddSeedPerfmon();
 
+    StartPBFTMessageVerifier(threadGroup);
     StartNode(threadGroup);
 
     if (SysCfg().IsServer()) {
@@ -860,13 +1001,19 @@ bool AppInit(boost::thread_group &threadGroup) {
     // Generate coins in the background
     if (pWalletMain) {
         GenerateCoinBlock(SysCfg().GetBoolArg("-genblock", false), pWalletMain, SysCfg().GetArg("-genblocklimit", -1));
+        GenerateDexSettleTxs(SysCfg().GetBoolArg("-dexmatch", DEFAULT_DEX_MATCH), pWalletMain);
         pWalletMain->ResendWalletTransactions();
         threadGroup.create_thread(boost::bind(&ThreadFlushWalletDB, boost::ref(pWalletMain->strWalletFile)));
 
         //resend unconfirmed tx
         threadGroup.create_thread(boost::bind(&ThreadRelayTx, pWalletMain));
+
+        if (SysCfg().GetBoolArg("-asyncwalletnotify", DEFAULT_ASYNC_WALLET_NOTIFY))
+            threadGroup.create_thread(boost::bind(&CWallet::ThreadBlockNotify, pWalletMain));
     }
 
+    LogStartupPhaseTimes();
+
     return !fRequestShutdown;
 }
 
@@ -10,6 +10,7 @@
 #include "commons/util/util.h"
 #include "commons/types.h"
 
+#include <chrono>
 #include <mutex>
 
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
@@ -83,6 +84,7 @@ bool BCLog::Logger::StartLogging()
 
 void BCLog::Logger::DisconnectTestLogger()
 {
+    StopAsyncLogging();
     std::lock_guard<std::mutex> scoped_lock(m_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
@@ -156,6 +158,7 @@ static const EnumTypeMap<BCLog::LogFlags, std::string, uint32_t> LOG_CATEGORY_MA
     {BCLog::CDP,        "CDP"       },
     {BCLog::WALLET,     "WALLET"    },
     {BCLog::LIBEVENT,   "LIBEVENT"  },
+    {BCLog::DEX,        "DEX"       },
     {BCLog::ALL,        "1"         },
     {BCLog::ALL,        "ALL"       },
 };
@@ -263,10 +266,9 @@ namespace BCLog {
 
 }
 
-void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* file, int line,
+std::string BCLog::Logger::FormatLogStr(const BCLog::LogFlags& category, const char* file, int line,
     const std::string& str) {
 
-    std::lock_guard<std::mutex> scoped_lock(m_cs);
     std::string str_prefixed = LogEscapeMessage(str);
 
     str_prefixed.insert(0, "[" + GetLogCategoryName(category) + "] ");
@@ -282,6 +284,45 @@ void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* fil
 
     m_started_new_line = !str.empty() && str[str.size()-1] == '\n';
 
+    return str_prefixed;
+}
+
+void BCLog::Logger::WriteLogStr(const std::string& str)
+{
+    if (m_print_to_file) {
+        assert(m_fileout != nullptr);
+
+        // reopen the log file, if requested
+        if (m_reopen_file) {
+            m_reopen_file = false;
+            FILE* new_fileout = fsbridge::fopen(m_file_path, "a");
+            if (new_fileout) {
+                setbuf(new_fileout, nullptr); // unbuffered
+                fclose(m_fileout);
+                m_fileout = new_fileout;
+            }
+        }
+        FileWriteStr(str, m_fileout);
+    }
+}
+
+void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* file, int line,
+    const std::string& str) {
+
+    if (m_async_running.load()) {
+        // the writer thread waits for the producers which saw it running before it exits
+        ++m_async_producers;
+        if (m_async_running.load()) {
+            AsyncEnqueue(FormatLogStr(category, file, line, str));
+            --m_async_producers;
+            return;
+        }
+        --m_async_producers;
+    }
+
+    std::lock_guard<std::mutex> scoped_lock(m_cs);
+    std::string str_prefixed = FormatLogStr(category, file, line, str);
+
     if (m_buffering) {
         // buffer if we haven't started logging yet
         m_msgs_before_open.push_back(str_prefixed);
@@ -296,20 +337,159 @@ void BCLog::Logger::LogPrintStr(const BCLog::LogFlags& category, const char* fil
     for (const auto& cb : m_print_callbacks) {
         cb(str_prefixed);
     }
-    if (m_print_to_file) {
-        assert(m_fileout != nullptr);
+    WriteLogStr(str_prefixed);
+}
 
-        // reopen the log file, if requested
-        if (m_reopen_file) {
-            m_reopen_file = false;
-            FILE* new_fileout = fsbridge::fopen(m_file_path, "a");
-            if (new_fileout) {
-                setbuf(new_fileout, nullptr); // unbuffered
-                fclose(m_fileout);
-                m_fileout = new_fileout;
+// Max records written by the async writer with one fwrite
+static const uint32_t ASYNC_LOG_MAX_BATCH = 1024;
+// The writer thread polls the queue at least this often, in case a wakeup was missed
+static const int64_t ASYNC_LOG_IDLE_WAIT_MILLIS = 100;
+
+void BCLog::Logger::StartAsyncLogging(uint32_t queueSize, bool dropWhenFull)
+{
+    assert(!m_async_running && !m_async_writer.joinable());
+
+    uint64_t capacity = 2;
+    while (capacity < queueSize)
+        capacity <<= 1;
+
+    m_async_slots.reset(new AsyncSlot[capacity]);
+    for (uint64_t i = 0; i < capacity; i++)
+        m_async_slots[i].seq = i;
+    m_async_mask         = capacity - 1;
+    m_async_enqueue_pos  = 0;
+    m_async_dequeue_pos  = 0;
+    m_async_drop         = dropWhenFull;
+    m_async_stopping     = false;
+
+    m_async_running = true;
+    m_async_writer  = std::thread(&BCLog::Logger::AsyncWriterThread, this);
+}
+
+void BCLog::Logger::StopAsyncLogging()
+{
+    if (!m_async_writer.joinable())
+        return;
+
+    // new records go to the synchronous path from now on
+    m_async_running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_async_wakeup_cs);
+        m_async_stopping = true;
+    }
+    m_async_wakeup.notify_one();
+    m_async_writer.join();
+}
+
+bool BCLog::Logger::AsyncPush(std::string& msg)
+{
+    uint64_t pos = m_async_enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        AsyncSlot& slot = m_async_slots[pos & m_async_mask];
+        int64_t diff = (int64_t)slot.seq.load(std::memory_order_acquire) - (int64_t)pos;
+        if (diff == 0) {
+            // the slot is free, claim it
+            if (m_async_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.msg.swap(msg);
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // the writer has not yet consumed the record of the last lap, the queue is full
+            return false;
+        } else {
+            pos = m_async_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool BCLog::Logger::AsyncPop(std::string& msg)
+{
+    AsyncSlot& slot = m_async_slots[m_async_dequeue_pos & m_async_mask];
+    if (slot.seq.load(std::memory_order_acquire) != m_async_dequeue_pos + 1)
+        return false;
+
+    // swap so that the string buffers are recycled between the producers and the writer
+    msg.swap(slot.msg);
+    slot.seq.store(m_async_dequeue_pos + m_async_mask + 1, std::memory_order_release);
+    m_async_dequeue_pos++;
+    return true;
+}
+
+bool BCLog::Logger::AsyncEmpty() const
+{
+    const AsyncSlot& slot = m_async_slots[m_async_dequeue_pos & m_async_mask];
+    return slot.seq.load(std::memory_order_acquire) != m_async_dequeue_pos + 1;
+}
+
+void BCLog::Logger::AsyncEnqueue(std::string&& msg)
+{
+    bool blocked = false;
+    while (!AsyncPush(msg)) {
+        if (m_async_drop) {
+            ++m_async_dropped;
+            return;
+        }
+        if (!blocked) {
+            blocked = true;
+            ++m_async_blocked;
+        }
+        m_async_wakeup.notify_one();
+        std::this_thread::yield();
+    }
+
+    if (m_async_writer_idle.load(std::memory_order_relaxed))
+        m_async_wakeup.notify_one();
+}
+
+void BCLog::Logger::AsyncWriterThread()
+{
+    util::ThreadRename("logwriter");
+
+    std::vector<std::string> records(ASYNC_LOG_MAX_BATCH);
+    std::string batch;
+    uint64_t droppedReported = 0;
+    for (;;) {
+        // read before draining, so that nothing is pushed after the last drain
+        bool stopping = m_async_stopping.load() && m_async_producers.load() == 0;
+
+        uint32_t count = 0;
+        while (count < ASYNC_LOG_MAX_BATCH && AsyncPop(records[count]))
+            count++;
+
+        uint64_t dropped = m_async_dropped.load();
+        if (count > 0 || dropped != droppedReported) {
+            batch.clear();
+            for (uint32_t i = 0; i < count; i++)
+                batch += records[i];
+            if (dropped != droppedReported) {
+                batch += strprintf("[%s] %d log records dropped since the async log queue was full\n",
+                                   GetLogCategoryName(BCLog::ERROR), dropped - droppedReported);
+                droppedReported = dropped;
             }
+
+            std::lock_guard<std::mutex> scoped_lock(m_cs);
+            if (m_print_to_console) {
+                fwrite(batch.data(), 1, batch.size(), stdout);
+                fflush(stdout);
+            }
+            for (const auto& cb : m_print_callbacks) {
+                for (uint32_t i = 0; i < count; i++)
+                    cb(records[i]);
+            }
+            WriteLogStr(batch);
+            m_async_written += count;
+            continue;
         }
-        FileWriteStr(str_prefixed, m_fileout);
+
+        if (stopping)
+            break;
+
+        std::unique_lock<std::mutex> lock(m_async_wakeup_cs);
+        m_async_writer_idle = true;
+        m_async_wakeup.wait_for(lock, std::chrono::milliseconds(ASYNC_LOG_IDLE_WAIT_MILLIS),
+                                [this] { return m_async_stopping.load() || !AsyncEmpty(); });
+        m_async_writer_idle = false;
     }
 }
 
@@ -10,10 +10,13 @@
 #include "commons/tinyformat.h"
 #include <boost/filesystem.hpp>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace fs = boost::filesystem;
@@ -22,6 +25,9 @@ static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
 static const bool DEFAULT_LOGTHREADNAMES = false;
+static const bool DEFAULT_LOGASYNC       = false;
+static const uint32_t DEFAULT_LOGASYNC_QUEUE = 65536;   // records buffered for the async log writer
+static const char * const DEFAULT_LOGASYNC_POLICY = "block";
 extern const char * const DEFAULT_DEBUGLOGFILE;
 
 extern bool fLogIPs;
@@ -56,6 +62,7 @@ namespace BCLog { //blockchain log
         CDP         = (1 << 18),
         WALLET      = (1 << 19),
         LIBEVENT    = (1 << 20),
+        DEX         = (1 << 21),
         ALL         = ~(uint32_t)0,
     };
 
@@ -82,6 +89,40 @@ namespace BCLog { //blockchain log
         /** Slots that connect to the print signal */
         std::list<std::function<void(const std::string&)>> m_print_callbacks /* GUARDED_BY(m_cs) */ {};
 
+        /**
+         * Async mode: the producers format the records on their own threads and push them into a
+         * bounded multi-producer ring buffer with a sequence number per slot, without taking m_cs.
+         * The writer thread pops the records in batches, writes each batch with a single fwrite and
+         * reopens the log file when requested.
+         */
+        struct AsyncSlot {
+            std::atomic<uint64_t> seq{0};
+            std::string msg;
+        };
+        std::unique_ptr<AsyncSlot[]> m_async_slots;
+        uint64_t m_async_mask = 0;
+        std::atomic<uint64_t> m_async_enqueue_pos{0};
+        uint64_t m_async_dequeue_pos = 0;             // only used by the writer thread
+        bool m_async_drop = false;                    // drop the record instead of waiting when the queue is full
+        std::atomic<bool> m_async_running{false};
+        std::atomic<bool> m_async_stopping{false};
+        std::atomic<int32_t> m_async_producers{0};    // producers between checking m_async_running and pushing
+        std::atomic<bool> m_async_writer_idle{false};
+        std::mutex m_async_wakeup_cs;
+        std::condition_variable m_async_wakeup;
+        std::thread m_async_writer;
+        std::atomic<uint64_t> m_async_written{0};
+        std::atomic<uint64_t> m_async_dropped{0};
+        std::atomic<uint64_t> m_async_blocked{0};     // records which waited for a free slot
+
+        std::string FormatLogStr(const BCLog::LogFlags& category, const char* file, int line, const std::string& str);
+        void WriteLogStr(const std::string& str);     // EXCLUSIVE_LOCKS_REQUIRED(m_cs)
+        bool AsyncPush(std::string& msg);
+        bool AsyncPop(std::string& msg);
+        bool AsyncEmpty() const;
+        void AsyncEnqueue(std::string&& msg);
+        void AsyncWriterThread();
+
     public:
         bool m_print_to_console = false;
         bool m_print_to_file = false;
@@ -101,6 +142,7 @@ namespace BCLog { //blockchain log
         /** Returns whether logs will be written to any output */
         bool Enabled() const
         {
+            if (m_async_running.load(std::memory_order_relaxed)) return true;
             std::lock_guard<std::mutex> scoped_lock(m_cs);
             return m_buffering || m_print_to_console || m_print_to_file || !m_print_callbacks.empty();
         }
@@ -125,6 +167,16 @@ namespace BCLog { //blockchain log
         /** Only for testing */
         void DisconnectTestLogger();
 
+        /** Hand the log output over to a writer thread, queueSize is rounded up to a power of 2 */
+        void StartAsyncLogging(uint32_t queueSize, bool dropWhenFull);
+        /** Write out the queued records, stop the writer thread and go back to synchronous logging */
+        void StopAsyncLogging();
+
+        bool IsAsync() const { return m_async_running.load(); }
+        uint64_t GetAsyncWritten() const { return m_async_written.load(); }
+        uint64_t GetAsyncDropped() const { return m_async_dropped.load(); }
+        uint64_t GetAsyncBlocked() const { return m_async_blocked.load(); }
+
         void ShrinkDebugFile();
 
         uint32_t GetCategoryMask() const { return m_categories.load(); }
@@ -26,7 +26,10 @@
 #include "p2p/processmessage.hpp"
 #include "p2p/sendmessage.hpp"
 #include "chain/blockdelegates.h"
+#include "chain/addrindex.h"
+#include "persistence/blockfilereader.h"
 #include "persistence/blockundo.h"
+#include "persistence/blockindexstore.h"
 
 #include <sstream>
 #include <algorithm>
@@ -34,6 +37,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <memory>
+#include <thread>
 
 using namespace json_spirit;
 using namespace std;
@@ -52,16 +56,19 @@ using namespace boost;
 CCacheDBManager *pCdMan = nullptr;
 CCriticalSection cs_main;
 CTxMemPool mempool;
-map<uint256, CBlockIndex *> mapBlockIndex;
+BlockMap mapBlockIndex;
 int32_t nSyncTipHeight = 0;
 string externalIp;
 map<uint256/* blockhash */, std::shared_ptr<CCacheWrapper>> mapForkCache;
 CSignatureCache signatureCache;
+CPubKeyCache pubKeyCache;
 CChain chainActive;
 CChain chainMostWork;
 bool mining;        // could change from time to time due to vote change
 CKeyID minerKeyId;  // miner accout keyId
 CKeyID nodeKeyId;   // 1st keyId of the node
+bool fPruneMode       = false;
+uint64_t nPruneTarget = 0;
 extern CPBFTMan pbftMan;
 
 map<uint256/* blockhash */, COrphanBlock *> mapOrphanBlocks;
@@ -139,6 +146,8 @@ set<COrphanBlock *, COrphanBlockComparator> setOrphanBlock;  //set of Orphan Blo
 CCriticalSection cs_LastBlockFile;
 CBlockFileInfo infoLastBlockFile;
 int32_t nLastBlockFile = 0;
+// set when a block file is finished, and at startup to prune the files left over the target
+std::atomic<bool> fCheckForPruning(true);
 
 // Every received block is assigned a unique and increasing identifier, so we
 // know which one to give priority in case of a fork.
@@ -242,7 +251,7 @@ bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signatu
     if (signatureCache.Get(sigHash, signature, pubKey))
         return true;
 
-    if (!pubKey.Verify(sigHash, signature))
+    if (!pubKeyCache.Verify(pubKey, sigHash, signature))
         return false;
 
     signatureCache.Set(sigHash, signature, pubKey);
@@ -250,8 +259,9 @@ bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signatu
 }
 
 bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
-                        bool fLimitFree, bool fRejectInsaneFee) {
+                        bool fLimitFree, bool fRejectInsaneFee, int64_t nEntryTime, int32_t nEntryHeight) {
     AssertLockHeld(cs_main);
+    CPerfTimer timer(perfStats.mempoolAccept);
 
     // is it already in the memory pool?
     uint256 hash = pBaseTx->GetHash();
@@ -273,16 +283,14 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
 
     auto spCW = std::make_shared<CCacheWrapper>(mempool.cw.get());
 
-    CBlockIndex *pTip =  chainActive.Tip();
-    uint32_t fuelRate  = GetElementForBurn(pTip);
-    uint32_t blockTime = pTip->GetBlockTime();
-    uint32_t prevBlockTime = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
-
-    CTxExecuteContext context(chainActive.Height(), 0, fuelRate, blockTime, prevBlockTime, spCW.get(), &state);
-    if (!pBaseTx->CheckTx(context))
+    auto pTipContext = GetChainTipContext();
+    CTxExecuteContext context(pTipContext->height, 0, pTipContext->fuel_rate, pTipContext->block_time,
+                              pTipContext->prev_block_time, spCW.get(), &state);
+    if (!TimedCheckTx(*pBaseTx, context))
         return ERRORMSG("AcceptToMemoryPool() : CheckTx failed, txid: %s", hash.GetHex());
 
-    CTxMemPoolEntry entry(pBaseTx, GetTime(), chainActive.Height());
+    CTxMemPoolEntry entry(pBaseTx, nEntryTime > 0 ? nEntryTime : GetTime(),
+                          nEntryHeight >= 0 ? nEntryHeight : chainActive.Height());
     auto nFees = std::get<1>(entry.GetFees());
     auto nSize = entry.GetTxSize();
     // Continuously rate-limit free transactions
@@ -314,6 +322,90 @@ bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBas
     return pool.AddUnchecked(hash, entry, state);
 }
 
+// the pool is dumped only after it has been reloaded, not to overwrite mempool.dat with a partial pool
+static std::atomic<bool> fMempoolLoaded(false);
+
+bool LoadMempool(CTxMemPool &pool, CMempoolLoadStats &stats) {
+    static const size_t LOAD_BATCH_SIZE = 500;
+
+    int64_t nStart = GetTimeMillis();
+    vector<CTxMemPoolDumpEntry> entries;
+    if (!CTxMemPool::ReadDump(GetDataDir() / MEMPOOL_FILE_NAME, entries)) {
+        fMempoolLoaded = true;
+        return false;
+    }
+
+    // Resolve the signing keys under one lock, then verify the signatures in parallel without cs_main, which
+    // leaves the signature cache warm for the CheckTx() of AcceptToMemoryPool(). A signature that does not
+    // verify here is left to AcceptToMemoryPool() to judge, as some txs are signed by other keys.
+    vector<CPubKey> pubKeys(entries.size());
+    {
+        LOCK(cs_main);
+        for (size_t i = 0; i < entries.size(); i++) {
+            const CUserID &txUid = entries[i].pTx->txUid;
+            CAccount account;
+            if (txUid.is<CPubKey>())
+                pubKeys[i] = txUid.get<CPubKey>();
+            else if (!txUid.is<CNullID>() && pCdMan->pAccountCache->GetAccount(txUid, account))
+                pubKeys[i] = account.owner_pubkey;
+        }
+    }
+
+    int32_t nThreads = max<int32_t>(1, min<size_t>(std::thread::hardware_concurrency(), entries.size()));
+    std::atomic<size_t> next(0);
+    auto verifier = [&]() {
+        for (size_t i = next++; i < entries.size(); i = next++) {
+            const CBaseTx &tx = *entries[i].pTx;
+            if (pubKeys[i].IsValid())
+                VerifySignature(tx.ComputeSignatureHash(), tx.signature, pubKeys[i]);
+        }
+    };
+    vector<std::thread> threads;
+    for (int32_t i = 1; i < nThreads; ++i)
+        threads.emplace_back(verifier);
+    verifier();
+    for (auto &thread : threads)
+        thread.join();
+
+    // accept the txs in the order of the dump, releasing cs_main between the batches
+    for (size_t begin = 0; begin < entries.size(); begin += LOAD_BATCH_SIZE) {
+        boost::this_thread::interruption_point();
+
+        LOCK(cs_main);
+        size_t end = min(begin + LOAD_BATCH_SIZE, entries.size());
+        for (size_t i = begin; i < end; i++) {
+            CBaseTx *pBaseTx = entries[i].pTx.get();
+            if (!pBaseTx->IsValidHeight(chainActive.Height(), SysCfg().GetTxCacheHeight())) {
+                stats.expired++;
+                continue;
+            }
+            if (pool.Exists(pBaseTx->GetHash())) {
+                stats.existed++;
+                continue;
+            }
+
+            CValidationState state;
+            if (AcceptToMemoryPool(pool, state, pBaseTx, false, false, entries[i].nTime, entries[i].height))
+                stats.accepted++;
+            else
+                stats.failed++;
+        }
+    }
+
+    fMempoolLoaded = true;
+    LogPrint(BCLog::INFO, "Loaded %u txs of %s: %u accepted, %u expired, %u existed, %u failed (%dms)\n",
+             entries.size(), MEMPOOL_FILE_NAME, stats.accepted, stats.expired, stats.existed, stats.failed,
+             GetTimeMillis() - nStart);
+    return true;
+}
+
+bool DumpMempool(const CTxMemPool &pool) {
+    if (!fMempoolLoaded)
+        return false;
+
+    return pool.Dump(GetDataDir() / MEMPOOL_FILE_NAME);
+}
+
 int32_t CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex *&pindexRet) const {
     if (blockHash.IsNull() || index == -1)
         return 0;
@@ -321,7 +413,7 @@ int32_t CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex *&pindexRet) const {
     AssertLockHeld(cs_main);
 
     // Find the block it claims to be in
-    map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(blockHash);
+    BlockMap::iterator mi = mapBlockIndex.find(blockHash);
     if (mi == mapBlockIndex.end())
         return 0;
 
@@ -361,14 +453,10 @@ int32_t GetTxConfirmHeight(const uint256 &hash, CBlockDBCache &blockCache) {
     if (SysCfg().IsTxIndex()) {
         CDiskTxPos diskTxPos;
         if (blockCache.ReadTxIndex(hash, diskTxPos)) {
-            CAutoFile file(OpenBlockFile(diskTxPos, true), SER_DISK, CLIENT_VERSION);
             CBlockHeader header;
-            try {
-                file >> header;
-            } catch (std::exception &e) {
-                ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+            if (!blockFileReader.ReadBlockHeader(diskTxPos, header))
                 return -1;
-            }
+
             return header.GetHeight();
         }
     }
@@ -379,6 +467,7 @@ int32_t GetTxConfirmHeight(const uint256 &hash, CBlockDBCache &blockCache) {
 // Return transaction in tx, and if it was found inside a block, its hash is placed in blockHash
 bool GetTransaction(std::shared_ptr<CBaseTx> &pBaseTx, const uint256 &hash, CBlockDBCache &blockCache,
                     bool bSearchMemPool) {
+    CDiskTxPos diskTxPos;
     {
         LOCK(cs_main);
         {
@@ -389,23 +478,12 @@ bool GetTransaction(std::shared_ptr<CBaseTx> &pBaseTx, const uint256 &hash, CBlo
             }
         }
 
-        if (SysCfg().IsTxIndex()) {
-            CDiskTxPos diskTxPos;
-            if (blockCache.ReadTxIndex(hash, diskTxPos)) {
-                CAutoFile file(OpenBlockFile(diskTxPos, true), SER_DISK, CLIENT_VERSION);
-                CBlockHeader header;
-                try {
-                    file >> header;
-                    fseek(file, diskTxPos.nTxOffset, SEEK_CUR);
-                    file >> pBaseTx;
-                } catch (std::exception &e) {
-                    return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
-                }
-                return true;
-            }
-        }
+        if (!SysCfg().IsTxIndex() || !blockCache.ReadTxIndex(hash, diskTxPos))
+            return false;
     }
-    return false;
+
+    // the block file reader needs no cs_main
+    return blockFileReader.ReadTx(diskTxPos, pBaseTx);
 }
 
 uint256 GetOrphanRoot(const uint256 &hash) {
@@ -643,7 +721,7 @@ bool ReconsiderBlock(CValidationState &state, CBlockIndex *pIndex) {
     AssertLockHeld(cs_main);
 
     // Remove the invalidity flag from this block and all its descendants.
-    map<uint256, CBlockIndex *>::const_iterator it = mapBlockIndex.begin();
+    BlockMap::const_iterator it = mapBlockIndex.begin();
     int32_t height                                    = pIndex->height;
     while (it != mapBlockIndex.end()) {
         if (it->second->nStatus & BLOCK_FAILED_MASK && it->second->GetAncestor(height) == pIndex) {
@@ -1014,8 +1092,10 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
     bool isGensisBlock = block.GetHeight() == 0 && block.GetHash() == SysCfg().GetGenesisBlockHash();
 
     // Check it again in case a previous version let a bad block in
+    CPerfTimer checkTimer(perfStats.blockCheck);
     if (!isGensisBlock && !CheckBlock(block, state, cw, !fJustCheck, !fJustCheck))
         return state.DoS(100, ERRORMSG("ConnectBlock() : check block error"), REJECT_INVALID, "check-block-error");
+    checkTimer.Stop();
 
     if (!fJustCheck) {
         // Verify that the cache's current state corresponds to the previous block
@@ -1093,7 +1173,7 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
 
             uint32_t prevBlockTime = pIndex->pprev != nullptr ? pIndex->pprev->GetBlockTime() : pIndex->GetBlockTime();
             CTxExecuteContext context(pIndex->height, index, fuelRate, pIndex->nTime, prevBlockTime, &cw, &state);
-            if (!pBaseTx->ExecuteTx(context)) {
+            if (!TimedExecuteTx(*pBaseTx, context)) {
                 pCdMan->pLogCache->SetExecuteFail(pIndex->height, pBaseTx->GetHash(), state.GetRejectCode(),
                                                   state.GetRejectReason());
                 return state.DoS(100, ERRORMSG("ConnectBlock() : txid=%s execute failed, in detail: %s",
@@ -1166,7 +1246,7 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
         uint32_t prevBlockTime = pIndex->pprev != nullptr ? pIndex->pprev->GetBlockTime() : pIndex->GetBlockTime();
         CTxExecuteContext context(pIndex->height, 0, pIndex->nFuelRate, pIndex->nTime, prevBlockTime, &cw, &state);
         CTxUndoOpLogger rewardOpLogger(cw, block.vptx[0]->GetHash(), blockUndo);
-        if (!block.vptx[0]->ExecuteTx(context)) {
+        if (!TimedExecuteTx(*block.vptx[0], context)) {
             pCdMan->pLogCache->SetExecuteFail(pIndex->height, block.vptx[0]->GetHash(), state.GetRejectCode(),
                                             state.GetRejectReason());
             return state.DoS(100, ERRORMSG("ConnectBlock() : failed to execute reward transaction"));
@@ -1192,6 +1272,9 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
             return state.DoS(100, ERRORMSG("ConnectBlock() : failed to process block delegates! block=%d:%s",
                 block.GetHeight(), block.GetHash().ToString()));
         }
+
+        if (!chain::ProcessBlockAddrTxs(block, cw, state))
+            return false;
     }
 
     if (pIndex->height - BLOCK_REWARD_MATURITY > 0) {
@@ -1218,6 +1301,7 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
         }
     }
     int64_t nTime = GetTimeMicros() - nStart;
+    perfStats.blockExecute.Record(nTime);
     if (SysCfg().IsBenchmark())
         LogPrint(BCLog::INFO, "- Connect %u transactions: %.2fms (%.3fms/tx)\n",
                  (uint32_t)block.vptx.size(), 0.001 * nTime, 0.001 * nTime / block.vptx.size());
@@ -1227,6 +1311,7 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
 
     // Write undo information to disk
     if (pIndex->GetUndoPos().IsNull() || (pIndex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_SCRIPTS) {
+        CPerfTimer undoTimer(perfStats.blockUndoWrite);
         if (pIndex->GetUndoPos().IsNull()) {
             CDiskBlockPos pos;
             if (!FindUndoPos(state, pIndex->nFile, pos, ::GetSerializeSize(blockUndo, SER_DISK, CLIENT_VERSION) + 40))
@@ -1251,19 +1336,9 @@ bool ConnectBlock(CBlock &block, CCacheWrapper &cw, CBlockIndex *pIndex, CValida
         return state.Abort(_("ConnectBlock() : failed add block into transaction memory cache"));
     }
 
+    // the block falling out of the cache window is dropped by its height
     if (pIndex->height > SysCfg().GetTxCacheHeight()) {
-        CBlockIndex *pDeleteBlockIndex = pIndex;
-        int32_t nCacheHeight           = SysCfg().GetTxCacheHeight();
-        while (pDeleteBlockIndex && nCacheHeight-- > 0) {
-            pDeleteBlockIndex = pDeleteBlockIndex->pprev;
-        }
-
-        CBlock deleteBlock;
-        if (!ReadBlockFromDisk(pDeleteBlockIndex, deleteBlock)) {
-            return state.Abort(_("ConnectBlock() : failed to read block"));
-        }
-
-        if (!cw.txCache.RemoveBlockTx(deleteBlock)) {
+        if (!cw.txCache.RemoveBlockTx(pIndex->height - SysCfg().GetTxCacheHeight())) {
             return state.Abort(_("ConnectBlock() : failed delete block from transaction memory cache"));
         }
     }
@@ -1309,7 +1384,8 @@ bool static WriteChainState(CValidationState &state) {
         pCdMan->pDexCache->GetCacheSize() +
         pCdMan->pBlockCache->GetCacheSize() +
         pCdMan->pLogCache->GetCacheSize() +
-        pCdMan->pReceiptCache->GetCacheSize();
+        pCdMan->pReceiptCache->GetCacheSize() +
+        pCdMan->pAddrTxCache->GetCacheSize();
 
     if (!IsInitialBlockDownload() || cacheSize > SysCfg().GetCacheSize() ||
         GetTimeMicros() > nLastWrite + 60 * 1000000) {
@@ -1331,8 +1407,30 @@ bool static WriteChainState(CValidationState &state) {
 }
 
 // Update chainActive and related internal data structures.
+static CCriticalSection cs_tipContext;
+static std::shared_ptr<const CChainTipContext> pChainTipContext;
+
+std::shared_ptr<const CChainTipContext> GetChainTipContext() {
+    CBlockIndex *pTip = chainActive.Tip();
+    LOCK(cs_tipContext);
+    if (pTip == nullptr)
+        return std::make_shared<const CChainTipContext>();
+
+    if (!pChainTipContext || pChainTipContext->block_hash != pTip->GetBlockHash()) {
+        auto pContext             = std::make_shared<CChainTipContext>();
+        pContext->height          = pTip->height;
+        pContext->block_hash      = pTip->GetBlockHash();
+        pContext->fuel_rate       = GetElementForBurn(pTip);
+        pContext->block_time      = pTip->GetBlockTime();
+        pContext->prev_block_time = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
+        pChainTipContext          = pContext;
+    }
+    return pChainTipContext;
+}
+
 void static UpdateTip(CBlockIndex *pIndexNew, const CBlock &block) {
     chainActive.SetTip(pIndexNew);
+    GetChainTipContext();
 
     SyncTransaction(uint256(), nullptr, &block);
 
@@ -1428,6 +1526,7 @@ bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
 
     // Apply the block automatically to the chain state.
     int64_t nStart = GetTimeMicros();
+    CPerfTimer connectTimer(perfStats.blockConnect);
     {
         CInv inv(MSG_BLOCK, pIndexNew->GetBlockHash());
 
@@ -1445,6 +1544,7 @@ bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
         }
 
         // Need to re-sync all to global cache layer.
+        CPerfTimer flushTimer(perfStats.blockFlush);
         spCW->Flush();
     }
 
@@ -1454,6 +1554,7 @@ bool static ConnectTip(CValidationState &state, CBlockIndex *pIndexNew) {
     // Write the chain state to disk, if necessary.
     if (!WriteChainState(state))
         return false;
+    connectTimer.Stop();
 
     // Update chainActive & related variables.
     UpdateTip(pIndexNew, block);
@@ -1634,17 +1735,17 @@ bool AddToBlockIndex(CBlock &block, CValidationState &state, const CDiskBlockPos
         return state.Invalid(ERRORMSG("AddToBlockIndex() : %s already exists", hash.ToString()), 0, "duplicate");
 
     // Construct new block index object
-    CBlockIndex *pIndexNew = new CBlockIndex(block);
+    CBlockIndex *pIndexNew = blockIndexArena.New(block);
 
     assert(pIndexNew);
     {
         LOCK(cs_nBlockSequenceId);
         pIndexNew->nSequenceId = nBlockSequenceId++;
     }
-    map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.insert(make_pair(hash, pIndexNew)).first;
+    BlockMap::iterator mi = mapBlockIndex.insert(make_pair(hash, pIndexNew)).first;
     // LogPrint(BCLog::INFO, "in map hash:%s map size:%d\n", hash.GetHex(), mapBlockIndex.size());
     pIndexNew->pBlockHash                        = &((*mi).first);
-    map<uint256, CBlockIndex *>::iterator miPrev = mapBlockIndex.find(block.GetPrevBlockHash());
+    BlockMap::iterator miPrev = mapBlockIndex.find(block.GetPrevBlockHash());
     if (miPrev != mapBlockIndex.end()) {
         pIndexNew->pprev  = (*miPrev).second;
         pIndexNew->height = pIndexNew->pprev->height + 1;
@@ -1680,6 +1781,8 @@ bool AddToBlockIndex(CBlock &block, CValidationState &state, const CDiskBlockPos
     } else
         CheckForkWarningConditionsOnNewFork(pIndexNew);
 
+    PruneBlockFilesIfNeeded();
+
     if (!pCdMan->pBlockCache->Flush())
         return state.Abort(_("Failed to sync block index"));
 
@@ -1706,6 +1809,7 @@ bool FindBlockPos(CValidationState &state, CDiskBlockPos &pos, uint32_t nAddSize
         while (infoLastBlockFile.nSize + nAddSize >= MAX_BLOCKFILE_SIZE) {
             LogPrint(BCLog::INFO, "Leaving block file %d: %s\n", nLastBlockFile, infoLastBlockFile.ToString());
             FlushBlockFile(true);
+            fCheckForPruning = true;
             nLastBlockFile++;
             infoLastBlockFile.SetNull();
             pCdMan->pBlockIndexDb->ReadBlockFileInfo(nLastBlockFile, infoLastBlockFile);  // check whether data for the new file somehow already exist; can fail just fine
@@ -1928,7 +2032,7 @@ bool CheckBlock(const CBlock &block, CValidationState &state, CCacheWrapper &cw,
 
         uint32_t prevBlockTime = block.GetTime(); // the prev block maybe unkown when checking block
         CTxExecuteContext context(block.GetHeight(), i + 1, block.GetFuelRate(), block.GetTime(), prevBlockTime, &cw, &state);
-        if (fCheckTx && !block.vptx[i]->CheckTx(context))
+        if (fCheckTx && !TimedCheckTx(*block.vptx[i], context))
             return ERRORMSG("CheckBlock() : CheckTx failed, txid: %s", block.vptx[i]->GetHash().GetHex());
 
         if (block.GetHeight() != 0 || block.GetHash() != SysCfg().GetGenesisBlockHash()) {
@@ -1980,15 +2084,22 @@ bool AcceptBlock(CBlock &block, CValidationState &state, CDiskBlockPos *dbp, boo
 
     assert(block.GetHeight() == 0 || mapBlockIndex.count(block.GetPrevBlockHash()));
 
-    if (block.GetHeight() != 0 && block.GetFuelRate() != GetElementForBurn(mapBlockIndex[block.GetPrevBlockHash()]))
-        return state.DoS(100, ERRORMSG("AcceptBlock() : block fuel rate unmatched"), REJECT_INVALID,
-                         "fuel-rate-unmatched");
+    if (block.GetHeight() != 0) {
+        // most blocks extend the tip, whose fuel rate is kept by the tip context
+        auto pTipContext  = GetChainTipContext();
+        uint32_t fuelRate = block.GetPrevBlockHash() == pTipContext->block_hash
+                                ? pTipContext->fuel_rate
+                                : GetElementForBurn(mapBlockIndex[block.GetPrevBlockHash()]);
+        if (block.GetFuelRate() != fuelRate)
+            return state.DoS(100, ERRORMSG("AcceptBlock() : block fuel rate unmatched"), REJECT_INVALID,
+                             "fuel-rate-unmatched");
+    }
 
     // Get prev block index
     CBlockIndex *pPrevBlockIndex = nullptr;
     int32_t height = 0;
     if (block.GetHeight() != 0 || blockHash != SysCfg().GetGenesisBlockHash()) {
-        map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(block.GetPrevBlockHash());
+        BlockMap::iterator mi = mapBlockIndex.find(block.GetPrevBlockHash());
         if (mi == mapBlockIndex.end())
             return state.DoS(10, ERRORMSG("AcceptBlock() : prev block not found"), 0, "bad-prevblk");
 
@@ -2047,8 +2158,28 @@ bool AcceptBlock(CBlock &block, CValidationState &state, CDiskBlockPos *dbp, boo
     CBlockIndex* pTip = chainActive.Tip() ;
     if (pTip->GetBlockHash() == blockHash) {
         {
+            // built once for all the peers preferring compact blocks
+            std::shared_ptr<CBlockHeaderAndShortTxIDs> pCmpctBlock;
+            uint32_t cmpctBlockSize = 0;
+            uint32_t fullBlockSize  = 0;
+
             LOCK(cs_vNodes);
             for (auto pNode : vNodes) {
+                if (pNode->fPreferCompactBlocks &&
+                    (mining || chainActive.Height() > (pNode->nStartingHeight != -1 ? pNode->nStartingHeight - 2000 : 0))) {
+                    if (!pCmpctBlock) {
+                        pCmpctBlock    = std::make_shared<CBlockHeaderAndShortTxIDs>(block);
+                        cmpctBlockSize = ::GetSerializeSize(*pCmpctBlock, SER_NETWORK, PROTOCOL_VERSION);
+                        fullBlockSize  = ::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+                    }
+                    pNode->PushMessage(NetMsgType::CMPCTBLOCK, *pCmpctBlock);
+                    pNode->AddInventoryKnown(CInv(MSG_BLOCK, blockHash));
+
+                    compactBlockStats.sent++;
+                    compactBlockStats.bytesSent += cmpctBlockSize;
+                    compactBlockStats.fullBytesSent += fullBlockSize;
+                    continue;
+                }
                 //p2p_xiaoyu_20191116
                 if (mining) {
                     pNode->PushMessage(NetMsgType::BLOCK, block);
@@ -2145,6 +2276,20 @@ void CBlockIndex::BuildSkip() {
         pskip = pprev->GetAncestor(GetSkipHeight(height));
 }
 
+const vector<unsigned char> &CBlockIndex::GetSignature() const {
+    if (!fSignatureLoaded) {
+        CDiskBlockIndex diskIndex;
+        if (!pCdMan->pBlockIndexDb->ReadBlockIndex(GetBlockHash(), diskIndex)) {
+            LogPrint(BCLog::ERROR, "%s(), read block index %s failed\n", __func__, GetIndentityString());
+            return vSignature;
+        }
+
+        vSignature       = diskIndex.vSignature;
+        fSignatureLoaded = true;
+    }
+    return vSignature;
+}
+
 void PushGetBlocks(CNode *pNode, CBlockIndex *pIndexBegin, uint256 hashEnd) {
     // Ask this guy to fill in what we're missing
     AssertLockHeld(cs_main);
@@ -2203,6 +2348,8 @@ bool ProcessBlock(CValidationState &state, CNode *pFrom, CBlock *pBlock, CDiskBl
         return state.Invalid(ERRORMSG("ProcessBlock() : block [%u]: %s exists", blockHeight, blockHash.ToString()), 0,
                              "duplicate");
 
+    pbftMan.SaveBlockArrivalTime(blockHash);
+
 
     if (mapOrphanBlocks.count(blockHash))
         return state.Invalid(
@@ -2316,21 +2463,28 @@ bool CheckDiskSpace(uint64_t nAdditionalBytes) {
 }
 
 bool static LoadBlockIndexDB() {
-    if (!pCdMan->pBlockIndexDb->LoadBlockIndexes())
-        return ERRORMSG("%s(), LoadBlockIndexes from db failed", __FUNCTION__);
+    // The block index file is valid for one startup only, the db is the source after that
+    vector<CBlockIndex *> vSortedByHeight;
+    boost::filesystem::path indexFilePath = GetDataDir() / BLOCK_INDEX_FILE_NAME;
+    bool fFromFile = LoadBlockIndexFile(indexFilePath, pCdMan->pBlockCache->GetBestBlockHash(), vSortedByHeight);
+    boost::filesystem::remove(indexFilePath);
 
-    boost::this_thread::interruption_point();
+    if (!fFromFile) {
+        if (!pCdMan->pBlockIndexDb->LoadBlockIndexes())
+            return ERRORMSG("%s(), LoadBlockIndexes from db failed", __FUNCTION__);
 
-    // Calculate nChainWork
-    vector<pair<int32_t, CBlockIndex *> > vSortedByHeight;
-    vSortedByHeight.reserve(mapBlockIndex.size());
-    for (const auto &item : mapBlockIndex) {
-        CBlockIndex *pIndex = item.second;
-        vSortedByHeight.push_back(make_pair(pIndex->height, pIndex));
+        boost::this_thread::interruption_point();
+
+        vSortedByHeight.reserve(mapBlockIndex.size());
+        for (const auto &item : mapBlockIndex) {
+            vSortedByHeight.push_back(item.second);
+        }
+        sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+             [](const CBlockIndex *a, const CBlockIndex *b) { return a->height < b->height; });
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    for (const auto &item : vSortedByHeight) {
-        CBlockIndex *pIndex = item.second;
+
+    // Calculate nChainWork
+    for (CBlockIndex *pIndex : vSortedByHeight) {
         pIndex->nChainWork  = pIndex->height;
         pIndex->nChainTx    = (pIndex->pprev ? pIndex->pprev->nChainTx : 0) + pIndex->nTx;
         if ((pIndex->nStatus & BLOCK_VALID_MASK) >= BLOCK_VALID_TRANSACTIONS && !(pIndex->nStatus & BLOCK_FAILED_MASK))
@@ -2378,6 +2532,95 @@ bool static LoadBlockIndexDB() {
     return true;
 }
 
+// Depth below a block up to which connecting or disconnecting it reads blocks from disk
+static int32_t GetBlockReadBackDepth() {
+    // TODO: parameterize 11, the depth of the price point memory cache
+    return max({SysCfg().GetTxCacheHeight(), BLOCK_REWARD_MATURITY, 11});
+}
+
+int32_t GetMinBlocksToKeep() {
+    return GetBlockReadBackDepth() + MIN_BLOCKS_TO_KEEP;
+}
+
+void PruneBlockFilesIfNeeded() {
+    AssertLockHeld(cs_main);
+    if (!fPruneMode || SysCfg().IsReindex() || !fCheckForPruning.exchange(false))
+        return;
+
+    // only the files of finalized blocks below the ones kept on disk are pruned
+    CBlockIndex *pFinIndex = pbftMan.GetGlobalFinIndex();
+    int32_t nPruneHeight   = min(pFinIndex ? pFinIndex->height : 0, chainActive.Height() - GetMinBlocksToKeep());
+    if (nPruneHeight <= 0)
+        return;
+
+    int32_t nCurrentFile;
+    {
+        LOCK(cs_LastBlockFile);
+        nCurrentFile = nLastBlockFile;
+    }
+
+    uint64_t nUsage = 0;
+    vector<pair<int32_t, CBlockFileInfo>> fileInfos;
+    for (int32_t nFile = 0; nFile < nCurrentFile; nFile++) {
+        CBlockFileInfo info;
+        if (!pCdMan->pBlockIndexDb->ReadBlockFileInfo(nFile, info) || info.IsEmpty())
+            continue;
+
+        nUsage += info.nSize + info.nUndoSize;
+        fileInfos.emplace_back(nFile, info);
+    }
+    {
+        LOCK(cs_LastBlockFile);
+        nUsage += infoLastBlockFile.nSize + infoLastBlockFile.nUndoSize;
+    }
+    if (nUsage <= nPruneTarget)
+        return;
+
+    // the lower files hold the lower blocks, prune them first
+    set<int32_t> filesToPrune;
+    for (const auto &item : fileInfos) {
+        if (nUsage <= nPruneTarget)
+            break;
+        if ((int32_t)item.second.nHeightLast > nPruneHeight)
+            continue;
+
+        filesToPrune.insert(item.first);
+        nUsage -= item.second.nSize + item.second.nUndoSize;
+    }
+    if (filesToPrune.empty())
+        return;
+
+    // update the block index before the files are removed, a crash in between leaves only unused files
+    for (const auto &item : mapBlockIndex) {
+        CBlockIndex *pIndex = item.second;
+        if (!(pIndex->nStatus & BLOCK_HAVE_MASK) || !filesToPrune.count(pIndex->nFile))
+            continue;
+
+        pIndex->nStatus &= ~BLOCK_HAVE_MASK;
+        pIndex->nDataPos = 0;
+        pIndex->nUndoPos = 0;
+        if (!pCdMan->pBlockIndexDb->WriteBlockIndex(CDiskBlockIndex(pIndex))) {
+            LogPrint(BCLog::ERROR, "Write block index failed, pruning stopped\n");
+            return;
+        }
+    }
+
+    for (int32_t nFile : filesToPrune) {
+        if (!pCdMan->pBlockIndexDb->WriteBlockFileInfo(nFile, CBlockFileInfo())) {
+            LogPrint(BCLog::ERROR, "Write block file info failed, pruning stopped\n");
+            return;
+        }
+
+        blockFileReader.CloseFile(nFile);
+        boost::system::error_code ec;
+        boost::filesystem::remove(GetDataDir() / "blocks" / strprintf("blk%05u.dat", nFile), ec);
+        boost::filesystem::remove(GetDataDir() / "blocks" / strprintf("rev%05u.dat", nFile), ec);
+    }
+
+    LogPrint(BCLog::INFO, "Pruned %u block files below height %d, %d MiB left of the %d MiB target\n",
+             filesToPrune.size(), nPruneHeight, nUsage >> 20, nPruneTarget >> 20);
+}
+
 bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth) {
     LOCK(cs_main);
     if (chainActive.Tip() == nullptr || chainActive.Tip()->pprev == nullptr)
@@ -2390,6 +2633,22 @@ bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth) {
     if (nCheckDepth > chainActive.Height())
         nCheckDepth = chainActive.Height();
 
+    // The blocks before a state snapshot have no data, and disconnecting a block reads blocks further below it
+    const CBlockIndex *pDataIndex = chainActive.Tip();
+    int32_t nDataDepth            = 0;
+    while (nDataDepth < nCheckDepth + GetBlockReadBackDepth() && pDataIndex->pprev &&
+           (pDataIndex->pprev->nStatus & BLOCK_HAVE_DATA)) {
+        pDataIndex = pDataIndex->pprev;
+        nDataDepth++;
+    }
+    if (pDataIndex->pprev && nDataDepth < nCheckDepth + GetBlockReadBackDepth()) {
+        nCheckDepth = nDataDepth - GetBlockReadBackDepth();
+        if (nCheckDepth <= 0) {
+            LogPrint(BCLog::INFO, "Too few blocks on disk to verify, skipped\n");
+            return true;
+        }
+    }
+
     nCheckLevel = max(0, min(4, nCheckLevel));
     LogPrint(BCLog::INFO, "Verifying last %i blocks at level %i\n", nCheckDepth, nCheckLevel);
 
@@ -2400,16 +2659,31 @@ bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth) {
     int32_t nGoodTransactions  = 0;
     CValidationState state;
 
+    static const size_t READ_BATCH_SIZE = 64;
+    int32_t nReadThreads = SysCfg().GetArg("-blockreadthreads", DEFAULT_BLOCK_READ_THREADS);
+    vector<const CBlockIndex *> batchIndexes;
+    vector<CBlock> batchBlocks;
+    size_t batchPos = 0;
+
     for (CBlockIndex *pIndex = chainActive.Tip(); pIndex && pIndex->pprev; pIndex = pIndex->pprev) {
         boost::this_thread::interruption_point();
         if (pIndex->height < chainActive.Height() - nCheckDepth)
             break;
 
-        CBlock block;
-        // check level 0: read from disk
-        if (!ReadBlockFromDisk(pIndex, block))
-            return ERRORMSG("VerifyDB() : *** ReadBlockFromDisk failed at %d, hash=%s",
-                            pIndex->height, pIndex->GetBlockHash().ToString());
+        // check level 0: read from disk, the next batch of blocks is read in parallel
+        if (batchPos >= batchBlocks.size()) {
+            batchIndexes.clear();
+            for (const CBlockIndex *pNext = pIndex; pNext && pNext->pprev && batchIndexes.size() < READ_BATCH_SIZE &&
+                                                    pNext->height >= chainActive.Height() - nCheckDepth;
+                 pNext = pNext->pprev)
+                batchIndexes.push_back(pNext);
+
+            if (!ReadBlocksFromDisk(batchIndexes, batchBlocks, nReadThreads))
+                return ERRORMSG("VerifyDB() : *** ReadBlockFromDisk failed from %d, hash=%s",
+                                pIndex->height, pIndex->GetBlockHash().ToString());
+            batchPos = 0;
+        }
+        CBlock &block = batchBlocks[batchPos++];
 
         // check level 1: verify block validity
         if (nCheckLevel >= 1 && !CheckBlock(block, state, *spCW, false))
@@ -2471,6 +2745,7 @@ bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth) {
 
 void UnloadBlockIndex() {
     mapBlockIndex.clear();
+    blockIndexArena.Clear();
     setBlockIndexValid.clear();
     chainActive.SetTip(nullptr);
     pIndexBestInvalid = nullptr;
@@ -2524,7 +2799,7 @@ void PrintBlockTree() {
     AssertLockHeld(cs_main);
     // pre-compute tree structure
     map<CBlockIndex *, vector<CBlockIndex *> > mapNext;
-    for (map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi) {
+    for (BlockMap::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi) {
         CBlockIndex *pIndex = (*mi).second;
         mapNext[pIndex->pprev].push_back(pIndex);
     }
@@ -2703,10 +2978,7 @@ class CMainCleanup {
    public:
     CMainCleanup() {}
     ~CMainCleanup() {
-        // block headers
-        map<uint256, CBlockIndex *>::iterator it1 = mapBlockIndex.begin();
-        for (; it1 != mapBlockIndex.end(); it1++)
-            delete (*it1).second;
+        // block headers, the entries are freed with blockIndexArena
         mapBlockIndex.clear();
 
         // orphan blocks
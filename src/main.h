@@ -42,9 +42,10 @@ extern CCriticalSection cs_main;
 /** The currently-connected chain of blocks. */
 extern CChain chainActive;
 extern CSignatureCache signatureCache;
+extern CPubKeyCache pubKeyCache;
 
 extern CTxMemPool mempool;
-extern map<uint256, CBlockIndex *> mapBlockIndex;
+extern BlockMap mapBlockIndex;
 extern uint64_t nLastBlockTx;
 extern uint64_t nLastBlockSize;
 extern const string strMessageMagic;
@@ -53,6 +54,8 @@ extern bool ReadBlockFromDisk(const CBlockIndex *pIndex, CBlock &block) ;
 extern bool mining;     // could be changed due to vote change
 extern CKeyID minerKeyId;  // miner accout keyId
 extern CKeyID nodeKeyId;   // first keyId of the node
+extern bool fPruneMode;        // -prune is set
+extern uint64_t nPruneTarget;  // bytes of the block and undo files to keep under
 
 class CValidationState;
 class CWalletInterface;
@@ -94,6 +97,10 @@ bool CheckDiskSpace(uint64_t nAdditionalBytes = 0);
 
 /** Verify consistency of the block and coin databases */
 bool VerifyDB(int32_t nCheckLevel, int32_t nCheckDepth);
+/** Number of the latest blocks of the active chain that must be kept on disk, see MIN_BLOCKS_TO_KEEP */
+int32_t GetMinBlocksToKeep();
+/** Delete the block and undo files of finalized blocks while the files are over the -prune target */
+void PruneBlockFilesIfNeeded();
 
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
@@ -114,9 +121,33 @@ void Misbehaving(NodeId nodeid, int32_t howmuch);
 
 bool VerifySignature(const uint256 &sigHash, const std::vector<uint8_t> &signature, const CPubKey &pubKey);
 
-/** (try to) add transaction to memory pool **/
+/** The values of the active chain tip which are read by the validation of each tx, computed once per tip */
+struct CChainTipContext {
+    int32_t height           = 0;
+    uint256 block_hash;
+    uint32_t fuel_rate       = 0;
+    uint32_t block_time      = 0;
+    uint32_t prev_block_time = 0;
+};
+
+/** Get the context of the active chain tip, which is rebuilt when the tip changes */
+std::shared_ptr<const CChainTipContext> GetChainTipContext();
+
+/** (try to) add transaction to memory pool, entering it at nEntryTime and nEntryHeight if given **/
 bool AcceptToMemoryPool(CTxMemPool &pool, CValidationState &state, CBaseTx *pBaseTx,
-                        bool fLimitFree, bool fRejectInsaneFee = false);
+                        bool fLimitFree, bool fRejectInsaneFee = false, int64_t nEntryTime = 0,
+                        int32_t nEntryHeight = -1);
+
+struct CMempoolLoadStats {
+    uint32_t accepted = 0;
+    uint32_t expired  = 0;  // beyond the valid height of the tip
+    uint32_t existed  = 0;  // relayed again before they were reloaded
+    uint32_t failed   = 0;
+};
+
+/** Reload the txs of mempool.dat, see CTxMemPool::Dump() */
+bool LoadMempool(CTxMemPool &pool, CMempoolLoadStats &stats);
+bool DumpMempool(const CTxMemPool &pool);
 
 struct CNodeStateStats {
     int32_t nMisbehavior;
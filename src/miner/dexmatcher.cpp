@@ -0,0 +1,396 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "dexmatcher.h"
+
+#include "init.h"
+#include "main.h"
+#include "wallet/wallet.h"
+#include "persistence/dexdb.h"
+#include "persistence/cachewrapper.h"
+
+#include <boost/thread.hpp>
+
+extern CCacheDBManager *pCdMan;
+using uint128_t = unsigned __int128;
+
+///////////////////////////////////////////////////////////////////////////////
+// class CDEXOrderBook
+
+CDEXOrderBook::PriorityKey CDEXOrderBook::MakePriorityKey(const uint256 &orderId, const CDEXOrderDetail &order) {
+    uint64_t sortPrice = 0;
+    if (order.order_type == ORDER_LIMIT_PRICE)
+        sortPrice = (order.order_side == ORDER_BUY) ? (ULLONG_MAX - order.price) : order.price;
+    return std::make_tuple(sortPrice, order.tx_cord, orderId);
+}
+
+CDEXOrderBook::PriorityQueue &CDEXOrderBook::GetQueue(const CDEXOrderDetail &order) {
+    if (order.order_type == ORDER_LIMIT_PRICE)
+        return (order.order_side == ORDER_BUY) ? limit_bids : limit_asks;
+    else
+        return (order.order_side == ORDER_BUY) ? market_bids : market_asks;
+}
+
+void CDEXOrderBook::AddOrder(const uint256 &orderId, const CDEXOrderDetail &order) {
+    GetQueue(order).insert(MakePriorityKey(orderId, order));
+}
+
+void CDEXOrderBook::EraseOrder(const uint256 &orderId, const CDEXOrderDetail &order) {
+    GetQueue(order).erase(MakePriorityKey(orderId, order));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class CDEXMatchEngine
+
+uint64_t CDEXMatchEngine::GetBuyResidualAssets(const CDEXOrderDetail &buyOrder, uint64_t dealPrice) {
+    if (buyOrder.order_type == ORDER_MARKET_PRICE) {
+        // market buy order is limited by the coin amount, see step 7 of CDEXSettleTx::ExecuteTx
+        if (dealPrice == 0 || buyOrder.coin_amount <= buyOrder.total_deal_coin_amount)
+            return 0;
+        uint128_t residualCoins = buyOrder.coin_amount - buyOrder.total_deal_coin_amount;
+        uint128_t assets        = residualCoins * PRICE_BOOST / dealPrice;
+        return assets > ULLONG_MAX ? ULLONG_MAX : (uint64_t)assets;
+    }
+
+    if (buyOrder.asset_amount <= buyOrder.total_deal_asset_amount)
+        return 0;
+    return buyOrder.asset_amount - buyOrder.total_deal_asset_amount;
+}
+
+uint64_t CDEXMatchEngine::GetSellResidualAssets(const CDEXOrderDetail &sellOrder) {
+    if (sellOrder.asset_amount <= sellOrder.total_deal_asset_amount)
+        return 0;
+    return sellOrder.asset_amount - sellOrder.total_deal_asset_amount;
+}
+
+// make a deal item at dealPrice and accumulate the deal amounts to both orders
+static bool MakeDeal(const uint256 &buyOrderId, CDEXOrderDetail &buyOrder, const uint256 &sellOrderId,
+                     CDEXOrderDetail &sellOrder, uint64_t dealPrice, DEXDealItem &dealItem) {
+    uint64_t dealAssetAmount = std::min(CDEXMatchEngine::GetBuyResidualAssets(buyOrder, dealPrice),
+                                        CDEXMatchEngine::GetSellResidualAssets(sellOrder));
+    if (dealAssetAmount == 0)
+        return false;
+
+    // the same rounding as the deal_coin_amount check of CDEXSettleTx::ExecuteTx
+    uint64_t dealCoinAmount = CDEXOrderBaseTx::CalcCoinAmount(dealAssetAmount, dealPrice);
+    if (dealCoinAmount == 0)
+        return false;
+
+    dealItem.buyOrderId      = buyOrderId;
+    dealItem.sellOrderId     = sellOrderId;
+    dealItem.dealPrice       = dealPrice;
+    dealItem.dealCoinAmount  = dealCoinAmount;
+    dealItem.dealAssetAmount = dealAssetAmount;
+
+    buyOrder.total_deal_coin_amount   += dealCoinAmount;
+    buyOrder.total_deal_asset_amount  += dealAssetAmount;
+    sellOrder.total_deal_coin_amount  += dealCoinAmount;
+    sellOrder.total_deal_asset_amount += dealAssetAmount;
+    return true;
+}
+
+void CDEXMatchEngine::UpdateOrder(const uint256 &orderId, const CDEXOrderDetail &order) {
+    auto it = orders.find(orderId);
+    if (it == orders.end()) {
+        if (order.IsEmpty())
+            return;
+        orders.emplace(orderId, order);
+        order_books[DEXTradingPair(order.coin_symbol, order.asset_symbol)].AddOrder(orderId, order);
+    } else {
+        // the priority of an order never changes, only the dealt amounts are updated
+        it->second.total_deal_coin_amount  = order.total_deal_coin_amount;
+        it->second.total_deal_asset_amount = order.total_deal_asset_amount;
+    }
+}
+
+void CDEXMatchEngine::EraseOrder(const uint256 &orderId) {
+    auto it = orders.find(orderId);
+    if (it == orders.end())
+        return;
+
+    const CDEXOrderDetail &order = it->second;
+    auto bookIt = order_books.find(DEXTradingPair(order.coin_symbol, order.asset_symbol));
+    if (bookIt != order_books.end()) {
+        bookIt->second.EraseOrder(orderId, order);
+        if (bookIt->second.IsEmpty())
+            order_books.erase(bookIt);
+    }
+    orders.erase(it);
+}
+
+void CDEXMatchEngine::Clear() {
+    orders.clear();
+    order_books.clear();
+    loaded_height = 0;
+    loaded_block_hash.SetNull();
+}
+
+bool CDEXMatchEngine::LoadOrders(CDexDBCache &dexCache, uint32_t beginHeight, uint32_t endHeight) {
+    auto pGetter = dexCache.CreateOrdersGetter();
+    if (!pGetter->Execute(beginHeight, endHeight, 0, DEXBlockOrdersCache::KeyType()))
+        return ERRORMSG("%s(), get block orders failed! begin_height=%u, end_height=%u", __func__, beginHeight,
+                        endHeight);
+
+    for (const auto &item : pGetter->orders)
+        UpdateOrder(DEX_DB::GetOrderId(item.first), item.second);
+
+    return true;
+}
+
+bool CDEXMatchEngine::SyncOrders(CDexDBCache &dexCache, const CBlockIndex *pTipIndex) {
+    AssertLockHeld(cs_main);
+    if (pTipIndex == nullptr)
+        return false;
+
+    if (!loaded_block_hash.IsNull() && loaded_block_hash == pTipIndex->GetBlockHash())
+        return true;
+
+    const CBlockIndex *pLoadedIndex = nullptr;
+    if (!loaded_block_hash.IsNull() && (uint32_t)pTipIndex->height > loaded_height)
+        pLoadedIndex = pTipIndex->GetAncestor(loaded_height);
+
+    uint32_t beginHeight = 0;
+    if (pLoadedIndex != nullptr && pLoadedIndex->GetBlockHash() == loaded_block_hash) {
+        // refresh the loaded orders, which may be dealt or canceled by the new blocks
+        vector<uint256> orderIds;
+        orderIds.reserve(orders.size());
+        for (const auto &item : orders)
+            orderIds.push_back(item.first);
+
+        for (const auto &orderId : orderIds) {
+            CDEXOrderDetail order;
+            if (dexCache.GetActiveOrder(orderId, order))
+                UpdateOrder(orderId, order);
+            else
+                EraseOrder(orderId);
+        }
+        beginHeight = loaded_height + 1;
+    } else {
+        Clear();
+    }
+
+    if (!LoadOrders(dexCache, beginHeight, pTipIndex->height))
+        return false;
+
+    loaded_height     = pTipIndex->height;
+    loaded_block_hash = pTipIndex->GetBlockHash();
+    return true;
+}
+
+void CDEXMatchEngine::Match(uint32_t maxItems, vector<DEXDealItem> &dealItems) const {
+    // order id -> the order with the deal amounts of this round
+    std::map<uint256, CDEXOrderDetail> touched;
+    for (const auto &item : order_books) {
+        if (dealItems.size() >= maxItems)
+            break;
+        MatchBook(item.second, maxItems, touched, dealItems);
+    }
+}
+
+void CDEXMatchEngine::MatchBook(const CDEXOrderBook &book, uint32_t maxItems,
+                                std::map<uint256, CDEXOrderDetail> &touched,
+                                vector<DEXDealItem> &dealItems) const {
+    auto touch = [&](const CDEXOrderBook::PriorityKey &key) -> CDEXOrderDetail & {
+        const uint256 &orderId = std::get<2>(key);
+        auto it = touched.find(orderId);
+        if (it == touched.end())
+            it = touched.emplace(orderId, orders.at(orderId)).first;
+        return it->second;
+    };
+
+    // 1. market buy orders take the limit asks; 2. market sell orders take the limit bids
+    for (bool isBuyTaker : {true, false}) {
+        const auto &takers = isBuyTaker ? book.market_bids : book.market_asks;
+        const auto &makers = isBuyTaker ? book.limit_asks : book.limit_bids;
+        auto makerIt = makers.begin();
+        for (auto takerIt = takers.begin(); takerIt != takers.end(); takerIt++) {
+            CDEXOrderDetail &takerOrder = touch(*takerIt);
+            while (makerIt != makers.end() && dealItems.size() < maxItems) {
+                CDEXOrderDetail &makerOrder = touch(*makerIt);
+                CDEXOrderDetail &buyOrder   = isBuyTaker ? takerOrder : makerOrder;
+                CDEXOrderDetail &sellOrder  = isBuyTaker ? makerOrder : takerOrder;
+                const uint256 &buyOrderId   = std::get<2>(isBuyTaker ? *takerIt : *makerIt);
+                const uint256 &sellOrderId  = std::get<2>(isBuyTaker ? *makerIt : *takerIt);
+                uint64_t dealPrice          = makerOrder.price;
+
+                DEXDealItem dealItem;
+                if (MakeDeal(buyOrderId, buyOrder, sellOrderId, sellOrder, dealPrice, dealItem)) {
+                    dealItems.push_back(dealItem);
+                } else {
+                    uint64_t takerResidual = isBuyTaker ? GetBuyResidualAssets(buyOrder, dealPrice)
+                                                        : GetSellResidualAssets(sellOrder);
+                    if (takerResidual == 0)
+                        break;  // the taker can not deal any more at this price
+                    // the maker is dealt or too small to deal
+                    makerIt++;
+                    continue;
+                }
+
+                uint64_t makerResidual = isBuyTaker ? GetSellResidualAssets(sellOrder)
+                                                    : GetBuyResidualAssets(buyOrder, dealPrice);
+                if (makerResidual == 0)
+                    makerIt++;
+            }
+            if (makerIt == makers.end() || dealItems.size() >= maxItems)
+                break;
+        }
+    }
+
+    // 3. crossed limit orders deal at the price of the earlier order
+    auto bidIt = book.limit_bids.begin();
+    auto askIt = book.limit_asks.begin();
+    while (bidIt != book.limit_bids.end() && askIt != book.limit_asks.end() && dealItems.size() < maxItems) {
+        CDEXOrderDetail &buyOrder  = touch(*bidIt);
+        CDEXOrderDetail &sellOrder = touch(*askIt);
+        if (GetBuyResidualAssets(buyOrder, buyOrder.price) == 0) {
+            bidIt++;
+            continue;
+        }
+        if (GetSellResidualAssets(sellOrder) == 0) {
+            askIt++;
+            continue;
+        }
+        if (buyOrder.price < sellOrder.price)
+            break;
+
+        uint64_t dealPrice = (buyOrder.tx_cord < sellOrder.tx_cord) ? buyOrder.price : sellOrder.price;
+        DEXDealItem dealItem;
+        if (!MakeDeal(std::get<2>(*bidIt), buyOrder, std::get<2>(*askIt), sellOrder, dealPrice, dealItem)) {
+            // the smaller order is too small to deal any coins at this price, skip it
+            if (GetBuyResidualAssets(buyOrder, dealPrice) <= GetSellResidualAssets(sellOrder))
+                bidIt++;
+            else
+                askIt++;
+            continue;
+        }
+        dealItems.push_back(dealItem);
+    }
+}
+
+uint32_t CDEXMatchEngine::GetMaxItemsPerTx(uint32_t blockMaxSize, uint32_t maxItems) {
+    DEXDealItem maxItem = {uint256(), uint256(), ULLONG_MAX, ULLONG_MAX, ULLONG_MAX};
+    uint32_t itemSize   = ::GetSerializeSize(maxItem, SER_NETWORK, PROTOCOL_VERSION);
+    // a settle tx may take a quarter of the block at most
+    uint32_t sizeLimit  = std::max<uint32_t>(1, blockMaxSize / 4 / itemSize);
+    return std::max<uint32_t>(1, std::min<uint32_t>({maxItems, sizeLimit, (uint32_t)MAX_SETTLE_ITEM_COUNT}));
+}
+
+void CDEXMatchEngine::MakeSettleTxs(const CUserID &txUid, int32_t validHeight, const TokenSymbol &feeSymbol,
+                                    uint64_t fees, const vector<DEXDealItem> &dealItems,
+                                    vector<CDEXSettleTx> &settleTxs) const {
+    for (size_t begin = 0; begin < dealItems.size(); begin += max_items_per_tx) {
+        size_t end = std::min(dealItems.size(), begin + max_items_per_tx);
+        vector<DEXDealItem> batch(dealItems.begin() + begin, dealItems.begin() + end);
+        settleTxs.emplace_back(txUid, validHeight, feeSymbol, fees, batch);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// dex matcher thread
+
+static void ThreadDexMatcher(CWallet *pWallet) {
+    LogPrint(BCLog::INFO, "ThreadDexMatcher() : started\n");
+    RenameThread("coin-dexmatch");
+
+    CDEXMatchEngine engine;
+    uint32_t blockMaxSize   = SysCfg().GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
+    engine.max_items_per_tx = CDEXMatchEngine::GetMaxItemsPerTx(
+        blockMaxSize, SysCfg().GetArg("-dexmatchbatchsize", DEFAULT_DEX_MATCH_BATCH));
+    uint32_t maxTxCount     = std::max<int64_t>(1, SysCfg().GetArg("-dexmatchmaxtxs", DEFAULT_DEX_MATCH_TXS));
+
+    const CBlockIndex *pLastTip = nullptr;
+    vector<uint256> pendingTxids;
+
+    try {
+        while (true) {
+            boost::this_thread::interruption_point();
+            MilliSleep(200);
+
+            vector<CDEXSettleTx> settleTxs;
+            CKeyID matchKeyId;
+            {
+                LOCK(cs_main);
+                const CBlockIndex *pTip = chainActive.Tip();
+                if (pTip == nullptr || pTip == pLastTip || SysCfg().IsReindex() || IsInitialBlockDownload())
+                    continue;
+
+                // wait for the settle txs of last round to be packed or dropped, so that the orders
+                // dealt by them will not be matched again
+                bool hasPending = std::any_of(pendingTxids.begin(), pendingTxids.end(),
+                                              [](const uint256 &txid) { return mempool.Exists(txid); });
+                if (hasPending)
+                    continue;
+                pendingTxids.clear();
+                pLastTip = pTip;
+
+                CRegID matchRegId = SysCfg().GetDexMatchSvcRegId();
+                if (!pCdMan->pAccountCache->GetKeyId(CUserID(matchRegId), matchKeyId) ||
+                    !pWallet->HaveKey(matchKeyId)) {
+                    LogPrint(BCLog::DEX, "%s(), the key of dex match-svc regid=%s is not in wallet\n", __func__,
+                             matchRegId.ToString());
+                    continue;
+                }
+
+                int64_t startTime = GetTimeMicros();
+                if (!engine.SyncOrders(*pCdMan->pDexCache, pTip))
+                    continue;
+                int64_t syncTime = GetTimeMicros();
+
+                vector<DEXDealItem> dealItems;
+                engine.Match(engine.max_items_per_tx * maxTxCount, dealItems);
+                int64_t matchTime = GetTimeMicros();
+
+                if (!dealItems.empty()) {
+                    uint64_t minFee = 0;
+                    if (!GetTxMinFee(DEX_TRADE_SETTLE_TX, pTip->height, SYMB::WICC, minFee)) {
+                        LogPrint(BCLog::ERROR, "%s(), get min fee of settle tx failed\n", __func__);
+                        continue;
+                    }
+                    engine.MakeSettleTxs(CUserID(matchRegId), pTip->height, SYMB::WICC, minFee, dealItems,
+                                         settleTxs);
+                }
+
+                LogPrint(BCLog::DEX, "%s(), height=%d, orders=%u, books=%u, deals=%u, settle_txs=%u, "
+                         "sync_us=%lld, match_us=%lld\n", __func__, pTip->height, engine.GetOrderCount(),
+                         engine.GetBookCount(), dealItems.size(), settleTxs.size(), syncTime - startTime,
+                         matchTime - syncTime);
+            }
+
+            for (auto &settleTx : settleTxs) {
+                if (!pWallet->Sign(matchKeyId, settleTx.ComputeSignatureHash(), settleTx.signature)) {
+                    LogPrint(BCLog::ERROR, "%s(), sign settle tx failed! wallet locked?\n", __func__);
+                    break;
+                }
+
+                auto ret = pWallet->CommitTx(&settleTx);
+                if (!std::get<0>(ret)) {
+                    LogPrint(BCLog::ERROR, "%s(), commit settle tx failed! txid=%s, %s\n", __func__,
+                             settleTx.GetHash().GetHex(), std::get<1>(ret));
+                    break;
+                }
+                pendingTxids.push_back(settleTx.GetHash());
+            }
+        }
+    } catch (boost::thread_interrupted &) {
+        LogPrint(BCLog::INFO, "ThreadDexMatcher() : terminated\n");
+        throw;
+    }
+}
+
+void GenerateDexSettleTxs(bool fGenerate, CWallet *pWallet) {
+    static boost::thread_group *matcherThreads = nullptr;
+
+    if (matcherThreads != nullptr) {
+        matcherThreads->interrupt_all();
+        matcherThreads->join_all();
+        delete matcherThreads;
+        matcherThreads = nullptr;
+    }
+
+    if (!fGenerate || pWallet == nullptr)
+        return;
+
+    matcherThreads = new boost::thread_group();
+    matcherThreads->create_thread(boost::bind(&ThreadDexMatcher, pWallet));
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef MINER_DEXMATCHER_H
+#define MINER_DEXMATCHER_H
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "entities/dexorder.h"
+#include "tx/dextx.h"
+
+class CBlockIndex;
+class CDexDBCache;
+class CWallet;
+
+static const bool DEFAULT_DEX_MATCH             = false;
+static const uint32_t DEFAULT_DEX_MATCH_BATCH   = 500;   // max deal items per settle tx
+static const uint32_t DEFAULT_DEX_MATCH_TXS     = 10;    // max settle txs emitted per round
+
+// (coin_symbol, asset_symbol)
+typedef std::pair<TokenSymbol, TokenSymbol> DEXTradingPair;
+
+/**
+ * Price-time priority order book of one trading pair.
+ * Limit bids are sorted by price desc, limit asks by price asc and both then by tx cord (time),
+ * market orders are sorted by tx cord only.
+ */
+class CDEXOrderBook {
+public:
+    // (sort price, tx cord, order id)
+    typedef std::tuple<uint64_t, CTxCord, uint256> PriorityKey;
+    typedef std::set<PriorityKey> PriorityQueue;
+
+    PriorityQueue limit_bids;
+    PriorityQueue limit_asks;
+    PriorityQueue market_bids;
+    PriorityQueue market_asks;
+
+public:
+    void AddOrder(const uint256 &orderId, const CDEXOrderDetail &order);
+    void EraseOrder(const uint256 &orderId, const CDEXOrderDetail &order);
+    bool IsEmpty() const {
+        return limit_bids.empty() && limit_asks.empty() && market_bids.empty() && market_asks.empty();
+    }
+    size_t GetOrderCount() const {
+        return limit_bids.size() + limit_asks.size() + market_bids.size() + market_asks.size();
+    }
+
+    static PriorityKey MakePriorityKey(const uint256 &orderId, const CDEXOrderDetail &order);
+
+private:
+    PriorityQueue &GetQueue(const CDEXOrderDetail &order);
+};
+
+/**
+ * In-process matching engine for active dex orders.
+ * Matching follows the same pricing rules as CDEXSettleTx::ExecuteTx:
+ *   1. market buy orders take the best limit asks at the ask price;
+ *   2. market sell orders take the best limit bids at the bid price;
+ *   3. crossed limit orders deal at the price of the earlier (maker) order.
+ * Market orders are never matched with each other since there is no reference price.
+ */
+class CDEXMatchEngine {
+public:
+    uint32_t max_items_per_tx = DEFAULT_DEX_MATCH_BATCH;
+
+private:
+    std::map<uint256, CDEXOrderDetail> orders;            // order id -> active order
+    std::map<DEXTradingPair, CDEXOrderBook> order_books;
+    uint32_t loaded_height = 0;
+    uint256 loaded_block_hash;
+
+public:
+    // add or replace an active order, fully dealt orders are removed
+    void UpdateOrder(const uint256 &orderId, const CDEXOrderDetail &order);
+    void EraseOrder(const uint256 &orderId);
+    void Clear();
+
+    /**
+     * Sync the books with the active orders of the dex cache at tip. Must be called with cs_main held.
+     * New orders are loaded from the block orders of the connected blocks only,
+     * a full reload is done on startup and on reorg.
+     */
+    bool SyncOrders(CDexDBCache &dexCache, const CBlockIndex *pTipIndex);
+
+    // Compute up to maxItems deals of all order books, the books are left untouched
+    void Match(uint32_t maxItems, vector<DEXDealItem> &dealItems) const;
+
+    size_t GetOrderCount() const { return orders.size(); }
+    size_t GetBookCount() const { return order_books.size(); }
+
+    // split deal items into settle tx batches
+    void MakeSettleTxs(const CUserID &txUid, int32_t validHeight, const TokenSymbol &feeSymbol, uint64_t fees,
+                       const vector<DEXDealItem> &dealItems, vector<CDEXSettleTx> &settleTxs) const;
+
+    // max deal items of one settle tx which keeps the tx well below the block size limit
+    static uint32_t GetMaxItemsPerTx(uint32_t blockMaxSize, uint32_t maxItems);
+
+    static uint64_t GetBuyResidualAssets(const CDEXOrderDetail &buyOrder, uint64_t dealPrice);
+    static uint64_t GetSellResidualAssets(const CDEXOrderDetail &sellOrder);
+
+private:
+    bool LoadOrders(CDexDBCache &dexCache, uint32_t beginHeight, uint32_t endHeight);
+    void MatchBook(const CDEXOrderBook &book, uint32_t maxItems, std::map<uint256, CDEXOrderDetail> &touched,
+                   vector<DEXDealItem> &dealItems) const;
+};
+
+/** Start or stop the dex matcher thread, which emits settle txs signed by the dex match service account */
+void GenerateDexSettleTxs(bool fGenerate, CWallet *pWallet);
+
+#endif //MINER_DEXMATCHER_H
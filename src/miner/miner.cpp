@@ -263,7 +263,7 @@ bool VerifyRewardTx(const CBlock *pBlock, CCacheWrapper &cwIn, bool bNeedRunTx,
                 pBlockIndex->pprev != nullptr ? pBlockIndex->pprev->GetBlockTime() : pBlockIndex->GetBlockTime();
             CTxExecuteContext context(pBlock->GetHeight(), i, pBlock->GetFuelRate(), pBlock->GetTime(), prevBlockTime,
                                       spCW.get(), &state);
-            if (!pBaseTx->ExecuteTx(context)) {
+            if (!TimedExecuteTx(*pBaseTx, context)) {
                 pCdMan->pLogCache->SetExecuteFail(pBlock->GetHeight(), pBaseTx->GetHash(), state.GetRejectCode(),
                                                   state.GetRejectReason());
                 return ERRORMSG("VerifyRewardTx() : failed to execute transaction, txid=%s",
@@ -305,7 +305,7 @@ static bool CreateNewBlockPreStableCoinRelease(CCacheWrapper &cwIn, std::unique_
         uint32_t blockTime      = pBlock->GetTime();
         int32_t height          = pIndexPrev->height + 1;
         int32_t index           = 0; // block reward tx
-        uint32_t fuelRate       = GetElementForBurn(pIndexPrev);
+        uint32_t fuelRate       = GetChainTipContext()->fuel_rate;
         uint64_t totalBlockSize = ::GetSerializeSize(*pBlock, SER_NETWORK, PROTOCOL_VERSION);
         uint64_t totalRunStep   = 0;
         uint64_t totalFees      = 0;
@@ -337,7 +337,7 @@ static bool CreateNewBlockPreStableCoinRelease(CCacheWrapper &cwIn, std::unique_
                 pBaseTx->nFuelRate = fuelRate;
                 uint32_t prevBlockTime = pIndexPrev->GetBlockTime();
                 CTxExecuteContext context(height, index + 1, fuelRate, blockTime, prevBlockTime, spCW.get(), &state, true);
-                if (!pBaseTx->CheckTx(context) || !pBaseTx->ExecuteTx(context)) {
+                if (!TimedCheckTx(*pBaseTx, context) || !TimedExecuteTx(*pBaseTx, context)) {
                     LogPrint(BCLog::MINER, "CreateNewBlockPreStableCoinRelease() : failed to pack transaction, txid: %s\n",
                             pBaseTx->GetHash().GetHex());
 
@@ -410,7 +410,7 @@ static bool CreateStableCoinGenesisBlock(std::unique_ptr<CBlock> &pBlock) {
     // Fill in header
     CBlockIndex *pIndexPrev = chainActive.Tip();
     int32_t height          = pIndexPrev->height + 1;
-    uint32_t fuelRate       = GetElementForBurn(pIndexPrev);
+    uint32_t fuelRate       = GetChainTipContext()->fuel_rate;
 
     pBlock->SetPrevBlockHash(pIndexPrev->GetBlockHash());
     pBlock->SetNonce(0);
@@ -437,7 +437,7 @@ static bool CreateNewBlockStableCoinRelease(int64_t startMiningMs, CCacheWrapper
         uint32_t blockTime                 = pBlock->GetTime();
         int32_t height                     = pIndexPrev->height + 1;
         int32_t index                      = 0; // 0: block reward tx
-        uint32_t fuelRate                  = GetElementForBurn(pIndexPrev);
+        uint32_t fuelRate                  = GetChainTipContext()->fuel_rate;
         uint64_t totalBlockSize            = ::GetSerializeSize(*pBlock, SER_NETWORK, PROTOCOL_VERSION);
         uint64_t totalRunStep              = 0;
         uint64_t totalFees                 = 0;
@@ -497,7 +497,7 @@ static bool CreateNewBlockStableCoinRelease(int64_t startMiningMs, CCacheWrapper
 
                 uint32_t prevBlockTime = pIndexPrev->GetBlockTime();
                 CTxExecuteContext context(height, index + 1, fuelRate, blockTime, prevBlockTime, spCW.get(), &state, true);
-                if (!pBaseTx->CheckTx(context) || !pBaseTx->ExecuteTx(context)) {
+                if (!TimedCheckTx(*pBaseTx, context) || !TimedExecuteTx(*pBaseTx, context)) {
                     LogPrint(BCLog::MINER, "CreateNewBlockStableCoinRelease() : failed to pack transaction: %s\n",
                              pBaseTx->ToString(spCW->accountCache));
 
@@ -659,6 +659,7 @@ static bool MineBlock(int64_t startMiningMs, CBlockIndex *pPrevIndex, Miner &min
 
         pBlock->SetTime(MillisToSecond(startMiningMs));  // set block time first
 
+        CPerfTimer packTimer(perfStats.minerPack);
         if (blockHeight == (int32_t)SysCfg().GetStableCoinGenesisHeight()) {
             success = CreateStableCoinGenesisBlock(pBlock);  // stable coin genesis
         } else if (GetFeatureForkVersion(blockHeight) == MAJOR_VER_R1) {
@@ -666,6 +667,7 @@ static bool MineBlock(int64_t startMiningMs, CBlockIndex *pPrevIndex, Miner &min
         } else {
             success = CreateNewBlockStableCoinRelease(startMiningMs, *spCW, pBlock);    // stable coin release
         }
+        packTimer.Stop();
 
         if (!success) {
             LogPrint(BCLog::MINER, "MineBlock() : fail to create new block! height=%d, regid=%s, "
@@ -9,20 +9,74 @@
 
 CPBFTContext pbftContext ;
 
-bool CPBFTContext::GetMinerListByBlockHash(const uint256 blockHash, set<CRegID>& miners) {
+CPBFTDelegates::CPBFTDelegates(const VoteDelegateVector &delegates) {
+    for (const auto &delegate : delegates) {
+        if (regids.insert(delegate.regid).second)
+            indexes.emplace(delegate.regid, indexes.size());
+    }
+}
+
+int32_t CPBFTDelegates::GetIndex(const CRegID &regid) const {
+    auto it = indexes.find(regid);
+    return it == indexes.end() ? -1 : (int32_t)it->second;
+}
+
+bool CPBFTBlockVotes::AddSigner(const CRegID &miner) {
+    if (!signers.insert(miner).second)
+        return false;
+
+    if (pDelegates)
+        SetDelegateBit(miner);
+    return true;
+}
+
+uint32_t CPBFTBlockVotes::GetQuorumCount(const std::shared_ptr<const CPBFTDelegates> &pDelegatesIn) {
+    // the delegates are known after the previous block is connected, rebuild the bitmap once
+    if (pDelegates != pDelegatesIn) {
+        pDelegates = pDelegatesIn;
+        delegateBits.assign(pDelegates->GetSize(), false);
+        quorumCount = 0;
+        for (const auto &miner : signers) {
+            SetDelegateBit(miner);
+        }
+    }
+    return quorumCount;
+}
+
+void CPBFTBlockVotes::SetDelegateBit(const CRegID &miner) {
+    int32_t index = pDelegates->GetIndex(miner);
+    if (index >= 0 && !delegateBits[index]) {
+        delegateBits[index] = true;
+        ++quorumCount;
+    }
+}
 
-    auto it = blockMinerListMap.find(blockHash) ;
-    if(it == blockMinerListMap.end())
+bool CPBFTContext::GetMinerListByBlockHash(const uint256 blockHash, set<CRegID>& miners) {
+    auto pDelegates = GetDelegatesByBlockHash(blockHash);
+    if (pDelegates == nullptr)
         return false;
-    miners = it->second ;
+    miners = pDelegates->GetRegIds();
     return true ;
 }
 
+std::shared_ptr<const CPBFTDelegates> CPBFTContext::GetDelegatesByBlockHash(const uint256 &blockHash) {
+    LOCK(cs_delegates);
+    auto it = blockDelegatesMap.find(blockHash);
+    if (it == blockDelegatesMap.end())
+        return nullptr;
+    return it->second;
+}
+
 bool CPBFTContext::SaveMinersByHash(uint256 blockhash, VoteDelegateVector delegates) {
-    set<CRegID> miners ;
-    for(auto delegate: delegates){
-        miners.insert(delegate.regid);
+    LOCK(cs_delegates);
+    if (blockDelegatesMap.count(blockhash))
+        return true;
+
+    if (blockDelegatesMap.size() >= PBFT_BLOCK_CACHE_SIZE) {
+        blockDelegatesMap.erase(blockDelegatesOrder.front());
+        blockDelegatesOrder.pop_front();
     }
-    blockMinerListMap.insert(std::make_pair(blockhash, miners));
+    blockDelegatesMap.emplace(blockhash, std::make_shared<const CPBFTDelegates>(delegates));
+    blockDelegatesOrder.push_back(blockhash);
     return true ;
-}
\ No newline at end of file
+}
@@ -7,11 +7,12 @@
 #ifndef MINER_PBFTCONTEXT_H
 #define MINER_PBFTCONTEXT_H
 
+#include <deque>
 #include <map>
+#include <memory>
 #include <set>
 #include "sync.h"
 #include "commons/uint256.h"
-#include "commons/limitedmap.h"
 #include "commons/mruset.h"
 #include "entities/vote.h"
 
@@ -19,40 +20,76 @@ class CRegID ;
 class CBlockConfirmMessage ;
 class CBlockFinalityMessage;
 
+static const uint32_t PBFT_BLOCK_CACHE_SIZE = 500;
+
+/** The active delegates of a block, indexed for the quorum bitmaps of the next block */
+class CPBFTDelegates {
+public:
+    CPBFTDelegates(const VoteDelegateVector &delegates);
+
+    // the bit index of the delegate, -1 if it is not a delegate
+    int32_t GetIndex(const CRegID &regid) const;
+    uint32_t GetSize() const { return indexes.size(); }
+    const set<CRegID> &GetRegIds() const { return regids; }
+
+private:
+    map<CRegID, uint32_t> indexes;
+    set<CRegID> regids;
+};
+
+/**
+ * The signers of the pbft messages of one block. The signers which are delegates of the previous
+ * block are kept in a bitmap so that the quorum is counted without scanning the messages.
+ */
+class CPBFTBlockVotes {
+public:
+    // return false if the miner has signed the block
+    bool AddSigner(const CRegID &miner);
+    uint32_t GetSignerCount() const { return signers.size(); }
+    // the count of signers who are delegates
+    uint32_t GetQuorumCount(const std::shared_ptr<const CPBFTDelegates> &pDelegatesIn);
+
+private:
+    void SetDelegateBit(const CRegID &miner);
+
+private:
+    set<CRegID> signers;
+    std::shared_ptr<const CPBFTDelegates> pDelegates;
+    vector<bool> delegateBits;
+    uint32_t quorumCount = 0;
+};
 
 template <typename MsgType>
 class CPBFTMessageMan {
 
 private:
     CCriticalSection cs_pbftmessage;
-    limitedmap<uint256, set<MsgType>> blockMessagesMap ;
+    map<uint256, CPBFTBlockVotes> blockVotesMap;
+    std::deque<uint256> blockVotesOrder;  // eviction order of blockVotesMap
     mruset<uint256> broadcastedBlockHashSet ;
     mruset<MsgType> messageKnown ;
+    size_t maxSize;
 
 public:
-    CPBFTMessageMan(){
-            blockMessagesMap.max_size(500) ;
-            broadcastedBlockHashSet.max_size(500) ;
-            messageKnown.max_size(500) ;
-    }
-
-    CPBFTMessageMan(const int maxSize) {
-        blockMessagesMap.max_size(maxSize) ;
-        broadcastedBlockHashSet.max_size(maxSize) ;
-        messageKnown.max_size(maxSize) ;
+    CPBFTMessageMan(const int maxSizeIn = PBFT_BLOCK_CACHE_SIZE) : maxSize(maxSizeIn) {
+        broadcastedBlockHashSet.max_size(maxSizeIn) ;
+        messageKnown.max_size(maxSizeIn) ;
     }
 
 public:
 
     bool IsBroadcastedBlock(uint256 blockHash) {
+        LOCK(cs_pbftmessage);
         return broadcastedBlockHashSet.count(blockHash) > 0;
     }
 
     bool SaveBroadcastedBlock(uint256 blockHash) {
+        LOCK(cs_pbftmessage);
         broadcastedBlockHashSet.insert(blockHash) ;
         return true ;
     }
     bool IsKnown(const MsgType msg) {
+        LOCK(cs_pbftmessage);
         return messageKnown.count(msg) != 0 ;
     }
 
@@ -62,48 +99,47 @@ public:
             return true;
     }
 
+    // return the count of signers of the block
     int  SaveMessageByBlock(const uint256 blockHash,const MsgType& msg) {
-
             LOCK(cs_pbftmessage);
-            auto it = blockMessagesMap.find(blockHash) ;
-            if(it == blockMessagesMap.end()) {
-                    set<MsgType> messages ;
-                    messages.insert(msg) ;
-                    blockMessagesMap.insert(std::make_pair(blockHash, messages)) ;
-                    return  1 ;
-            } else {
-                    set<MsgType> v = blockMessagesMap[blockHash] ;
-                    v.insert(msg);
-                    blockMessagesMap.update(it, v);
-                    return v.size();
+            auto it = blockVotesMap.find(blockHash);
+            if (it == blockVotesMap.end()) {
+                if (blockVotesMap.size() >= maxSize) {
+                    blockVotesMap.erase(blockVotesOrder.front());
+                    blockVotesOrder.pop_front();
+                }
+                it = blockVotesMap.emplace(blockHash, CPBFTBlockVotes()).first;
+                blockVotesOrder.push_back(blockHash);
             }
+            it->second.AddSigner(msg.miner);
+            return it->second.GetSignerCount();
     }
 
-    bool GetMessagesByBlockHash(const uint256 hash, set<MsgType>& msgs) {
-            auto it = blockMessagesMap.find(hash) ;
-            if(it == blockMessagesMap.end())
-                return false;
-            msgs = it->second ;
-            return true ;
+    // the count of signers of the block who are in delegates
+    uint32_t GetQuorumCount(const uint256 &blockHash, const std::shared_ptr<const CPBFTDelegates> &pDelegates) {
+            LOCK(cs_pbftmessage);
+            auto it = blockVotesMap.find(blockHash);
+            if (it == blockVotesMap.end() || pDelegates == nullptr)
+                return 0;
+            return it->second.GetQuorumCount(pDelegates);
     }
 
 };
 
 class CPBFTContext {
 
+private:
+    CCriticalSection cs_delegates;
+    map<uint256, std::shared_ptr<const CPBFTDelegates>> blockDelegatesMap;
+    std::deque<uint256> blockDelegatesOrder;  // eviction order of blockDelegatesMap
 
 public:
 
     CPBFTMessageMan<CBlockConfirmMessage> confirmMessageMan ;
     CPBFTMessageMan<CBlockFinalityMessage> finalityMessageMan ;
-    limitedmap<uint256, set<CRegID>> blockMinerListMap ;
-
-    CPBFTContext(){
-        blockMinerListMap.max_size(500) ;
-
-    }
 
     bool GetMinerListByBlockHash(const uint256 blockHash, set<CRegID>& delegates) ;
+    std::shared_ptr<const CPBFTDelegates> GetDelegatesByBlockHash(const uint256 &blockHash);
 
     bool SaveMinersByHash(uint256 blockhash, VoteDelegateVector delegates) ;
 
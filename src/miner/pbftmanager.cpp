@@ -10,12 +10,26 @@
 #include "p2p/protocol.h"
 #include "miner/miner.h"
 #include "wallet/wallet.h"
+#include "commons/messagequeue.h"
+
+#include <boost/thread.hpp>
 
 CPBFTMan pbftMan;
 extern CPBFTContext pbftContext;
 extern CWallet *pWalletMain;
 extern CCacheDBManager *pCdMan;
 
+// whether the delegates of the previous block have confirmed the block
+template <typename MsgType>
+static bool HasFinalityQuorum(CPBFTMessageMan<MsgType> &msgMan, const CBlockIndex *pIndex) {
+    if (pIndex == nullptr || pIndex->pprev == nullptr)
+        return false;
+
+    auto pDelegates = pbftContext.GetDelegatesByBlockHash(pIndex->pprev->GetBlockHash());
+    return pDelegates != nullptr &&
+           msgMan.GetQuorumCount(pIndex->GetBlockHash(), pDelegates) >= (uint32_t)FINALITY_BLOCK_CONFIRM_MINER_COUNT;
+}
+
 CBlockIndex* CPBFTMan::GetLocalFinIndex(){
 
     if(!localFinIndex) {
@@ -70,6 +84,7 @@ bool CPBFTMan::UpdateLocalFinBlock(const uint32_t height) {
 
         localFinIndex = pTemp;
         localFinLastUpdate = GetTime();
+        RecordFinalityDelay(pTemp, localFinStats, "local");
         return true ;
     }
 
@@ -99,6 +114,7 @@ bool CPBFTMan::UpdateGlobalFinBlock(const uint32_t height) {
         globalFinIndex = pTemp;
         globalFinHash = pTemp->GetBlockHash() ;
         pCdMan->pBlockCache->WriteGlobalFinBlock(pTemp->height, pTemp->GetBlockHash()) ;
+        RecordFinalityDelay(pTemp, globalFinStats, "global");
         return true ;
     }
 
@@ -114,24 +130,8 @@ bool CPBFTMan::UpdateLocalFinBlock(const CBlockIndex* pIndex){
 
         CBlockIndex* pTemp = chainActive[height] ;
 
-        set<CBlockConfirmMessage> messageSet ;
-        set<CRegID> miners;
-
-        if(pbftContext.confirmMessageMan.GetMessagesByBlockHash(pTemp->GetBlockHash(), messageSet)
-           && pbftContext.GetMinerListByBlockHash(pTemp->pprev->GetBlockHash(),miners)){
-
-            if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                int count =0;
-                for(auto msg: messageSet){
-                    if(miners.count(msg.miner))
-                        count++ ;
-                    if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                        return UpdateLocalFinBlock( height) ;
-                    }
-                }
-            }
-
-        }
+        if (HasFinalityQuorum(pbftContext.confirmMessageMan, pTemp))
+            return UpdateLocalFinBlock(height);
 
         height--;
 
@@ -153,23 +153,9 @@ bool CPBFTMan::UpdateLocalFinBlock(const CBlockConfirmMessage& msg){
     if(pIndex->GetBlockHash() != msg.blockHash)
         return false;
 
-    set<CBlockConfirmMessage> messageSet ;
-    set<CRegID> miners;
-
-    if(pbftContext.confirmMessageMan.GetMessagesByBlockHash(pIndex->GetBlockHash(), messageSet)
-       && pbftContext.GetMinerListByBlockHash(pIndex->pprev->GetBlockHash(),miners)) {
-        if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-            int count =0;
-            for(auto msg: messageSet){
-                if(miners.count(msg.miner))
-                    count++ ;
-                if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                    return UpdateLocalFinBlock(pIndex->height) ;
-                }
-            }
-        }
+    if (HasFinalityQuorum(pbftContext.confirmMessageMan, pIndex))
+        return UpdateLocalFinBlock(pIndex->height);
 
-    }
     return false;
 }
 
@@ -183,24 +169,8 @@ bool CPBFTMan::UpdateGlobalFinBlock(const CBlockIndex* pIndex){
 
         CBlockIndex* pTemp = chainActive[height] ;
 
-        set<CBlockFinalityMessage> messageSet ;
-        set<CRegID> miners;
-
-        if(pbftContext.finalityMessageMan.GetMessagesByBlockHash(pTemp->GetBlockHash(), messageSet)
-           && pbftContext.GetMinerListByBlockHash(pTemp->pprev->GetBlockHash(),miners)){
-
-            if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                int count =0;
-                for(auto msg: messageSet){
-                    if(miners.count(msg.miner))
-                        count++ ;
-                    if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                        return UpdateGlobalFinBlock( height) ;
-                    }
-                }
-            }
-
-        }
+        if (HasFinalityQuorum(pbftContext.finalityMessageMan, pTemp))
+            return UpdateGlobalFinBlock(height);
 
         height--;
 
@@ -213,6 +183,39 @@ int64_t  CPBFTMan::GetLocalFinLastUpdate() const {
     return localFinLastUpdate ;
 }
 
+void CPBFTMan::SaveBlockArrivalTime(const uint256 &blockHash) {
+    LOCK(cs_finstats);
+    if (!blockArrivalTimes.emplace(blockHash, GetTimeMillis()).second)
+        return;
+
+    blockArrivalOrder.push_back(blockHash);
+    if (blockArrivalOrder.size() > PBFT_BLOCK_CACHE_SIZE) {
+        blockArrivalTimes.erase(blockArrivalOrder.front());
+        blockArrivalOrder.pop_front();
+    }
+}
+
+void CPBFTMan::RecordFinalityDelay(const CBlockIndex *pIndex, CPBFTFinalityStats &stats, const char *finType) {
+    LOCK(cs_finstats);
+    auto it = blockArrivalTimes.find(pIndex->GetBlockHash());
+    if (it == blockArrivalTimes.end())
+        return;
+
+    int64_t delay = GetTimeMillis() - it->second;
+    stats.count++;
+    stats.total_ms += delay;
+    stats.max_ms  = std::max(stats.max_ms, delay);
+    stats.last_ms = delay;
+    LogPrint(BCLog::MINER, "%s finality of block[%d] %s in %lldms since arrival\n", finType, pIndex->height,
+             pIndex->GetBlockHash().GetHex(), delay);
+}
+
+void CPBFTMan::GetFinalityStats(CPBFTFinalityStats &localStats, CPBFTFinalityStats &globalStats) {
+    LOCK(cs_finstats);
+    localStats  = localFinStats;
+    globalStats = globalFinStats;
+}
+
 bool CPBFTMan::UpdateGlobalFinBlock(const CBlockFinalityMessage& msg){
 
     CBlockIndex* fi = GetGlobalFinIndex();
@@ -227,23 +230,9 @@ bool CPBFTMan::UpdateGlobalFinBlock(const CBlockFinalityMessage& msg){
     if(pIndex->GetBlockHash() != msg.blockHash)
         return false;
 
-    set<CBlockFinalityMessage> messageSet ;
-    set<CRegID> miners;
-
-    if(pbftContext.finalityMessageMan.GetMessagesByBlockHash(pIndex->GetBlockHash(), messageSet)
-       && pbftContext.GetMinerListByBlockHash(pIndex->pprev->GetBlockHash(),miners)) {
-        if(messageSet.size() >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-            int count =0;
-            for(auto msg: messageSet){
-                if(miners.count(msg.miner))
-                    count++ ;
-                if(count >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-                    return UpdateGlobalFinBlock(pIndex->height) ;
-                }
-            }
-        }
+    if (HasFinalityQuorum(pbftContext.finalityMessageMan, pIndex))
+        return UpdateGlobalFinBlock(pIndex->height);
 
-    }
     return false;
 }
 
@@ -448,3 +437,107 @@ bool RelayBlockFinalityMessage(const CBlockFinalityMessage& msg){
 }
 
 
+
+bool AcceptBlockConfirmMessage(const CBlockConfirmMessage& msg) {
+    CPBFTMessageMan<CBlockConfirmMessage>& msgMan = pbftContext.confirmMessageMan;
+    if (msgMan.IsKnown(msg))
+        return false;
+
+    msgMan.AddMessageKnown(msg);
+    int messageCount = msgMan.SaveMessageByBlock(msg.blockHash, msg);
+
+    bool updateFinalitySuccess = false;
+    if (messageCount >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+        updateFinalitySuccess = pbftMan.UpdateLocalFinBlock(msg);
+
+    if (CheckPBFTMessageSignaturer(msg))
+        RelayBlockConfirmMessage(msg);
+
+    if (updateFinalitySuccess)
+        BroadcastBlockFinality(pbftMan.GetLocalFinIndex());
+
+    return true;
+}
+
+bool AcceptBlockFinalityMessage(const CBlockFinalityMessage& msg) {
+    CPBFTMessageMan<CBlockFinalityMessage>& msgMan = pbftContext.finalityMessageMan;
+    if (msgMan.IsKnown(msg))
+        return false;
+
+    msgMan.AddMessageKnown(msg);
+    int messageCount = msgMan.SaveMessageByBlock(msg.blockHash, msg);
+    if (messageCount >= FINALITY_BLOCK_CONFIRM_MINER_COUNT)
+        pbftMan.UpdateGlobalFinBlock(msg);
+
+    if (CheckPBFTMessageSignaturer(msg))
+        RelayBlockFinalityMessage(msg);
+
+    return true;
+}
+
+static MsgQueue<CPBFTMessage> pbftVerifyQueue(MAX_PBFT_VERIFY_QUEUE_SIZE);
+static std::atomic<bool> pbftVerifierStarted(false);
+
+bool QueuePBFTMessage(const CPBFTMessage& msg) {
+    if (!pbftVerifierStarted || pbftVerifyQueue.Full())
+        return false;
+
+    pbftVerifyQueue.Push(msg);
+    return true;
+}
+
+static void VerifyPBFTMessage(const CPBFTMessage &msg) {
+    if (msg.msgType == PBFTMsgType::CONFIRM_BLOCK) {
+        CBlockConfirmMessage confirmMsg;
+        static_cast<CPBFTMessage &>(confirmMsg) = msg;
+        if (!CheckPBFTMessage(PBFTMsgType::CONFIRM_BLOCK, confirmMsg)) {
+            LogPrint(BCLog::NET, "confirm message check failed,miner_id=%s, blockhash=%s \n", msg.miner.ToString(),
+                     msg.blockHash.GetHex());
+            return;
+        }
+        AcceptBlockConfirmMessage(confirmMsg);
+    } else {
+        CBlockFinalityMessage finalityMsg;
+        static_cast<CPBFTMessage &>(finalityMsg) = msg;
+        if (!CheckPBFTMessage(PBFTMsgType::FINALITY_BLOCK, finalityMsg)) {
+            LogPrint(BCLog::NET, "finality block message check failed,miner_id=%s, blockhash=%s \n",
+                     msg.miner.ToString(), msg.blockHash.GetHex());
+            return;
+        }
+        AcceptBlockFinalityMessage(finalityMsg);
+    }
+}
+
+static void ThreadPBFTMessageVerifier() {
+    RenameThread("coin-pbftverify");
+
+    vector<CPBFTMessage> batch;
+    CPBFTMessage msg;
+    while (true) {
+        boost::this_thread::interruption_point();
+
+        // wait for a message, then take the rest of the burst
+        if (!pbftVerifyQueue.Pop(&msg))
+            continue;
+
+        batch.clear();
+        batch.push_back(msg);
+        while (batch.size() < PBFT_VERIFY_BATCH_SIZE && pbftVerifyQueue.Pop(&msg, std::chrono::milliseconds(0)))
+            batch.push_back(msg);
+
+        for (const auto &item : batch) {
+            VerifyPBFTMessage(item);
+        }
+    }
+}
+
+void StartPBFTMessageVerifier(boost::thread_group &threadGroup) {
+    int32_t threads = SysCfg().GetArg("-pbftverifythreads", DEFAULT_PBFT_VERIFY_THREADS);
+    if (threads <= 0)
+        return;
+
+    for (int32_t i = 0; i < threads; ++i)
+        threadGroup.create_thread(&ThreadPBFTMessageVerifier);
+
+    pbftVerifierStarted = true;
+}
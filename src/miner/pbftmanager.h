@@ -8,10 +8,25 @@
 #define MINER_PBFTMANAGER_H
 
 #include "chain/chain.h"
+#include "p2p/protocol.h"
 
-class CBlockConfirmMessage ;
-class CBlockFinalityMessage ;
-class CPBFTMessage ;
+#include <deque>
+
+namespace boost {
+class thread_group;
+}
+
+static const int32_t DEFAULT_PBFT_VERIFY_THREADS = 2;
+static const uint32_t PBFT_VERIFY_BATCH_SIZE     = 64;
+static const size_t MAX_PBFT_VERIFY_QUEUE_SIZE   = 10000;
+
+// delay from the block arrival to its finality
+struct CPBFTFinalityStats {
+    uint64_t count   = 0;
+    int64_t total_ms = 0;
+    int64_t max_ms   = 0;
+    int64_t last_ms  = 0;
+};
 
 class CPBFTMan {
 
@@ -21,8 +36,15 @@ private:
     CBlockIndex* globalFinIndex = nullptr ;
     uint256 globalFinHash = uint256();
     CCriticalSection cs_finblock ;
+    CCriticalSection cs_finstats;
+    map<uint256, int64_t> blockArrivalTimes;
+    std::deque<uint256> blockArrivalOrder;
+    CPBFTFinalityStats localFinStats;
+    CPBFTFinalityStats globalFinStats;
+
     bool UpdateLocalFinBlock(const uint32_t height);
     bool UpdateGlobalFinBlock(const uint32_t height);
+    void RecordFinalityDelay(const CBlockIndex *pIndex, CPBFTFinalityStats &stats, const char *finType);
 
 public:
 
@@ -36,6 +58,9 @@ public:
     bool UpdateGlobalFinBlock(const CBlockIndex* pIndex);
     bool UpdateGlobalFinBlock(const CBlockFinalityMessage& msg);
     int64_t  GetLocalFinLastUpdate() const ;
+
+    void SaveBlockArrivalTime(const uint256 &blockHash);
+    void GetFinalityStats(CPBFTFinalityStats &localStats, CPBFTFinalityStats &globalStats);
 };
 
 bool BroadcastBlockConfirm(const CBlockIndex* block) ;
@@ -48,4 +73,15 @@ bool CheckPBFTMessageSignaturer(const CPBFTMessage& msg) ;
 bool RelayBlockConfirmMessage(const CBlockConfirmMessage& msg) ;
 
 bool RelayBlockFinalityMessage(const CBlockFinalityMessage& msg) ;
+
+// save the verified message, update the finality block and relay it
+bool AcceptBlockConfirmMessage(const CBlockConfirmMessage& msg);
+bool AcceptBlockFinalityMessage(const CBlockFinalityMessage& msg);
+
+/**
+ * Queue a received pbft message, whose signature is verified with the other messages of the burst
+ * by the pbft verify threads. Return false if the queue is full.
+ */
+bool QueuePBFTMessage(const CPBFTMessage& msg);
+void StartPBFTMessageVerifier(boost::thread_group &threadGroup);
 #endif //MINER_PBFTMANAGER_H
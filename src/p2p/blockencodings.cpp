@@ -0,0 +1,157 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockencodings.h"
+
+#include "commons/random.h"
+#include "commons/util/util.h"
+#include "crypto/hash.h"
+#include "crypto/siphash.h"
+#include "tx/txmempool.h"
+
+#include <unordered_map>
+
+CCompactBlockStats compactBlockStats;
+
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock &block)
+    : header(block.GetBlockHeader()), nonce(GetRand(std::numeric_limits<uint64_t>::max())) {
+    FillShortIdKeys();
+
+    shortTxIds.reserve(block.vptx.size());
+    for (uint32_t i = 0; i < block.vptx.size(); i++) {
+        const auto &pTx = block.vptx[i];
+        if (pTx->IsBlockRewardTx() || pTx->IsPriceMedianTx())
+            prefilledTxs.emplace_back(i, pTx);
+        else
+            shortTxIds.push_back(GetShortID(pTx->GetHash()));
+    }
+}
+
+void CBlockHeaderAndShortTxIDs::FillShortIdKeys() const {
+    CHashWriter ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << header.GetHash() << nonce;
+    uint256 keyHash = ss.GetHash();
+    shortIdKey0     = keyHash.GetUint64(0);
+    shortIdKey1     = keyHash.GetUint64(1);
+}
+
+uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256 &txid) const {
+    return SipHashUint256(shortIdKey0, shortIdKey1, txid) & 0xFFFFFFFFFFFFL;
+}
+
+ReadStatus CPartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, const CTxMemPool &pool) {
+    uint32_t txCount = cmpctBlock.GetBlockTxCount();
+    if (txCount == 0 || txCount > MAX_COMPACT_BLOCK_TXS)
+        return READ_STATUS_INVALID;
+
+    header          = cmpctBlock.header;
+    startTimeMillis = GetTimeMillis();
+    prefilledCount  = 0;
+    mempoolCount    = 0;
+    txsAvailable.assign(txCount, nullptr);
+
+    // prefilled txs must be in the strict ascending order of their indexes
+    int64_t lastIndex = -1;
+    for (const auto &prefilled : cmpctBlock.prefilledTxs) {
+        if (!prefilled.pTx || (int64_t)prefilled.index <= lastIndex || prefilled.index >= txCount)
+            return READ_STATUS_INVALID;
+
+        txsAvailable[prefilled.index] = prefilled.pTx;
+        lastIndex                     = prefilled.index;
+    }
+    prefilledCount = cmpctBlock.prefilledTxs.size();
+
+    // short txid -> tx index in the block
+    std::unordered_map<uint64_t, uint32_t> shortIdIndexes;
+    shortIdIndexes.reserve(cmpctBlock.shortTxIds.size());
+    uint32_t shortIdPos = 0;
+    for (uint32_t i = 0; i < txCount; i++) {
+        if (txsAvailable[i])
+            continue;
+
+        if (!shortIdIndexes.emplace(cmpctBlock.shortTxIds[shortIdPos++], i).second) {
+            // two txs of the block have the same short txid, can not tell them apart
+            LogPrint(BCLog::NET, "short txid collision in compact block %s\n", header.GetHash().GetHex());
+            return READ_STATUS_FAILED;
+        }
+    }
+
+    // txs whose short txid matches more than one mempool tx have to be requested
+    std::vector<bool> haveCollision(txCount, false);
+    {
+        LOCK(pool.cs);
+        for (const auto &item : pool.memPoolTxs) {
+            auto it = shortIdIndexes.find(cmpctBlock.GetShortID(item.first));
+            if (it == shortIdIndexes.end() || haveCollision[it->second])
+                continue;
+
+            auto &pTx = txsAvailable[it->second];
+            if (!pTx) {
+                pTx = item.second.GetTransaction();
+                mempoolCount++;
+            } else {
+                pTx = nullptr;
+                haveCollision[it->second] = true;
+                mempoolCount--;
+            }
+        }
+    }
+
+    LogPrint(BCLog::NET, "init compact block %s: txs=%u, prefilled=%u, from_mempool=%u\n",
+             header.GetHash().GetHex(), txCount, prefilledCount, mempoolCount);
+
+    return READ_STATUS_OK;
+}
+
+bool CPartiallyDownloadedBlock::IsTxAvailable(uint32_t index) const {
+    assert(!txsAvailable.empty());
+    assert(index < txsAvailable.size());
+    return txsAvailable[index] != nullptr;
+}
+
+void CPartiallyDownloadedBlock::GetMissingTxIndexes(std::vector<uint32_t> &indexes) const {
+    indexes.clear();
+    for (uint32_t i = 0; i < txsAvailable.size(); i++) {
+        if (!txsAvailable[i])
+            indexes.push_back(i);
+    }
+}
+
+ReadStatus CPartiallyDownloadedBlock::FillBlock(CBlock &block,
+                                                const std::vector<std::shared_ptr<CBaseTx> > &missingTxs) const {
+    assert(!txsAvailable.empty());
+
+    block = CBlock(header);
+    block.vptx.resize(txsAvailable.size());
+
+    uint32_t missingPos = 0;
+    for (uint32_t i = 0; i < txsAvailable.size(); i++) {
+        if (txsAvailable[i]) {
+            block.vptx[i] = txsAvailable[i];
+        } else {
+            if (missingPos >= missingTxs.size() || !missingTxs[missingPos])
+                return READ_STATUS_INVALID;
+
+            block.vptx[i] = missingTxs[missingPos++];
+        }
+    }
+    if (missingPos != missingTxs.size())
+        return READ_STATUS_INVALID;
+
+    // a short txid collision with a mempool tx ends up with a wrong merkle root
+    if (block.BuildMerkleTree() != header.GetMerkleRootHash()) {
+        LogPrint(BCLog::NET, "merkle root mismatch of rebuilt compact block %s\n", header.GetHash().GetHex());
+        return READ_STATUS_FAILED;
+    }
+
+    return READ_STATUS_OK;
+}
+
+void CCompactBlockStats::RecordRebuilt(const CPartiallyDownloadedBlock &partialBlock, bool roundTrip) {
+    int64_t now = GetTimeMillis();
+    (roundTrip ? txnRoundTrips : reconstructed)++;
+    txsFromMempool += partialBlock.mempoolCount;
+    rebuildTimeMillis += std::max<int64_t>(0, now - partialBlock.startTimeMillis);
+    propagationMillis += std::max<int64_t>(0, now - partialBlock.header.GetBlockTime() * 1000);
+}
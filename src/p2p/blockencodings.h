@@ -0,0 +1,160 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef P2P_BLOCKENCODINGS_H
+#define P2P_BLOCKENCODINGS_H
+
+#include "persistence/block.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class CTxMemPool;
+
+static const bool DEFAULT_COMPACT_BLOCKS        = true;
+static const uint64_t COMPACT_BLOCKS_VERSION    = 1;
+static const uint32_t SHORT_TXID_SIZE           = 6;        // bytes of a short txid on the wire
+static const uint32_t MAX_COMPACT_BLOCK_TXS     = 0xFFFF;   // max txs of a compact block
+
+// Tx sent along with the compact block, e.g. the block reward tx which never enters the mempool
+struct CPrefilledTx {
+    uint32_t index;  // index of the tx in the block
+    std::shared_ptr<CBaseTx> pTx;
+
+    CPrefilledTx() : index(0) {}
+    CPrefilledTx(uint32_t indexIn, const std::shared_ptr<CBaseTx> &pTxIn) : index(indexIn), pTx(pTxIn) {}
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(VARINT(index));
+        READWRITE(pTx);
+    )
+};
+
+/**
+ * Compact block: the block header plus a salted short txid of each tx the receiver is expected to have in
+ * its mempool, so that the receiver can rebuild the block and only ask for the txs it misses.
+ * short txid = SipHash-2-4(k0, k1, txid) & 0xffffffffffff, with (k0, k1) the first 128 bits of
+ * Hash(block hash, nonce). The nonce is picked by the sender, so a collision crafted against
+ * one peer does not work against the others.
+ */
+class CBlockHeaderAndShortTxIDs {
+public:
+    CBlockHeader header;
+    uint64_t nonce;
+    std::vector<uint64_t> shortTxIds;
+    std::vector<CPrefilledTx> prefilledTxs;
+
+private:
+    mutable uint64_t shortIdKey0;
+    mutable uint64_t shortIdKey1;
+
+public:
+    CBlockHeaderAndShortTxIDs() : nonce(0), shortIdKey0(0), shortIdKey1(0) {}
+    // the block reward and price median txs are always prefilled
+    explicit CBlockHeaderAndShortTxIDs(const CBlock &block);
+
+    uint64_t GetShortID(const uint256 &txid) const;
+    uint32_t GetBlockTxCount() const { return shortTxIds.size() + prefilledTxs.size(); }
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(header);
+        READWRITE(nonce);
+        vector<uint8_t> vBytes;
+        if (fRead) {
+            READWRITE(vBytes);
+            if (vBytes.size() % SHORT_TXID_SIZE != 0)
+                throw ios_base::failure("invalid short txids size");
+            CBlockHeaderAndShortTxIDs &us = *(const_cast<CBlockHeaderAndShortTxIDs *>(this));
+            us.shortTxIds.assign(vBytes.size() / SHORT_TXID_SIZE, 0);
+            for (uint32_t i = 0; i < us.shortTxIds.size(); i++) {
+                for (uint32_t j = 0; j < SHORT_TXID_SIZE; j++)
+                    us.shortTxIds[i] |= (uint64_t)vBytes[i * SHORT_TXID_SIZE + j] << (8 * j);
+            }
+            us.FillShortIdKeys();
+        } else {
+            vBytes.resize(shortTxIds.size() * SHORT_TXID_SIZE);
+            for (uint32_t i = 0; i < shortTxIds.size(); i++) {
+                for (uint32_t j = 0; j < SHORT_TXID_SIZE; j++)
+                    vBytes[i * SHORT_TXID_SIZE + j] = (shortTxIds[i] >> (8 * j)) & 0xFF;
+            }
+            READWRITE(vBytes);
+        }
+        READWRITE(prefilledTxs);
+    )
+
+private:
+    void FillShortIdKeys() const;
+};
+
+// getblocktxn: the indexes of the txs missed when rebuilding a compact block
+class CBlockTransactionsRequest {
+public:
+    uint256 blockHash;
+    std::vector<uint32_t> indexes;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(indexes);
+    )
+};
+
+// blocktxn: the txs asked by a getblocktxn, in the order of the requested indexes
+class CBlockTransactions {
+public:
+    uint256 blockHash;
+    std::vector<std::shared_ptr<CBaseTx> > txs;
+
+    CBlockTransactions() {}
+    explicit CBlockTransactions(const CBlockTransactionsRequest &req) : blockHash(req.blockHash), txs(req.indexes.size()) {}
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(blockHash);
+        READWRITE(txs);
+    )
+};
+
+enum ReadStatus {
+    READ_STATUS_OK,
+    READ_STATUS_INVALID,  // the peer sent a malformed compact block or tx list
+    READ_STATUS_FAILED,   // failed to rebuild the block, e.g. short txid collision, fall back to the full block
+};
+
+// The block being rebuilt from a compact block and the local mempool
+class CPartiallyDownloadedBlock {
+public:
+    CBlockHeader header;
+    int64_t startTimeMillis = 0;  // local time when the compact block was received
+    uint32_t prefilledCount = 0;
+    uint32_t mempoolCount   = 0;
+
+    ReadStatus InitData(const CBlockHeaderAndShortTxIDs &cmpctBlock, const CTxMemPool &pool);
+    bool IsTxAvailable(uint32_t index) const;
+    void GetMissingTxIndexes(std::vector<uint32_t> &indexes) const;
+    ReadStatus FillBlock(CBlock &block, const std::vector<std::shared_ptr<CBaseTx> > &missingTxs) const;
+
+private:
+    std::vector<std::shared_ptr<CBaseTx> > txsAvailable;
+};
+
+// Counters of compact block relay, exposed by getnetworkinfo
+struct CCompactBlockStats {
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> reconstructed{0};      // rebuilt from the mempool without any round trip
+    std::atomic<uint64_t> txnRoundTrips{0};      // rebuilt after a getblocktxn round trip
+    std::atomic<uint64_t> fallbacks{0};          // fell back to downloading the full block
+    std::atomic<uint64_t> txsFromMempool{0};
+    std::atomic<uint64_t> txsRequested{0};
+    std::atomic<uint64_t> bytesSent{0};          // bytes of the compact blocks sent
+    std::atomic<uint64_t> fullBytesSent{0};      // bytes of the full blocks they stand for
+    std::atomic<uint64_t> rebuildTimeMillis{0};  // compact block received -> block rebuilt
+    std::atomic<uint64_t> propagationMillis{0};  // block time -> block rebuilt
+
+    void RecordRebuilt(const CPartiallyDownloadedBlock &partialBlock, bool roundTrip);
+};
+
+extern CCompactBlockStats compactBlockStats;
+
+#endif  // P2P_BLOCKENCODINGS_H
@@ -13,6 +13,7 @@
 #include "net.h"
 #include "miner/pbftcontext.h"
 #include "miner/pbftmanager.h"
+#include "p2p/blockencodings.h"
 
 #include <string>
 #include <tuple>
@@ -24,6 +25,7 @@ static const int64_t MINER_NODE_BLOCKS_TO_DOWNLOAD_TIMEOUT   = 2;   // 2 seconds
 static const int64_t MINER_NODE_BLOCKS_IN_FLIGHT_TIMEOUT     = 1;   // 1 seconds
 static const int64_t WITNESS_NODE_BLOCKS_TO_DOWNLOAD_TIMEOUT = 20;  // 20 seconds
 static const int64_t WITNESS_NODE_BLOCKS_IN_FLIGHT_TIMEOUT   = 10;  // 10 seconds
+static const int64_t PARTIAL_BLOCK_TIMEOUT                   = 10;  // 10 seconds, waiting for blocktxn
 
 class CNode;
 class CDataStream;
@@ -45,6 +47,9 @@ map<uint256, tuple<NodeId, list<uint256>::iterator, int64_t>> mapBlocksToDownloa
 // them, if processing happens afterwards. Protected by cs_main.
 map<uint256, NodeId> mapBlockSource;  // Remember who we got this block from.
 
+// Compact blocks waiting for the missing txs asked by getblocktxn. Protected by cs_main.
+map<uint256, tuple<NodeId, std::shared_ptr<CPartiallyDownloadedBlock>>> mapPartialBlocks;
+
 
 // Requires cs_mapNodeState.
 void MarkBlockAsReceived(const uint256 &hash, NodeId nodeFrom = -1) {
@@ -102,9 +107,13 @@ inline void ProcessGetData(CNode *pFrom) {
 
             if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK) {
                 bool send                                = false;
-                map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(inv.hash);
-                if (mi != mapBlockIndex.end()) {
+                BlockMap::iterator mi = mapBlockIndex.find(inv.hash);
+                if (mi != mapBlockIndex.end() && ((*mi).second->nStatus & BLOCK_HAVE_DATA)) {
                     send = true;
+                } else if (mi != mapBlockIndex.end()) {
+                    // a pruned block, or a block before the state snapshot this node was bootstrapped from
+                    LogPrint(BCLog::NET, "block %s has no data on disk\n", inv.hash.GetHex());
+                    vNotFound.push_back(inv);
                 } else {
                     LogPrint(BCLog::NET, "block %s not exist\n", inv.hash.GetHex());
                 }
@@ -131,7 +140,7 @@ inline void ProcessGetData(CNode *pFrom) {
                             // protocol spec specified allows for us to provide duplicate txn here, however we MUST
                             // always provide at least what the remote peer needs
                             for (auto &pair : merkleBlock.vMatchedTxn)
-                                if (!pFrom->setInventoryKnown.count(CInv(MSG_TX, pair.second)))
+                                if (!pFrom->filterInventoryKnown.contains(pair.second, MSG_TX))
                                     pFrom->PushMessage(NetMsgType::TX, block.vptx[pair.first]);
                         }
                         // else
@@ -442,7 +451,7 @@ inline bool ProcessAddrMessage(CNode *pFrom, CDataStream &vRecv) {
             {
                 LOCK(cs_vNodes);
                 // Use deterministic randomness to send to the same nodes for 24 hours
-                // at a time so the setAddrKnowns of the chosen nodes prevent repeats
+                // at a time so the addrKnowns of the chosen nodes prevent repeats
                 static uint256 hashSalt;
                 if (hashSalt.IsNull()) hashSalt = GetRandHash();
                 uint64_t hashAddr = addr.GetHash();
@@ -538,7 +547,7 @@ inline bool ProcessGetHeadersMessage(CNode *pFrom, CDataStream &vRecv) {
     CBlockIndex *pIndex = nullptr;
     if (locator.IsNull()) {
         // If locator is null, return the hashStop block
-        map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(hashStop);
+        BlockMap::iterator mi = mapBlockIndex.find(hashStop);
         if (mi == mapBlockIndex.end())
             return true;
 
@@ -704,14 +713,7 @@ inline bool ProcessGetDataMessage(CNode *pFrom, CDataStream &vRecv) {
     return true;
 }
 
-inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
-    CBlock block;
-    vRecv >> block;
-
-    LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
-        block.GetHash().ToString(), pFrom->addr.ToString());
-    // block.Print();
-
+inline void AcceptReceivedBlock(CNode *pFrom, CBlock &block) {
     CInv inv(MSG_BLOCK, block.GetHash());
     pFrom->AddInventoryKnown(inv);
 
@@ -736,6 +738,178 @@ inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
 
 }
 
+inline void ProcessBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlock block;
+    vRecv >> block;
+
+    LogPrint(BCLog::NET, "recv block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
+        block.GetHash().ToString(), pFrom->addr.ToString());
+    // block.Print();
+
+    AcceptReceivedBlock(pFrom, block);
+}
+
+inline void ProcessSendCmpctMessage(CNode *pFrom, CDataStream &vRecv) {
+    bool fAnnounce   = false;
+    uint64_t version = 0;
+    vRecv >> fAnnounce >> version;
+
+    if (version == COMPACT_BLOCKS_VERSION && SysCfg().GetBoolArg("-compactblocks", DEFAULT_COMPACT_BLOCKS))
+        pFrom->fPreferCompactBlocks = fAnnounce;
+}
+
+// Requires cs_main. Fall back to downloading the full block when a compact block can not be rebuilt.
+inline void RequestFullBlock(CNode *pFrom, const uint256 &blockHash) {
+    compactBlockStats.fallbacks++;
+    mapPartialBlocks.erase(blockHash);
+
+    LogPrint(BCLog::NET, "request full block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
+        blockHash.ToString(), pFrom->addr.ToString());
+    pFrom->PushMessage(NetMsgType::GETDATA, vector<CInv>(1, CInv(MSG_BLOCK, blockHash)));
+}
+
+// Requires cs_main.
+inline void EraseExpiredPartialBlocks() {
+    int64_t now = GetTimeMillis();
+    for (auto it = mapPartialBlocks.begin(); it != mapPartialBlocks.end();) {
+        if (now - std::get<1>(it->second)->startTimeMillis > PARTIAL_BLOCK_TIMEOUT * 1000)
+            it = mapPartialBlocks.erase(it);
+        else
+            ++it;
+    }
+}
+
+inline void ProcessCmpctBlockMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockHeaderAndShortTxIDs cmpctBlock;
+    vRecv >> cmpctBlock;
+    compactBlockStats.received++;
+
+    uint256 blockHash = cmpctBlock.header.GetHash();
+    LogPrint(BCLog::NET, "recv compact block! time_ms=%lld, hash=%s, txs=%u, peer=%s\n", GetTimeMillis(),
+        blockHash.ToString(), cmpctBlock.GetBlockTxCount(), pFrom->addr.ToString());
+
+    CInv inv(MSG_BLOCK, blockHash);
+    pFrom->AddInventoryKnown(inv);
+
+    CBlock block;
+    {
+        LOCK(cs_main);
+        if (AlreadyHave(inv) || mapPartialBlocks.count(blockHash))
+            return;
+
+        // the block can not be connected yet, let the full block go through the orphan block handling
+        if (!mapBlockIndex.count(cmpctBlock.header.GetPrevBlockHash())) {
+            RequestFullBlock(pFrom, blockHash);
+            return;
+        }
+
+        auto pPartialBlock = std::make_shared<CPartiallyDownloadedBlock>();
+        ReadStatus status  = pPartialBlock->InitData(cmpctBlock, mempool);
+        if (status == READ_STATUS_INVALID) {
+            LogPrint(BCLog::INFO, "Misbehaving: invalid compact block %s from peer %s, nMisbehavior add 100\n",
+                     blockHash.ToString(), pFrom->addr.ToString());
+            Misbehaving(pFrom->GetId(), 100);
+            return;
+        } else if (status == READ_STATUS_FAILED) {
+            RequestFullBlock(pFrom, blockHash);
+            return;
+        }
+
+        CBlockTransactionsRequest req;
+        req.blockHash = blockHash;
+        pPartialBlock->GetMissingTxIndexes(req.indexes);
+        if (!req.indexes.empty()) {
+            EraseExpiredPartialBlocks();
+            mapPartialBlocks[blockHash] = std::make_tuple(pFrom->GetId(), pPartialBlock);
+            compactBlockStats.txsRequested += req.indexes.size();
+
+            LogPrint(BCLog::NET, "request missing txs of compact block! hash=%s, count=%u, peer=%s\n",
+                blockHash.ToString(), req.indexes.size(), pFrom->addr.ToString());
+            pFrom->PushMessage(NetMsgType::GETBLOCKTXN, req);
+            return;
+        }
+
+        if (pPartialBlock->FillBlock(block, {}) != READ_STATUS_OK) {
+            RequestFullBlock(pFrom, blockHash);
+            return;
+        }
+        compactBlockStats.RecordRebuilt(*pPartialBlock, false);
+    }
+
+    LogPrint(BCLog::NET, "rebuilt compact block from mempool! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
+        blockHash.ToString(), pFrom->addr.ToString());
+
+    AcceptReceivedBlock(pFrom, block);
+}
+
+inline void ProcessGetBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTransactionsRequest req;
+    vRecv >> req;
+
+    LOCK(cs_main);
+    auto it = mapBlockIndex.find(req.blockHash);
+    if (it == mapBlockIndex.end()) {
+        LogPrint(BCLog::NET, "getblocktxn of unknown block %s from peer %s\n", req.blockHash.ToString(),
+                 pFrom->addr.ToString());
+        return;
+    }
+
+    CBlock block;
+    if (!ReadBlockFromDisk(it->second, block)) {
+        LogPrint(BCLog::ERROR, "read block %s from disk failed\n", req.blockHash.ToString());
+        return;
+    }
+
+    CBlockTransactions resp(req);
+    for (uint32_t i = 0; i < req.indexes.size(); i++) {
+        if (req.indexes[i] >= block.vptx.size()) {
+            LogPrint(BCLog::INFO, "Misbehaving: getblocktxn with out of range index from peer %s, nMisbehavior add 100\n",
+                     pFrom->addr.ToString());
+            Misbehaving(pFrom->GetId(), 100);
+            return;
+        }
+        resp.txs[i] = block.vptx[req.indexes[i]];
+    }
+
+    pFrom->PushMessage(NetMsgType::BLOCKTXN, resp);
+}
+
+inline void ProcessBlockTxnMessage(CNode *pFrom, CDataStream &vRecv) {
+    CBlockTransactions resp;
+    vRecv >> resp;
+
+    CBlock block;
+    {
+        LOCK(cs_main);
+        auto it = mapPartialBlocks.find(resp.blockHash);
+        if (it == mapPartialBlocks.end() || std::get<0>(it->second) != pFrom->GetId()) {
+            LogPrint(BCLog::NET, "unexpected blocktxn of block %s from peer %s\n", resp.blockHash.ToString(),
+                     pFrom->addr.ToString());
+            return;
+        }
+
+        auto pPartialBlock = std::get<1>(it->second);
+        mapPartialBlocks.erase(it);
+
+        ReadStatus status = pPartialBlock->FillBlock(block, resp.txs);
+        if (status == READ_STATUS_INVALID) {
+            LogPrint(BCLog::INFO, "Misbehaving: invalid blocktxn of block %s from peer %s, nMisbehavior add 100\n",
+                     resp.blockHash.ToString(), pFrom->addr.ToString());
+            Misbehaving(pFrom->GetId(), 100);
+            return;
+        } else if (status == READ_STATUS_FAILED) {
+            RequestFullBlock(pFrom, resp.blockHash);
+            return;
+        }
+        compactBlockStats.RecordRebuilt(*pPartialBlock, true);
+    }
+
+    LogPrint(BCLog::NET, "rebuilt compact block! time_ms=%lld, hash=%s, peer=%s\n", GetTimeMillis(),
+        resp.blockHash.ToString(), pFrom->addr.ToString());
+
+    AcceptReceivedBlock(pFrom, block);
+}
+
 inline void ProcessMempoolMessage(CNode *pFrom, CDataStream &vRecv) {
     LOCK2(cs_main, pFrom->cs_filter);
 
@@ -844,25 +1018,16 @@ bool ProcessBlockConfirmMessage(CNode *pFrom, CDataStream &vRecv) {
         return false ;
     }
 
+    // the signature is verified by the pbft verify threads with the rest of the burst
+    if (QueuePBFTMessage(message))
+        return true;
+
     if(!CheckPBFTMessage(PBFTMsgType::CONFIRM_BLOCK,message)){
         LogPrint(BCLog::NET, "confirm message check failed,miner_id=%s, blockhash=%s \n",message.miner.ToString(), message.blockHash.GetHex());
         return false ;
     }
 
-    msgMan.AddMessageKnown(message);
-    int messageCount = msgMan.SaveMessageByBlock(message.blockHash, message);
-
-    bool updateFinalitySuccess = false ;
-    if(messageCount >= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-       updateFinalitySuccess = pbftMan.UpdateLocalFinBlock(message) ;
-    }
-
-    if(CheckPBFTMessageSignaturer(message))
-        RelayBlockConfirmMessage(message) ;
-
-    if(updateFinalitySuccess){
-        BroadcastBlockFinality(pbftMan.GetLocalFinIndex());
-    }
+    AcceptBlockConfirmMessage(message);
 
     return true ;
 }
@@ -888,18 +1053,15 @@ bool ProcessBlockFinalityMessage(CNode *pFrom, CDataStream &vRecv) {
         return false ;
     }
 
+    if (QueuePBFTMessage(message))
+        return true;
+
     if(!CheckPBFTMessage(PBFTMsgType::FINALITY_BLOCK,message)){
         LogPrint(BCLog::NET, "finality block message check failed,miner_id=%s, blockhash=%s \n",message.miner.ToString(), message.blockHash.GetHex());
         return false ;
     }
 
-    msgMan.AddMessageKnown(message);
-    int messageCount = msgMan.SaveMessageByBlock(message.blockHash, message);
-    if(messageCount>= FINALITY_BLOCK_CONFIRM_MINER_COUNT){
-        pbftMan.UpdateGlobalFinBlock(message) ;
-    }
-    if(CheckPBFTMessageSignaturer(message))
-        RelayBlockFinalityMessage(message) ;
+    AcceptBlockFinalityMessage(message);
 
     return true ;
 }
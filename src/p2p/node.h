@@ -14,7 +14,6 @@
 #include "p2p/protocol.h"
 #include "commons/limitedmap.h"
 #include "commons/bloom.h"
-#include "commons/mruset.h"
 #include "commons/random.h"
 #include "p2p/netmessage.h"
 
@@ -38,6 +37,10 @@ static const uint32_t MAX_INV_SZ = 50000;
 static const size_t MAPASKFOR_MAX_SZ = MAX_INV_SZ;
 /** The maximum number of new addresses to accumulate before announcing. */
 static const uint32_t MAX_ADDR_TO_SEND = 1000;
+/** The number of the most recent addresses and inventory items remembered as known by a peer */
+static const uint32_t ADDR_KNOWN_FILTER_SIZE        = 5000;
+static const uint32_t INVENTORY_KNOWN_FILTER_SIZE   = 10000;
+static const uint32_t PBFT_MSG_KNOWN_FILTER_SIZE    = 1000;
 
 extern limitedmap<CInv, int64_t> mapAlreadyAskedFor;
 
@@ -172,6 +175,8 @@ public:
     // b) the peer may tell us in their version message that we should not relay tx invs
     //    until they have initialized their bloom filter.
     bool fRelayTxes;
+    // the peer asked by sendcmpct to be announced new blocks by cmpctblock instead of block/inv
+    bool fPreferCompactBlocks;
     CSemaphoreGrant grantOutbound;
     CCriticalSection cs_filter;
     CBloomFilter* pFilter;
@@ -196,12 +201,12 @@ public:
 
     // flood relay
     vector<CAddress> vAddrToSend;
-    mruset<CAddress> setAddrKnown;
+    CRollingBloomFilter addrKnown;
     bool fGetAddr;
     set<uint256> setKnown;  // alertHash
 
     // inventory based relay
-    mruset<CInv> setInventoryKnown;  //存放已收到的inv
+    CRollingBloomFilter filterInventoryKnown;  //存放已收到的inv
     vector<CInv> vInventoryToSend;   //待发送的inv
     std::set<CInv> setForceToSend;   //强制发送的inv
 
@@ -209,10 +214,10 @@ public:
     multimap<int64_t, CInv> mapAskFor;  //向网络请求交易的时间, a priority queue
 
 
-    mruset<CBlockConfirmMessage> setBlockConfirmMsgKnown ;
+    CRollingBloomFilter filterBlockConfirmMsgKnown;
     CCriticalSection cs_blockConfirm ;
 
-    mruset<CBlockFinalityMessage> setBlockFinalityMsgKnown ;
+    CRollingBloomFilter filterBlockFinalityMsgKnown;
     CCriticalSection cs_blockFinality ;
 
     // Ping time measurement
@@ -222,7 +227,11 @@ public:
     bool fPingQueued;
 
     CNode(SOCKET hSocketIn, CAddress addrIn, string addrNameIn = "", bool fInboundIn = false)
-            : ssSend(SER_NETWORK, INIT_PROTO_VERSION), setAddrKnown(5000) {
+            : ssSend(SER_NETWORK, INIT_PROTO_VERSION),
+              addrKnown(ADDR_KNOWN_FILTER_SIZE, 0.001),
+              filterInventoryKnown(INVENTORY_KNOWN_FILTER_SIZE, 0.000001),
+              filterBlockConfirmMsgKnown(PBFT_MSG_KNOWN_FILTER_SIZE, 0.000001),
+              filterBlockFinalityMsgKnown(PBFT_MSG_KNOWN_FILTER_SIZE, 0.000001) {
         nServices                = 0;
         hSocket                  = hSocketIn;
         nRecvVersion             = INIT_PROTO_VERSION;
@@ -252,8 +261,7 @@ public:
         fStartSync               = false;
         fGetAddr                 = false;
         fRelayTxes               = false;
-        setInventoryKnown.max_size(SendBufferSize() / 1000);
-        setBlockConfirmMsgKnown.max_size(200);
+        fPreferCompactBlocks     = false;
         pFilter        = new CBloomFilter();
         nPingNonceSent = 0;
         nPingUsecStart = 0;
@@ -326,16 +334,22 @@ public:
 
     void Release() { nRefCount--; }
 
-    void AddAddressKnown(const CAddress& addr) { setAddrKnown.insert(addr); }
+    void AddAddressKnown(const CAddress& addr) { addrKnown.insert(addr.GetKey()); }
 
-    void AddBlockConfirmMessageKnown(const CBlockConfirmMessage msg){ setBlockConfirmMsgKnown.insert(msg); }
-    void AddBlockFinalityMessageKnown(const CBlockFinalityMessage msg){ setBlockFinalityMsgKnown.insert(msg); }
+    void AddBlockConfirmMessageKnown(const CBlockConfirmMessage& msg) {
+        LOCK(cs_blockConfirm);
+        filterBlockConfirmMsgKnown.insert(msg.GetHash());
+    }
+    void AddBlockFinalityMessageKnown(const CBlockFinalityMessage& msg) {
+        LOCK(cs_blockFinality);
+        filterBlockFinalityMsgKnown.insert(msg.GetHash());
+    }
 
     void PushAddress(const CAddress& addr) {
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
-        if (addr.IsValid() && !setAddrKnown.count(addr)) {
+        if (addr.IsValid() && !addrKnown.contains(addr.GetKey())) {
             if (vAddrToSend.size() >= MAX_ADDR_TO_SEND) {
                 vAddrToSend[insecure_rand() % vAddrToSend.size()] = addr;
             } else {
@@ -347,7 +361,7 @@ public:
     void AddInventoryKnown(const CInv& inv) {
         {
             LOCK(cs_inventory);
-            setInventoryKnown.insert(inv);
+            filterInventoryKnown.insert(inv.hash, inv.type);
         }
     }
 
@@ -359,7 +373,7 @@ public:
                 setForceToSend.insert(inv);
             }
 
-            if (forced || !setInventoryKnown.count(inv))
+            if (forced || !filterInventoryKnown.contains(inv.hash, inv.type))
                 vInventoryToSend.push_back(inv);
 
         }
@@ -367,17 +381,19 @@ public:
 
     void PushBlockConfirmMessage(const CBlockConfirmMessage& msg) {
         LOCK(cs_blockConfirm);
-        if(!setBlockConfirmMsgKnown.count(msg)){
+        uint256 msgHash = msg.GetHash();
+        if(!filterBlockConfirmMsgKnown.contains(msgHash)){
             PushMessage(NetMsgType::CONFIRMBLOCK, msg);
-            setBlockConfirmMsgKnown.insert(msg);
+            filterBlockConfirmMsgKnown.insert(msgHash);
         }
     }
 
     void PushBlockFinalityMessage(const CBlockFinalityMessage& msg) {
         LOCK(cs_blockFinality);
-        if(!setBlockFinalityMsgKnown.count(msg)){
+        uint256 msgHash = msg.GetHash();
+        if(!filterBlockFinalityMsgKnown.contains(msgHash)){
             PushMessage(NetMsgType::FINALITYBLOCK, msg) ;
-            setBlockFinalityMsgKnown.insert(msg);
+            filterBlockFinalityMsgKnown.insert(msgHash);
         }
     }
 
@@ -35,6 +35,10 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
 
     else if (strCommand == NetMsgType::VERACK) {
         pFrom->SetRecvVersion(min(pFrom->nVersion, PROTOCOL_VERSION));
+
+        // Ask to be announced new blocks by compact blocks, peers unaware of it just ignore the message
+        if (SysCfg().GetBoolArg("-compactblocks", DEFAULT_COMPACT_BLOCKS))
+            pFrom->PushMessage(NetMsgType::SENDCMPCT, true, COMPACT_BLOCKS_VERSION);
     }
 
     else if (strCommand == NetMsgType::ADDR) {
@@ -72,6 +76,26 @@ bool static ProcessMessage(CNode *pFrom, string strCommand, CDataStream &vRecv)
         ProcessBlockMessage(pFrom, vRecv);
     }
 
+    else if (strCommand == NetMsgType::SENDCMPCT) {
+        ProcessSendCmpctMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::CMPCTBLOCK &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())  // Ignore blocks received while importing
+    {
+        ProcessCmpctBlockMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::GETBLOCKTXN) {
+        ProcessGetBlockTxnMessage(pFrom, vRecv);
+    }
+
+    else if (strCommand == NetMsgType::BLOCKTXN &&
+            !SysCfg().IsImporting() && !SysCfg().IsReindex())
+    {
+        ProcessBlockTxnMessage(pFrom, vRecv);
+    }
+
     else if (strCommand == NetMsgType::GETADDR) {
         pFrom->vAddrToSend.clear();
         vector<CAddress> vAddr = addrman.GetAddr();
@@ -227,7 +251,9 @@ bool ProcessMessages(CNode *pFrom) {
         // Process message
         bool fRet = false;
         try {
+            CPerfTimer timer(perfStats.GetNetMessage(strCommand));
             fRet = ProcessMessage(pFrom, strCommand, vRecv);
+            timer.Stop();
             boost::this_thread::interruption_point();
         } catch (std::ios_base::failure &e) {
             pFrom->PushMessage(NetMsgType::REJECT, strCommand, REJECT_MALFORMED, string("error parsing message"));
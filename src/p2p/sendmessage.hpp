@@ -79,9 +79,9 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
                 {
                     LOCK(cs_vNodes);
                     for (auto pNode : vNodes) {
-                        // Periodically clear setAddrKnown to allow refresh broadcasts
+                        // Periodically clear addrKnown to allow refresh broadcasts
                         if (nLastRebroadcast)
-                            pNode->setAddrKnown.clear();
+                            pNode->addrKnown.reset();
 
                         // Rebroadcast our address
                         if (!fNoListen) {
@@ -101,8 +101,8 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
                 vector<CAddress> vAddr;
                 vAddr.reserve(pTo->vAddrToSend.size());
                 for (const auto &addr : pTo->vAddrToSend) {
-                    // returns true if wasn't already contained in the set
-                    if (pTo->setAddrKnown.insert(addr).second) {
+                    if (!pTo->addrKnown.contains(addr.GetKey())) {
+                        pTo->addrKnown.insert(addr.GetKey());
                         vAddr.push_back(addr);
                         // receiver rejects addr messages larger than 1000
                         if (vAddr.size() >= 1000) {
@@ -162,13 +162,13 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
             for (const auto &inv : pTo->vInventoryToSend) {
 
                 if(pTo->setForceToSend.count(inv)){
-                    pTo->setInventoryKnown.insert(inv);
+                    pTo->filterInventoryKnown.insert(inv.hash, inv.type);
                     vInv.push_back(inv);
                     pTo->setForceToSend.erase(inv);
                     continue;
                 }
 
-                if (pTo->setInventoryKnown.count(inv))
+                if (pTo->filterInventoryKnown.contains(inv.hash, inv.type))
                     continue;
 
                 // trickle out tx inv to protect privacy
@@ -187,13 +187,11 @@ bool SendMessages(CNode *pTo, bool fSendTrickle) {
                     }
                 }
 
-                // returns true if wasn't already contained in the set
-                if (pTo->setInventoryKnown.insert(inv).second) {
-                    vInv.push_back(inv);
-                    if (vInv.size() >= 1000) {
-                        pTo->PushMessage(NetMsgType::INV, vInv);
-                        vInv.clear();
-                    }
+                pTo->filterInventoryKnown.insert(inv.hash, inv.type);
+                vInv.push_back(inv);
+                if (vInv.size() >= 1000) {
+                    pTo->PushMessage(NetMsgType::INV, vInv);
+                    vInv.clear();
                 }
             }
             pTo->vInventoryToSend = vInvWait;
@@ -0,0 +1,112 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "addrtxdb.h"
+#include "dbiterator.h"
+#include "config/chainparams.h"
+#include "main.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// namespace ADDR_TX_DB
+
+shared_ptr<string> ADDR_TX_DB::ParseLastPos(const string &lastPosInfo, const CKeyID &keyId,
+                                            AddrTxCache::KeyType &lastKey) {
+    uint256 lastBlockHash;
+    uint32_t lastHeight = 0;
+    uint32_t lastIndex  = 0;
+    try {
+        CDataStream ds(lastPosInfo, SER_DISK, CLIENT_VERSION);
+        ds >> lastBlockHash >> VARINT(lastHeight) >> VARINT(lastIndex);
+    } catch (std::exception &e) {
+        return make_shared<string>(strprintf("Parse last_pos_info error! %s", e.what()));
+    }
+
+    CBlockIndex *pBlockIndex = chainActive[lastHeight];
+    if (pBlockIndex == nullptr)
+        return make_shared<string>(strprintf("The last_pos_info is not contained in active chains,"
+            " last_height=%d, tip_height=%d", lastHeight, chainActive.Height()));
+    if (pBlockIndex->GetBlockHash() != lastBlockHash)
+        return make_shared<string>(strprintf("The block of height in last_pos_info does not match with the active block,"
+            " height=%d, last_block_hash=%s, cur_height_block_hash=%s",
+            lastHeight, lastBlockHash.ToString(), pBlockIndex->GetBlockHash().ToString()));
+
+    lastKey = make_tuple(keyId, CFixedUInt32(lastHeight), CFixedUInt32(lastIndex));
+    return nullptr;
+}
+
+shared_ptr<string> ADDR_TX_DB::MakeLastPos(const AddrTxCache::KeyType &lastKey, string &lastPosInfo) {
+    uint32_t lastHeight = GetHeight(lastKey);
+    uint32_t lastIndex  = GetTxIndex(lastKey);
+    CBlockIndex *pBlockIndex = chainActive[lastHeight];
+    if (pBlockIndex == nullptr)
+        return make_shared<string>(strprintf("The block of lastKey is not contained in active chains,"
+            " last_height=%d, tip_height=%d", lastHeight, chainActive.Height()));
+
+    CDataStream ds(SER_DISK, CLIENT_VERSION);
+    ds << pBlockIndex->GetBlockHash() << VARINT(lastHeight) << VARINT(lastIndex);
+    lastPosInfo = ds.str();
+    return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class CAddrTxDBCache
+
+bool CAddrTxDBCache::SetAddrTx(const CKeyID &keyId, uint32_t height, uint32_t index, const TxID &txid) {
+    if (!SysCfg().IsAddrIndex())
+        return true;
+
+    return addrTxCache.SetData(make_tuple(keyId, CFixedUInt32(height), CFixedUInt32(index)), txid);
+}
+
+bool CAddrTxDBCache::GetAddrTxs(const CKeyID &keyId, uint32_t beginHeight, uint32_t endHeight, uint32_t maxCount,
+                                const AddrTxCache::KeyType &lastKey, ADDR_TX_DB::AddrTxList &txs, bool &hasMore) {
+    txs.clear();
+    hasMore = false;
+    if (beginHeight > endHeight)
+        return false;
+
+    // the genesis block is never indexed, so seeking upper of the last tx of the previous height is enough
+    AddrTxCache::KeyType startKey = lastKey;
+    if (db_util::IsEmpty(startKey)) {
+        if (beginHeight == 0)
+            beginHeight = 1;
+        startKey = make_tuple(keyId, CFixedUInt32(beginHeight - 1), CFixedUInt32(UINT32_MAX));
+    }
+
+    CDBPrefixIterator<AddrTxCache, CKeyID> it(addrTxCache, keyId);
+    for (it.SeekUpper(&startKey); it.IsValid(); it.Next()) {
+        if (ADDR_TX_DB::GetHeight(it.GetKey()) > endHeight)
+            break;
+
+        if (maxCount > 0 && txs.size() >= maxCount) {
+            hasMore = true;
+            break;
+        }
+        txs.emplace_back(it.GetKey(), it.GetValue());
+    }
+    return true;
+}
+
+bool CAddrTxDBCache::GetBackfillRange(uint32_t &nextHeight, uint32_t &endHeight) {
+    pair<CVarIntValue<uint32_t>, CVarIntValue<uint32_t>> value;
+    if (!backfillCache.GetData(value))
+        return false;
+
+    nextHeight = value.first.get();
+    endHeight  = value.second.get();
+    return true;
+}
+
+bool CAddrTxDBCache::SetBackfillRange(uint32_t nextHeight, uint32_t endHeight) {
+    return backfillCache.SetData(make_pair(CVarIntValue<uint32_t>(nextHeight), CVarIntValue<uint32_t>(endHeight)));
+}
+
+bool CAddrTxDBCache::EraseBackfillRange() {
+    return backfillCache.EraseData();
+}
+
+void CAddrTxDBCache::Flush() {
+    addrTxCache.Flush();
+    backfillCache.Flush();
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PERSIST_ADDRTXDB_H
+#define PERSIST_ADDRTXDB_H
+
+#include "commons/serialize.h"
+#include "commons/leb128.h"
+#include "entities/id.h"
+#include "dbaccess.h"
+#include "dbconf.h"
+
+#include <vector>
+
+using namespace std;
+
+/*       type               prefixType               key                                              value        */
+/*  ----------------   -------------------------   ------------------------------------------------  ----------    */
+    // keyid, block height, tx index in block -> txid
+typedef CCompositeKVCache<dbk::ADDR_TX_INDEX,  tuple<CKeyID, CFixedUInt32, CFixedUInt32>,  uint256>   AddrTxCache;
+
+// ADDR_TX_DB
+namespace ADDR_TX_DB {
+    typedef pair<AddrTxCache::KeyType, AddrTxCache::ValueType> AddrTxItem;
+    typedef vector<AddrTxItem> AddrTxList;
+
+    inline const CKeyID& GetKeyId(const AddrTxCache::KeyType &key) {
+        return std::get<0>(key);
+    }
+
+    inline uint32_t GetHeight(const AddrTxCache::KeyType &key) {
+        return std::get<1>(key).value;
+    }
+
+    inline uint32_t GetTxIndex(const AddrTxCache::KeyType &key) {
+        return std::get<2>(key).value;
+    }
+
+    // return err str if err happens
+    shared_ptr<string> ParseLastPos(const string &lastPosInfo, const CKeyID &keyId, AddrTxCache::KeyType &lastKey);
+
+    shared_ptr<string> MakeLastPos(const AddrTxCache::KeyType &lastKey, string &lastPosInfo);
+};
+
+class CAddrTxDBCache {
+public:
+    CAddrTxDBCache() {}
+    CAddrTxDBCache(CDBAccess *pDbAccess) : addrTxCache(pDbAccess), backfillCache(pDbAccess) {}
+
+public:
+    bool SetAddrTx(const CKeyID &keyId, uint32_t height, uint32_t index, const TxID &txid);
+
+    /**
+     * Get the txs of keyId in height range [beginHeight, endHeight] in the order of (height, index),
+     * continue from lastKey if it is not empty.
+     */
+    bool GetAddrTxs(const CKeyID &keyId, uint32_t beginHeight, uint32_t endHeight, uint32_t maxCount,
+                    const AddrTxCache::KeyType &lastKey, ADDR_TX_DB::AddrTxList &txs, bool &hasMore);
+
+    // backfill range [nextHeight, endHeight) of the blocks connected before the index was enabled
+    bool GetBackfillRange(uint32_t &nextHeight, uint32_t &endHeight);
+    bool SetBackfillRange(uint32_t nextHeight, uint32_t endHeight);
+    bool EraseBackfillRange();
+
+    void Flush();
+
+    uint32_t GetCacheSize() const { return addrTxCache.GetCacheSize(); }
+
+    void SetBaseViewPtr(CAddrTxDBCache *pBaseIn) {
+        addrTxCache.SetBase(&pBaseIn->addrTxCache);
+        backfillCache.SetBase(&pBaseIn->backfillCache);
+    }
+
+    void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
+        addrTxCache.SetDbOpLogMap(pDbOpLogMapIn);
+        backfillCache.SetDbOpLogMap(pDbOpLogMapIn);
+    }
+
+    void RegisterUndoFunc(UndoDataFuncMap &undoDataFuncMap) {
+        addrTxCache.RegisterUndoFunc(undoDataFuncMap);
+        backfillCache.RegisterUndoFunc(undoDataFuncMap);
+    }
+private:
+/*       type               prefixType               key                     value                 variable               */
+/*  ----------------   -------------------------   -----------------------  ------------------   ------------------------ */
+    /////////// AddrTxDB
+    AddrTxCache   addrTxCache;
+    // -> {next_height, end_height}
+    CSimpleKVCache< dbk::ADDR_TX_BACKFILL,                              pair<CVarIntValue<uint32_t>, CVarIntValue<uint32_t>> >  backfillCache;
+};
+
+#endif // PERSIST_ADDRTXDB_H
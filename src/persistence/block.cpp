@@ -5,10 +5,14 @@
 
 #include "block.h"
 
+#include "blockfilereader.h"
 #include "entities/account.h"
 #include "main.h"
 #include "net.h"
 
+#include <atomic>
+#include <thread>
+
 uint256 CBlockHeader::GetHash() const {
     return ComputeSignatureHash();
 }
@@ -184,18 +188,41 @@ bool ReadBlockFromDisk(const CBlockIndex *pIndex, CBlock &block) {
     return true;
 }
 
+bool ReadBlocksFromDisk(const vector<const CBlockIndex *> &indexes, vector<CBlock> &blocks, int32_t nThreads) {
+    blocks.clear();
+    blocks.resize(indexes.size());
+    nThreads = max(1, min(nThreads, (int32_t)indexes.size()));
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto reader = [&]() {
+        for (size_t i = next++; i < indexes.size() && !failed; i = next++) {
+            if (!ReadBlockFromDisk(indexes[i], blocks[i]))
+                failed = true;
+        }
+    };
+
+    vector<std::thread> threads;
+    for (int32_t i = 1; i < nThreads; ++i)
+        threads.emplace_back(reader);
+    reader();
+    for (auto &thread : threads)
+        thread.join();
+
+    if (failed)
+        return ERRORMSG("%s : read %u blocks failed", __func__, indexes.size());
+
+    return true;
+}
+
 bool ReadBaseTxFromDisk(const CTxCord txCord, std::shared_ptr<CBaseTx> &pTx) {
-    auto pBlock = std::make_shared<CBlock>();
     const CBlockIndex* pBlockIndex = chainActive[ txCord.GetHeight() ];
     if (pBlockIndex == nullptr) {
         return ERRORMSG("ReadBaseTxFromDisk error, the height(%d) is exceed current best block height", txCord.GetHeight());
     }
-    if (!ReadBlockFromDisk(pBlockIndex, *pBlock)) {
-        return ERRORMSG("ReadBaseTxFromDisk error, read the block at height(%d) failed!", txCord.GetHeight());
-    }
-    if (txCord.GetIndex() >= pBlock->vptx.size()) {
-        return ERRORMSG("ReadBaseTxFromDisk error, the tx(%s) index exceed the tx count of block", txCord.ToString());
+    // one read of the tx bytes once the tx offset table of the block is built
+    if (!blockFileReader.ReadTx(pBlockIndex->GetBlockPos(), txCord.GetIndex(), pTx)) {
+        return ERRORMSG("ReadBaseTxFromDisk error, read the tx(%s) failed!", txCord.ToString());
     }
-    pTx = pBlock->vptx.at(txCord.GetIndex())->GetNewInstance();
     return true;
 }
@@ -21,6 +21,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include <unordered_map>
 
 class CBlockDBCache;
 class CDiskBlockPos;
@@ -235,7 +236,9 @@ public:
     uint32_t nNonce;
     uint64_t nFuel;
     uint32_t nFuelRate;
-    vector<unsigned char> vSignature;
+    // cold field, entries loaded from the block index file read it from the db on first use, see GetSignature()
+    mutable vector<unsigned char> vSignature;
+    mutable bool fSignatureLoaded;
 
     CRegID miner;
 
@@ -262,6 +265,7 @@ public:
         nFuel          = 0;
         nFuelRate      = INIT_FUEL_RATES;
         vSignature.clear();
+        fSignatureLoaded = true;
     }
 
     CBlockIndex(const CBlock &block) {
@@ -290,6 +294,7 @@ public:
         nFuel          = block.GetFuel();
         nFuelRate      = block.GetFuelRate();
         vSignature     = block.GetSignature();
+        fSignatureLoaded = true;
       /*  if(block.GetHeight() == 0 )
             miner = CRegID("0-1");
         else
@@ -324,11 +329,14 @@ public:
         block.SetTime(nTime);
         block.SetNonce(nNonce);
         block.SetHeight(height);
-        block.SetSignature(vSignature);
+        block.SetSignature(GetSignature());
 
         return block;
     }
 
+    // load the signature if needed, must be called with cs_main held
+    const vector<unsigned char> &GetSignature() const;
+
     uint256 GetBlockHash() const { return *pBlockHash; }
     int64_t GetBlockTime() const { return (int64_t)nTime; }
     bool CheckIndex() const { return true; }
@@ -376,6 +384,9 @@ public:
     const CBlockIndex *GetAncestor(int32_t heightIn) const;
 };
 
+// block hash -> block index, the entries are owned by blockIndexArena
+typedef std::unordered_map<uint256, CBlockIndex *, CUint256Hasher> BlockMap;
+
 
 /** Used to marshal pointers into hashes for db storage. */
 class CDiskBlockIndex : public CBlockIndex {
@@ -385,7 +396,9 @@ public:
     CDiskBlockIndex() : hashPrev(uint256()) {}
 
     explicit CDiskBlockIndex(CBlockIndex *pIndex) : CBlockIndex(*pIndex) {
-        hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
+        hashPrev         = (pprev ? pprev->GetBlockHash() : uint256());
+        vSignature       = pIndex->GetSignature();
+        fSignatureLoaded = true;
     }
 
     IMPLEMENT_SERIALIZE(
@@ -469,6 +482,10 @@ bool WriteBlockToDisk(CBlock &block, CDiskBlockPos &pos);
 bool ReadBlockFromDisk(const CDiskBlockPos &pos, CBlock &block);
 bool ReadBlockFromDisk(const CBlockIndex *pIndex, CBlock &block);
 
+static const int32_t DEFAULT_BLOCK_READ_THREADS = 4;
+/** Read the blocks of indexes with up to nThreads readers, blocks[i] is the block of indexes[i] */
+bool ReadBlocksFromDisk(const vector<const CBlockIndex *> &indexes, vector<CBlock> &blocks, int32_t nThreads);
+
 
 bool ReadBaseTxFromDisk(const CTxCord txCord, std::shared_ptr<CBaseTx> &pTx);
 
@@ -8,6 +8,7 @@
 #include "commons/uint256.h"
 #include "commons/util/util.h"
 #include "main.h"
+#include "blockindexstore.h"
 
 #include <stdint.h>
 
@@ -18,6 +19,9 @@ using namespace std;
 bool CBlockIndexDB::WriteBlockIndex(const CDiskBlockIndex &blockIndex) {
     return Write(dbk::GenDbKey(dbk::BLOCK_INDEX, blockIndex.GetBlockHash()), blockIndex);
 }
+bool CBlockIndexDB::ReadBlockIndex(const uint256 &blockHash, CDiskBlockIndex &blockIndex) {
+    return Read(dbk::GenDbKey(dbk::BLOCK_INDEX, blockHash), blockIndex);
+}
 bool CBlockIndexDB::EraseBlockIndex(const uint256 &blockHash) {
     return Erase(dbk::GenDbKey(dbk::BLOCK_INDEX, blockHash));
 }
@@ -87,14 +91,12 @@ CBlockIndex *InsertBlockIndex(uint256 hash) {
         return nullptr;
 
     // Return existing
-    map<uint256, CBlockIndex *>::iterator mi = mapBlockIndex.find(hash);
+    BlockMap::iterator mi = mapBlockIndex.find(hash);
     if (mi != mapBlockIndex.end())
         return (*mi).second;
 
     // Create new
-    CBlockIndex *pIndexNew = new CBlockIndex();
-    if (!pIndexNew)
-        throw runtime_error("LoadBlockIndex() : new CBlockIndex failed");
+    CBlockIndex *pIndexNew = blockIndexArena.New();
     mi                    = mapBlockIndex.insert(make_pair(hash, pIndexNew)).first;
     pIndexNew->pBlockHash = &((*mi).first);
 
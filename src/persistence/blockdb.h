@@ -30,6 +30,7 @@ public:
 
 public:
     bool WriteBlockIndex(const CDiskBlockIndex &blockindex);
+    bool ReadBlockIndex(const uint256 &blockHash, CDiskBlockIndex &blockIndex);
     bool EraseBlockIndex(const uint256 &blockHash);
     bool LoadBlockIndexes();
 
@@ -0,0 +1,258 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockfilereader.h"
+
+#include <fcntl.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "block.h"
+#include "commons/serialize.h"
+#include "commons/util/util.h"
+#include "config/const.h"
+#include "config/version.h"
+#include "tx/txserializer.h"
+
+CBlockFileReader blockFileReader;
+
+// the first read of a header or a tx, enough for nearly all of them
+static const size_t INITIAL_READ_SIZE = 4096;
+
+static string PosToString(const CDiskBlockPos &pos) { return strprintf("blk%05u.dat:%u", pos.nFile, pos.nPos); }
+
+CBlockFileReader::CBlockFile::~CBlockFile() {
+    if (fd >= 0) {
+#ifdef WIN32
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }
+}
+
+std::shared_ptr<CBlockFileReader::CBlockFile> CBlockFileReader::GetFile(int32_t nFile) {
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = files.find(nFile);
+    if (it != files.end()) {
+        it->second.second = ++nUseCounter;
+        return it->second.first;
+    }
+
+    boost::filesystem::path path = GetDataDir() / "blocks" / strprintf("blk%05u.dat", nFile);
+    auto pFile = std::make_shared<CBlockFile>();
+#ifdef WIN32
+    pFile->fd = _open(path.string().c_str(), _O_RDONLY | _O_BINARY);
+#else
+    pFile->fd = open(path.string().c_str(), O_RDONLY);
+#endif
+    if (pFile->fd < 0) {
+        LogPrint(BCLog::ERROR, "Unable to open file %s - %s\n", path.string(), strerror(errno));
+        return nullptr;
+    }
+
+    if (files.size() >= MAX_OPEN_FILES) {
+        // a reader still holding the evicted file keeps it open until its read is done
+        auto itOldest = std::min_element(files.begin(), files.end(), [](const auto &a, const auto &b) {
+            return a.second.second < b.second.second;
+        });
+        files.erase(itOldest);
+    }
+    files[nFile] = {pFile, ++nUseCounter};
+    return pFile;
+}
+
+bool CBlockFileReader::ReadAt(int32_t nFile, uint32_t nPos, size_t size, std::vector<char> &data) {
+    auto pFile = GetFile(nFile);
+    if (!pFile)
+        return false;
+
+    data.resize(size);
+    size_t nRead = 0;
+#ifdef WIN32
+    std::lock_guard<std::mutex> lock(pFile->cs);
+    if (_lseeki64(pFile->fd, nPos, SEEK_SET) < 0)
+        return ERRORMSG("%s : seek blk%05u.dat to %u failed - %s", __func__, nFile, nPos, strerror(errno));
+    while (nRead < size) {
+        int n = _read(pFile->fd, data.data() + nRead, size - nRead);
+        if (n < 0)
+            return ERRORMSG("%s : read blk%05u.dat failed - %s", __func__, nFile, strerror(errno));
+        if (n == 0)  // end of the file
+            break;
+        nRead += n;
+    }
+#else
+    while (nRead < size) {
+        ssize_t n = pread(pFile->fd, data.data() + nRead, size - nRead, (off_t)nPos + nRead);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return ERRORMSG("%s : read blk%05u.dat failed - %s", __func__, nFile, strerror(errno));
+        }
+        if (n == 0)  // end of the file
+            break;
+        nRead += n;
+    }
+#endif
+    data.resize(nRead);
+    return true;
+}
+
+bool CBlockFileReader::ReadBlockSize(const CDiskBlockPos &pos, uint32_t &blockSize) {
+    // WriteBlockToDisk() writes the message start and the block size before the block
+    std::vector<char> data;
+    if (pos.nPos < sizeof(blockSize) || !ReadAt(pos.nFile, pos.nPos - sizeof(blockSize), sizeof(blockSize), data) ||
+        data.size() != sizeof(blockSize))
+        return ERRORMSG("%s : read block size at %s failed", __func__, PosToString(pos));
+
+    CDataStream ss(data.data(), data.data() + data.size(), SER_DISK, CLIENT_VERSION);
+    ss >> blockSize;
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE)
+        return ERRORMSG("%s : invalid block size %u at %s", __func__, blockSize, PosToString(pos));
+
+    return true;
+}
+
+template <typename T>
+bool CBlockFileReader::ReadObject(int32_t nFile, uint32_t nPos, uint32_t nEnd, T &obj, uint32_t *pSize) {
+    size_t size = std::min<size_t>(INITIAL_READ_SIZE, nEnd - nPos);
+    std::vector<char> data;
+    while (true) {
+        if (!ReadAt(nFile, nPos, size, data))
+            return false;
+
+        try {
+            CDataStream ss(data.data(), data.data() + data.size(), SER_DISK, CLIENT_VERSION);
+            ss >> obj;
+            if (pSize != nullptr)
+                *pSize = data.size() - ss.size();
+            return true;
+        } catch (std::ios_base::failure &e) {
+            // the object goes beyond the data read, unless the block or the file ends there
+            if (data.size() < size || size >= nEnd - nPos)
+                return ERRORMSG("%s : deserialize at blk%05u.dat:%u failed - %s", __func__, nFile, nPos, e.what());
+        } catch (std::exception &e) {
+            return ERRORMSG("%s : deserialize at blk%05u.dat:%u failed - %s", __func__, nFile, nPos, e.what());
+        }
+        size = std::min<size_t>(size * 4, nEnd - nPos);
+    }
+}
+
+bool CBlockFileReader::ReadBlockHeader(const CDiskBlockPos &pos, CBlockHeader &header) {
+    uint32_t blockSize;
+    if (!ReadBlockSize(pos, blockSize))
+        return false;
+
+    return ReadObject(pos.nFile, pos.nPos, pos.nPos + blockSize, header);
+}
+
+bool CBlockFileReader::ReadTx(const CDiskTxPos &pos, std::shared_ptr<CBaseTx> &pTx) {
+    uint32_t blockSize;
+    if (!ReadBlockSize(pos, blockSize))
+        return false;
+
+    uint32_t nEnd = pos.nPos + blockSize;
+    CBlockHeader header;
+    uint32_t headerSize;
+    if (!ReadObject(pos.nFile, pos.nPos, nEnd, header, &headerSize))
+        return false;
+
+    // the tx offset is from the end of the header
+    uint32_t nTxPos = pos.nPos + headerSize + pos.nTxOffset;
+    if (nTxPos >= nEnd)
+        return ERRORMSG("%s : tx offset %u beyond the block at %s", __func__, pos.nTxOffset, PosToString(pos));
+
+    return ReadObject(pos.nFile, nTxPos, nEnd, pTx);
+}
+
+bool CBlockFileReader::GetTxOffsetTable(const CDiskBlockPos &blockPos, std::vector<uint32_t> &offsets) {
+    auto key = std::make_pair(blockPos.nFile, blockPos.nPos);
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        auto it = offsetTables.find(key);
+        if (it != offsetTables.end()) {
+            it->second.lastUse = ++nUseCounter;
+            offsets            = it->second.offsets;
+            return true;
+        }
+    }
+
+    // read the whole block once, the txs are located by deserializing them in turn
+    uint32_t blockSize;
+    std::vector<char> data;
+    if (!ReadBlockSize(blockPos, blockSize) || !ReadAt(blockPos.nFile, blockPos.nPos, blockSize, data))
+        return false;
+    if (data.size() != blockSize)
+        return ERRORMSG("%s : the block at %s is truncated", __func__, PosToString(blockPos));
+
+    offsets.clear();
+    try {
+        CDataStream ss(data.data(), data.data() + data.size(), SER_DISK, CLIENT_VERSION);
+        CBlockHeader header;
+        ss >> header;
+        uint64_t txCount = ReadCompactSize(ss);
+        offsets.reserve(txCount + 1);
+        for (uint64_t i = 0; i < txCount; i++) {
+            offsets.push_back(blockPos.nPos + blockSize - ss.size());
+            std::shared_ptr<CBaseTx> pTx;
+            ss >> pTx;
+        }
+        offsets.push_back(blockPos.nPos + blockSize - ss.size());
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : deserialize the block at %s failed - %s", __func__, PosToString(blockPos), e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(cs);
+    if (offsetTables.size() >= MAX_OFFSET_TABLES) {
+        auto itOldest = std::min_element(offsetTables.begin(), offsetTables.end(), [](const auto &a, const auto &b) {
+            return a.second.lastUse < b.second.lastUse;
+        });
+        offsetTables.erase(itOldest);
+    }
+    CTxOffsetTable &table = offsetTables[key];
+    table.offsets         = offsets;
+    table.lastUse         = ++nUseCounter;
+    return true;
+}
+
+bool CBlockFileReader::ReadTx(const CDiskBlockPos &blockPos, uint32_t index, std::shared_ptr<CBaseTx> &pTx) {
+    std::vector<uint32_t> offsets;
+    if (!GetTxOffsetTable(blockPos, offsets))
+        return false;
+    if (index + 1 >= offsets.size())
+        return ERRORMSG("%s : tx index %u exceeds the tx count %u of the block at %s", __func__, index,
+                        offsets.size() - 1, PosToString(blockPos));
+
+    uint32_t size = offsets[index + 1] - offsets[index];
+    std::vector<char> data;
+    if (!ReadAt(blockPos.nFile, offsets[index], size, data) || data.size() != size)
+        return ERRORMSG("%s : read tx %u of the block at %s failed", __func__, index, PosToString(blockPos));
+
+    try {
+        CDataStream ss(data.data(), data.data() + data.size(), SER_DISK, CLIENT_VERSION);
+        ss >> pTx;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : deserialize tx %u of the block at %s failed - %s", __func__, index,
+                        PosToString(blockPos), e.what());
+    }
+    return true;
+}
+
+void CBlockFileReader::CloseFile(int32_t nFile) {
+    std::lock_guard<std::mutex> lock(cs);
+    files.erase(nFile);
+    for (auto it = offsetTables.begin(); it != offsetTables.end();) {
+        if (it->first.first == nFile)
+            it = offsetTables.erase(it);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PERSIST_BLOCKFILEREADER_H
+#define PERSIST_BLOCKFILEREADER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "disk.h"
+
+class CBaseTx;
+class CBlockHeader;
+
+/**
+ * Reader of single records of the blk?????.dat files. The recently used files are kept open and read
+ * with pread(), which leaves no file position to share, so any thread may read without cs_main.
+ * A tx is located in its block by a tx offset table, built once per block and kept for the recently
+ * read blocks, so reading any tx of the block is then one read of exactly its bytes.
+ * The blocks are never rewritten at their positions, so nothing read here goes stale.
+ */
+class CBlockFileReader {
+public:
+    static const size_t MAX_OPEN_FILES   = 8;
+    static const size_t MAX_OFFSET_TABLES = 1024;
+
+    bool ReadBlockHeader(const CDiskBlockPos &pos, CBlockHeader &header);
+    // the tx at the position recorded in the tx index
+    bool ReadTx(const CDiskTxPos &pos, std::shared_ptr<CBaseTx> &pTx);
+    // the tx of the index in the block, e.g. of a CTxCord
+    bool ReadTx(const CDiskBlockPos &blockPos, uint32_t index, std::shared_ptr<CBaseTx> &pTx);
+
+    // close the file, e.g. before it is removed
+    void CloseFile(int32_t nFile);
+
+private:
+    struct CBlockFile {
+        int fd = -1;
+#ifdef WIN32
+        std::mutex cs;  // no pread(), the reads share the file position
+#endif
+        ~CBlockFile();
+    };
+
+    struct CTxOffsetTable {
+        std::vector<uint32_t> offsets;  // file positions of the txs, then of the end of the block
+        uint64_t lastUse = 0;
+    };
+
+    std::shared_ptr<CBlockFile> GetFile(int32_t nFile);
+    // read up to size bytes at the file position, fewer at the end of the file
+    bool ReadAt(int32_t nFile, uint32_t nPos, size_t size, std::vector<char> &data);
+    bool ReadBlockSize(const CDiskBlockPos &pos, uint32_t &blockSize);
+    // deserialize obj at the file position with growing reads that stop at nEnd, *pSize is its size
+    template <typename T>
+    bool ReadObject(int32_t nFile, uint32_t nPos, uint32_t nEnd, T &obj, uint32_t *pSize = nullptr);
+    bool GetTxOffsetTable(const CDiskBlockPos &blockPos, std::vector<uint32_t> &offsets);
+
+    std::mutex cs;
+    uint64_t nUseCounter = 0;
+    std::map<int32_t, std::pair<std::shared_ptr<CBlockFile>, uint64_t>> files;  // file -> (file, last use)
+    std::map<std::pair<int32_t, uint32_t>, CTxOffsetTable> offsetTables;       // block position -> table
+};
+
+extern CBlockFileReader blockFileReader;
+
+#endif  // PERSIST_BLOCKFILEREADER_H
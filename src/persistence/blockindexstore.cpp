@@ -0,0 +1,225 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockindexstore.h"
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "commons/util/util.h"
+#include "logging.h"
+#include "main.h"
+
+CBlockIndexArena blockIndexArena;
+
+static const char BLOCK_INDEX_FILE_MAGIC[8] = {'W', 'I', 'C', 'C', 'B', 'I', 'D', 'X'};
+static const uint32_t BLOCK_INDEX_FILE_VERSION = 1;
+
+struct CBlockIndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+    uint256 bestBlockHash;
+};
+
+struct CBlockIndexRecord {
+    uint256 blockHash;
+    uint256 merkleRootHash;
+    uint256 hashPos;
+    int64_t prevPos;  // position of the record of pprev, -1 if none
+    uint64_t nFuel;
+    int32_t height;
+    int32_t nFile;
+    uint32_t nDataPos;
+    uint32_t nUndoPos;
+    uint32_t nTx;
+    uint32_t nStatus;
+    int32_t nVersion;
+    uint32_t nTime;
+    uint32_t nBits;
+    uint32_t nNonce;
+    uint32_t nFuelRate;
+    uint32_t minerHeight;
+    uint16_t minerIndex;
+    uint16_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<CBlockIndexFileHeader>::value, "block index file header must be POD");
+static_assert(std::is_trivially_copyable<CBlockIndexRecord>::value, "block index record must be POD");
+
+bool WriteBlockIndexFile(const boost::filesystem::path &path, const uint256 &bestBlockHash) {
+    AssertLockHeld(cs_main);
+    int64_t beginTime = GetTimeMillis();
+
+    vector<CBlockIndex *> vSortedByHeight;
+    vSortedByHeight.reserve(mapBlockIndex.size());
+    for (const auto &item : mapBlockIndex)
+        vSortedByHeight.push_back(item.second);
+    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+              [](const CBlockIndex *a, const CBlockIndex *b) { return a->height < b->height; });
+
+    std::unordered_map<const CBlockIndex *, int64_t> positions;
+    positions.reserve(vSortedByHeight.size());
+
+    vector<CBlockIndexRecord> records(vSortedByHeight.size());
+    for (size_t pos = 0; pos < vSortedByHeight.size(); pos++) {
+        const CBlockIndex *pIndex = vSortedByHeight[pos];
+        positions[pIndex]         = pos;
+
+        CBlockIndexRecord &record = records[pos];
+        memset(&record, 0, sizeof(record));
+        record.blockHash      = pIndex->GetBlockHash();
+        record.merkleRootHash = pIndex->merkleRootHash;
+        record.hashPos        = pIndex->hashPos;
+        record.prevPos        = -1;
+        if (pIndex->pprev) {
+            auto it = positions.find(pIndex->pprev);
+            if (it == positions.end())
+                return ERRORMSG("%s : prev of block %s is not in the index", __func__, pIndex->GetIndentityString());
+            record.prevPos = it->second;
+        }
+        record.nFuel       = pIndex->nFuel;
+        record.height      = pIndex->height;
+        record.nFile       = pIndex->nFile;
+        record.nDataPos    = pIndex->nDataPos;
+        record.nUndoPos    = pIndex->nUndoPos;
+        record.nTx         = pIndex->nTx;
+        record.nStatus     = pIndex->nStatus;
+        record.nVersion    = pIndex->nVersion;
+        record.nTime       = pIndex->nTime;
+        record.nBits       = pIndex->nBits;
+        record.nNonce      = pIndex->nNonce;
+        record.nFuelRate   = pIndex->nFuelRate;
+        record.minerHeight = pIndex->miner.GetHeight();
+        record.minerIndex  = pIndex->miner.GetIndex();
+    }
+
+    CBlockIndexFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BLOCK_INDEX_FILE_MAGIC, sizeof(header.magic));
+    header.version       = BLOCK_INDEX_FILE_VERSION;
+    header.recordSize    = sizeof(CBlockIndexRecord);
+    header.count         = records.size();
+    header.bestBlockHash = bestBlockHash;
+
+    boost::filesystem::path pathTmp = path;
+    pathTmp += ".new";
+    FILE *file = fopen(pathTmp.string().c_str(), "wb");
+    if (!file)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   (records.empty() || fwrite(records.data(), sizeof(CBlockIndexRecord), records.size(), file) == records.size());
+    if (written)
+        FileCommit(file);
+    fclose(file);
+    if (!written)
+        return ERRORMSG("%s : Failed to write file %s", __func__, pathTmp.string());
+
+    if (!RenameOver(pathTmp, path))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    LogPrint(BCLog::INFO, "Wrote %u block indexes to %s (%dms)\n", records.size(), path.string(),
+             GetTimeMillis() - beginTime);
+    return true;
+}
+
+static bool LinkBlockIndexRecords(const CBlockIndexRecord *pRecords, uint64_t count,
+                                  vector<CBlockIndex *> &vSortedByHeight) {
+    blockIndexArena.Reserve(count);
+    mapBlockIndex.reserve(mapBlockIndex.size() + count);
+    vSortedByHeight.reserve(count);
+
+    for (uint64_t pos = 0; pos < count; pos++) {
+        const CBlockIndexRecord &record = pRecords[pos];
+        if (record.prevPos >= (int64_t)pos || record.prevPos < -1)
+            return ERRORMSG("%s : invalid prev of record %llu", __func__, pos);
+
+        CBlockIndex *pPrev = record.prevPos < 0 ? nullptr : vSortedByHeight[record.prevPos];
+        if (pPrev && pPrev->height + 1 != record.height)
+            return ERRORMSG("%s : invalid height of record %llu", __func__, pos);
+
+        auto ret = mapBlockIndex.emplace(record.blockHash, nullptr);
+        if (!ret.second)
+            return ERRORMSG("%s : duplicated block %s", __func__, record.blockHash.ToString());
+
+        CBlockIndex *pIndex     = blockIndexArena.New();
+        ret.first->second       = pIndex;
+        pIndex->pBlockHash      = &ret.first->first;
+        pIndex->pprev           = pPrev;
+        pIndex->height          = record.height;
+        pIndex->nFile           = record.nFile;
+        pIndex->nDataPos        = record.nDataPos;
+        pIndex->nUndoPos        = record.nUndoPos;
+        pIndex->nTx             = record.nTx;
+        pIndex->nStatus         = record.nStatus;
+        pIndex->nVersion        = record.nVersion;
+        pIndex->merkleRootHash  = record.merkleRootHash;
+        pIndex->hashPos         = record.hashPos;
+        pIndex->nTime           = record.nTime;
+        pIndex->nBits           = record.nBits;
+        pIndex->nNonce          = record.nNonce;
+        pIndex->nFuel           = record.nFuel;
+        pIndex->nFuelRate       = record.nFuelRate;
+        pIndex->miner           = CRegID(record.minerHeight, record.minerIndex);
+        pIndex->fSignatureLoaded = false;
+
+        vSortedByHeight.push_back(pIndex);
+    }
+
+    return true;
+}
+
+bool LoadBlockIndexFile(const boost::filesystem::path &path, const uint256 &bestBlockHash,
+                        vector<CBlockIndex *> &vSortedByHeight) {
+    AssertLockHeld(cs_main);
+    if (!boost::filesystem::exists(path))
+        return false;
+
+    int64_t beginTime = GetTimeMillis();
+    bool loaded       = false;
+    try {
+        boost::interprocess::file_mapping mapping(path.string().c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+        const char *pData = static_cast<const char *>(region.get_address());
+        size_t size       = region.get_size();
+
+        CBlockIndexFileHeader header;
+        if (size < sizeof(header))
+            return ERRORMSG("%s : file %s is truncated", __func__, path.string());
+        memcpy(&header, pData, sizeof(header));
+
+        if (memcmp(header.magic, BLOCK_INDEX_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != BLOCK_INDEX_FILE_VERSION || header.recordSize != sizeof(CBlockIndexRecord) ||
+            size != sizeof(header) + header.count * sizeof(CBlockIndexRecord)) {
+            LogPrint(BCLog::INFO, "%s : ignore file %s of another format\n", __func__, path.string());
+        } else if (header.bestBlockHash != bestBlockHash) {
+            // written before the db moved on, e.g. after a crash
+            LogPrint(BCLog::INFO, "%s : ignore stale file %s\n", __func__, path.string());
+        } else {
+            // the records follow the header at an 8-byte aligned offset of the page aligned mapping
+            auto pRecords = reinterpret_cast<const CBlockIndexRecord *>(pData + sizeof(header));
+            loaded = LinkBlockIndexRecords(pRecords, header.count, vSortedByHeight);
+        }
+    } catch (std::exception &e) {
+        LogPrint(BCLog::ERROR, "%s : failed to map file %s - %s\n", __func__, path.string(), e.what());
+    }
+
+    if (!loaded) {
+        mapBlockIndex.clear();
+        blockIndexArena.Clear();
+        vSortedByHeight.clear();
+        return false;
+    }
+
+    LogPrint(BCLog::INFO, "Loaded %u block indexes from %s (%dms)\n", vSortedByHeight.size(), path.string(),
+             GetTimeMillis() - beginTime);
+    return true;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PERSIST_BLOCKINDEXSTORE_H
+#define PERSIST_BLOCKINDEXSTORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include "block.h"
+#include "sync.h"
+
+static const char *const BLOCK_INDEX_FILE_NAME = "blockindex.dat";
+
+/**
+ * Owner of all CBlockIndex entries. The entries are allocated in chunks of contiguous memory
+ * and live until shutdown, so the pointers kept in mapBlockIndex and the chains stay valid.
+ */
+class CBlockIndexArena {
+public:
+    static const size_t CHUNK_SIZE = 4096;
+
+    template <typename... Args>
+    CBlockIndex *New(Args &&... args) {
+        LOCK(cs);
+        if (chunks.empty() || chunks.back().size() == chunks.back().capacity()) {
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK_SIZE);
+        }
+        // never grows beyond the reserved capacity, so no entry is moved
+        chunks.back().emplace_back(std::forward<Args>(args)...);
+        return &chunks.back().back();
+    }
+
+    // make the next chunk hold at least count entries, e.g. before a bulk load
+    void Reserve(size_t count) {
+        LOCK(cs);
+        if (!chunks.empty() && chunks.back().capacity() - chunks.back().size() >= count)
+            return;
+        chunks.emplace_back();
+        chunks.back().reserve(std::max(CHUNK_SIZE, count));
+    }
+
+    void Clear() {
+        LOCK(cs);
+        chunks.clear();
+    }
+
+    size_t GetSize() const {
+        LOCK(cs);
+        size_t size = 0;
+        for (const auto &chunk : chunks)
+            size += chunk.size();
+        return size;
+    }
+
+private:
+    mutable CCriticalSection cs;
+    std::vector<std::vector<CBlockIndex>> chunks;
+};
+
+extern CBlockIndexArena blockIndexArena;
+
+/**
+ * The block index file is a snapshot of mapBlockIndex written at shutdown: fixed size records
+ * in height order, so that the next startup maps the file and links the entries in one pass
+ * instead of deserializing, sorting and linking every entry of the block index db.
+ * The signatures are left out and read from the db on demand.
+ * The records are in native byte order, the file is a local cache which is only used when it
+ * matches the best block of the db, and is removed once loaded so a crash falls back to the db.
+ */
+bool WriteBlockIndexFile(const boost::filesystem::path &path, const uint256 &bestBlockHash);
+
+/** Load the file into mapBlockIndex, the loaded entries are returned in height order */
+bool LoadBlockIndexFile(const boost::filesystem::path &path, const uint256 &bestBlockHash,
+                        std::vector<CBlockIndex *> &vSortedByHeight);
+
+#endif  // PERSIST_BLOCKINDEXSTORE_H
@@ -29,6 +29,7 @@ CCacheWrapper::CCacheWrapper(CCacheWrapper *cwIn) {
     closedCdpCache.SetBaseViewPtr(&cwIn->closedCdpCache);
     dexCache.SetBaseViewPtr(&cwIn->dexCache);
     txReceiptCache.SetBaseViewPtr(&cwIn->txReceiptCache);
+    addrTxCache.SetBaseViewPtr(&cwIn->addrTxCache);
 
     txCache.SetBaseViewPtr(&cwIn->txCache);
     ppCache.SetBaseViewPtr(&cwIn->ppCache);
@@ -45,6 +46,7 @@ CCacheWrapper::CCacheWrapper(CCacheDBManager* pCdMan) {
     closedCdpCache.SetBaseViewPtr(pCdMan->pClosedCdpCache);
     dexCache.SetBaseViewPtr(pCdMan->pDexCache);
     txReceiptCache.SetBaseViewPtr(pCdMan->pReceiptCache);
+    addrTxCache.SetBaseViewPtr(pCdMan->pAddrTxCache);
 
     txCache.SetBaseViewPtr(pCdMan->pTxCache);
     ppCache.SetBaseViewPtr(pCdMan->pPpCache);
@@ -61,6 +63,7 @@ void CCacheWrapper::CopyFrom(CCacheDBManager* pCdMan){
     closedCdpCache = *pCdMan->pClosedCdpCache;
     dexCache       = *pCdMan->pDexCache;
     txReceiptCache = *pCdMan->pReceiptCache;
+    addrTxCache    = *pCdMan->pAddrTxCache;
 
     txCache = *pCdMan->pTxCache;
     ppCache = *pCdMan->pPpCache;
@@ -80,6 +83,7 @@ CCacheWrapper& CCacheWrapper::operator=(CCacheWrapper& other) {
     this->closedCdpCache = other.closedCdpCache;
     this->dexCache       = other.dexCache;
     this->txReceiptCache = other.txReceiptCache;
+    this->addrTxCache    = other.addrTxCache;
     this->txCache        = other.txCache;
     this->ppCache        = other.ppCache;
 
@@ -97,6 +101,7 @@ void CCacheWrapper::Flush() {
     closedCdpCache.Flush();
     dexCache.Flush();
     txReceiptCache.Flush();
+    addrTxCache.Flush();
 
     txCache.Flush();
     ppCache.Flush();
@@ -113,6 +118,7 @@ void CCacheWrapper::SetDbOpLogMap(CDBOpLogMap *pDbOpLogMap) {
     closedCdpCache.SetDbOpLogMap(pDbOpLogMap);
     dexCache.SetDbOpLogMap(pDbOpLogMap);
     txReceiptCache.SetDbOpLogMap(pDbOpLogMap);
+    addrTxCache.SetDbOpLogMap(pDbOpLogMap);
 }
 
 UndoDataFuncMap CCacheWrapper::GetUndoDataFuncMap() {
@@ -127,6 +133,7 @@ UndoDataFuncMap CCacheWrapper::GetUndoDataFuncMap() {
     closedCdpCache.RegisterUndoFunc(undoDataFuncMap);
     dexCache.RegisterUndoFunc(undoDataFuncMap);
     txReceiptCache.RegisterUndoFunc(undoDataFuncMap);
+    addrTxCache.RegisterUndoFunc(undoDataFuncMap);
     return undoDataFuncMap;
 }
 
@@ -170,6 +177,9 @@ CCacheDBManager::CCacheDBManager(bool fReIndex, bool fMemory) {
     pReceiptDb      = new CDBAccess(dbDir, DBNameType::RECEIPT, false, fReIndex);
     pReceiptCache   = new CTxReceiptDBCache(pReceiptDb);
 
+    pAddrTxDb       = new CDBAccess(dbDir, DBNameType::ADDRTX, false, fReIndex);
+    pAddrTxCache    = new CAddrTxDBCache(pAddrTxDb);
+
     // memory-only cache
     pTxCache        = new CTxMemCache();
     pPpCache        = new CPricePointMemCache();
@@ -187,6 +197,7 @@ CCacheDBManager::~CCacheDBManager() {
     delete pBlockCache;     pBlockCache = nullptr;
     delete pLogCache;       pLogCache = nullptr;
     delete pReceiptCache;   pReceiptCache = nullptr;
+    delete pAddrTxCache;    pAddrTxCache = nullptr;
 
     delete pSysParamDb;     pSysParamDb = nullptr;
     delete pAccountDb;      pAccountDb = nullptr;
@@ -200,6 +211,7 @@ CCacheDBManager::~CCacheDBManager() {
     delete pBlockDb;        pBlockDb = nullptr;
     delete pLogDb;          pLogDb = nullptr;
     delete pReceiptDb;      pReceiptDb = nullptr;
+    delete pAddrTxDb;       pAddrTxDb = nullptr;
 
     // memory-only cache
     delete pTxCache;        pTxCache = nullptr;
@@ -231,6 +243,8 @@ bool CCacheDBManager::Flush() {
 
     if (pReceiptCache) pReceiptCache->Flush();
 
+    if (pAddrTxCache) pAddrTxCache->Flush();
+
     // Memory only cache, not bother to flush.
     // if (pTxCache)
     //     pTxCache->Flush();
@@ -239,3 +253,8 @@ bool CCacheDBManager::Flush() {
 
     return true;
 }
+
+vector<CDBAccess *> CCacheDBManager::GetDbAccesses() const {
+    return {pSysParamDb, pAccountDb, pAssetDb, pContractDb, pDelegateDb, pCdpDb, pClosedCdpDb,
+            pDexDb,      pBlockDb,   pLogDb,   pReceiptDb,  pAddrTxDb};
+}
@@ -7,6 +7,7 @@
 #define PERSIST_CACHEWRAPPER_H
 
 #include "accountdb.h"
+#include "addrtxdb.h"
 #include "assetdb.h"
 #include "blockdb.h"
 #include "cdpdb.h"
@@ -34,6 +35,7 @@ public:
     CClosedCdpDBCache   closedCdpCache;
     CDexDBCache         dexCache;
     CTxReceiptDBCache   txReceiptCache;
+    CAddrTxDBCache      addrTxCache;
 
     CTxMemCache         txCache;
     CPricePointMemCache ppCache;
@@ -97,6 +99,9 @@ public:
     CDBAccess           *pReceiptDb;
     CTxReceiptDBCache   *pReceiptCache;
 
+    CDBAccess           *pAddrTxDb;
+    CAddrTxDBCache      *pAddrTxCache;
+
     CTxMemCache         *pTxCache;
     CPricePointMemCache *pPpCache;
 
@@ -106,6 +111,9 @@ public:
     ~CCacheDBManager();
 
     bool Flush();
+
+    // all the dbs of the caches above, excluding the block index db
+    vector<CDBAccess *> GetDbAccesses() const;
 };  // CCacheDBManager
 
 #endif //PERSIST_CACHEWRAPPER_H
\ No newline at end of file
@@ -55,6 +55,31 @@ public:
         return sp_it_Impl->SeekUpper(&lastKey);
     }
 
+    // seek the last contract key < *pContractKey, or <= *pContractKey if inclusive
+    bool SeekLower(const string *pContractKey, bool inclusive = false) {
+        if (pContractKey == nullptr)
+            return Last();
+        if (pContractKey->size() > CDBContractKey::MAX_KEY_SIZE)
+            return false;
+        KeyType key(GetPrefixElement().first, *pContractKey);
+        return sp_it_Impl->SeekLower(&key, inclusive);
+    }
+
+    // seek the last contract key of the prefix
+    bool Last() {
+        // the prefix with its last byte incremented is above all keys of the prefix
+        string upperKey = GetPrefixElement().second.GetKey();
+        while (!upperKey.empty() && (uint8_t)upperKey.back() == 0xFF)
+            upperKey.pop_back();
+        if (!upperKey.empty()) {
+            upperKey.back()++;
+            return SeekLower(&upperKey);
+        }
+        // no such key for an empty or all 0xFF prefix, all keys above it have the prefix
+        string maxKey(CDBContractKey::MAX_KEY_SIZE, (char)0xFF);
+        return SeekLower(&maxKey, true);
+    }
+
     const string& GetContractKey() const {
         return GetKey().second.GetKey();
     }
@@ -6,6 +6,7 @@
 #ifndef PERSIST_DB_ACCESS_H
 #define PERSIST_DB_ACCESS_H
 
+#include "commons/perfstats.h"
 #include "commons/uint256.h"
 #include "dbconf.h"
 #include "leveldbwrapper.h"
@@ -150,8 +151,9 @@ public:
     int64_t GetDbCount() const { return db.GetDbCount(); }
     template<typename KeyType, typename ValueType>
     bool GetData(const dbk::PrefixType prefixType, const KeyType &key, ValueType &value) const {
-        string keyStr = dbk::GenDbKey(prefixType, key);
-        return db.Read(keyStr, value);
+        dbk::CDBKeyBuffer keyBuf;
+        dbk::GenDbKey(prefixType, key, keyBuf);
+        return db.Read(keyBuf.GetSlice(), value);
     }
 
     template<typename ValueType>
@@ -167,10 +169,8 @@ public:
         uint32_t count             = 0;
         shared_ptr<leveldb::Iterator> pCursor = NewIterator();
 
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         const string &prefix = dbk::GetKeyPrefix(prefixType);
-        ssKey.write(prefix.c_str(), prefix.size());
-        pCursor->Seek(ssKey.str());
+        pCursor->Seek(prefix);
 
         for (; (count < maxNum) && pCursor->Valid(); pCursor->Next()) {
             boost::this_thread::interruption_point();
@@ -208,10 +208,8 @@ public:
         ValueType value;
         shared_ptr<leveldb::Iterator> pCursor = NewIterator();
 
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         const string &prefix = dbk::GetKeyPrefix(prefixType);
-        ssKey.write(prefix.c_str(), prefix.size());
-        pCursor->Seek(ssKey.str());
+        pCursor->Seek(prefix);
 
         for (; pCursor->Valid(); pCursor->Next()) {
             boost::this_thread::interruption_point();
@@ -285,10 +283,8 @@ public:
         KeyType key;
         ValueType value;
         shared_ptr<leveldb::Iterator> pCursor = NewIterator();
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         const string &prefix = dbk::GetKeyPrefix(prefixType);
-        ssKey.write(prefix.c_str(), prefix.size());
-        pCursor->Seek(ssKey.str());
+        pCursor->Seek(prefix);
 
         for (; pCursor->Valid(); pCursor->Next()) {
             boost::this_thread::interruption_point();
@@ -323,18 +319,20 @@ public:
 
     template<typename KeyType, typename ValueType>
     bool HaveData(const dbk::PrefixType prefixType, const KeyType &key) const {
-        string keyStr = dbk::GenDbKey(prefixType, key);
-        return db.Exists(keyStr);
+        dbk::CDBKeyBuffer keyBuf;
+        dbk::GenDbKey(prefixType, key, keyBuf);
+        return db.Exists(keyBuf.GetSlice());
     }
 
     template<typename KeyType, typename ValueType>
     void BatchWrite(const dbk::PrefixType prefixType, const map<KeyType, ValueType> &mapData) {        CLevelDBBatch batch;
-        for (auto item : mapData) {
-            string key = dbk::GenDbKey(prefixType, item.first);
+        for (const auto &item : mapData) {
+            dbk::CDBKeyBuffer keyBuf;
+            dbk::GenDbKey(prefixType, item.first, keyBuf);
             if (db_util::IsEmpty(item.second)) {
-                batch.Erase(key);
+                batch.Erase(keyBuf.GetSlice());
             } else {
-                batch.Write(key, item.second);
+                batch.Write(keyBuf.GetSlice(), item.second);
             }
         }
         db.WriteBatch(batch, true);
@@ -358,6 +356,9 @@ public:
     std::shared_ptr<leveldb::Iterator> NewIterator() {
         return std::shared_ptr<leveldb::Iterator>(db.NewIterator());
     }
+
+    // the underlying db, bypassing the caches, e.g. to stream a state snapshot
+    CLevelDBWrapper &GetLevelDB() { return db; }
 private:
     DBNameType dbNameType;
     mutable CLevelDBWrapper db; // // TODO: remove the mutable declare
@@ -372,6 +373,8 @@ public:
     typedef __ValueType ValueType;
     typedef typename std::map<KeyType, ValueType> Map;
     typedef typename std::map<KeyType, ValueType>::iterator Iterator;
+    // provide the top n elements of db, in place of seeking the db
+    typedef std::function<bool(const uint32_t maxNum, set<KeyType> &expiredKeys, set<KeyType> &keys)> TopNFunc;
 
 public:
     /**
@@ -404,11 +407,11 @@ public:
         return ::GetSerializeSize(mapData, SER_DISK, CLIENT_VERSION);
     }
 
-    bool GetTopNElements(const uint32_t maxNum, set<KeyType> &keys) {
+    bool GetTopNElements(const uint32_t maxNum, set<KeyType> &keys, const TopNFunc &dbTopNFunc = nullptr) {
         // 1. Get all candidate elements.
         set<KeyType> expiredKeys;
         set<KeyType> candidateKeys;
-        if (!GetTopNElements(maxNum, expiredKeys, candidateKeys)) {
+        if (!GetTopNElements(maxNum, expiredKeys, candidateKeys, dbTopNFunc)) {
             // TODO: log
             return false;
         }
@@ -547,10 +550,15 @@ public:
     map<KeyType, ValueType>& GetMapData() { return mapData; };
 private:
     Iterator GetDataIt(const KeyType &key) const {
+        CPerfCacheCounters &counters = perfStats.cache[PREFIX_TYPE];
         Iterator it = mapData.find(key);
         if (it != mapData.end()) {
+            counters.hits.fetch_add(1, std::memory_order_relaxed);
             return it;
-        } else if (pBase != nullptr) {
+        }
+
+        counters.misses.fetch_add(1, std::memory_order_relaxed);
+        if (pBase != nullptr) {
             // find key-value at base cache
             auto baseIt = pBase->GetDataIt(key);
             if (baseIt != pBase->mapData.end()) {
@@ -564,6 +572,7 @@ private:
         } else if (pDbAccess != NULL) {
             // TODO: need to save the empty value to mapData for search performance?
             auto pDbValue = db_util::MakeEmptyValue<ValueType>();
+            counters.dbReads.fetch_add(1, std::memory_order_relaxed);
             if (pDbAccess->GetData(PREFIX_TYPE, key, *pDbValue)) {
                 auto newRet = mapData.emplace(key, *pDbValue);
                 if (!newRet.second)
@@ -576,7 +585,8 @@ private:
         return mapData.end();
     }
 
-    bool GetTopNElements(const uint32_t maxNum, set<KeyType> &expiredKeys, set<KeyType> &keys) {
+    bool GetTopNElements(const uint32_t maxNum, set<KeyType> &expiredKeys, set<KeyType> &keys,
+                         const TopNFunc &dbTopNFunc) {
         if (!mapData.empty()) {
             uint32_t count = 0;
             auto iter      = mapData.begin();
@@ -597,7 +607,9 @@ private:
         }
 
         if (pBase != nullptr) {
-            return pBase->GetTopNElements(maxNum, expiredKeys, keys);
+            return pBase->GetTopNElements(maxNum, expiredKeys, keys, dbTopNFunc);
+        } else if (dbTopNFunc) {
+            return dbTopNFunc(maxNum, expiredKeys, keys);
         } else if (pDbAccess != nullptr) {
             return pDbAccess->GetTopNElements(maxNum, PREFIX_TYPE, expiredKeys, keys);
         }
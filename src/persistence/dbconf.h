@@ -7,6 +7,7 @@
 #define PERSIST_DBCONF_H
 
 #include <leveldb/slice.h>
+#include <cstring>
 #include <string>
 
 #include "config/version.h"
@@ -32,6 +33,7 @@ typedef leveldb::Slice Slice;
     DEFINE( DEX,                "dexes",          (50 << 20) )      /* dex */ \
     DEFINE( LOG,                "logs",           (100 << 10) )     /* log */ \
     DEFINE( RECEIPT,            "receipts",       (100 << 10) )     /* tx receipt */ \
+    DEFINE( ADDRTX,             "addrtxs",        (1  << 20) )      /* address tx index */ \
     /*                                                                  */  \
     /* Add new Enum elements above, DB_NAME_COUNT Must be the last one */ \
     DEFINE( DB_NAME_COUNT,        "",               0)                  /* enum count, must be the last one */
@@ -118,6 +120,9 @@ namespace dbk {
         DEFINE( TX_EXECUTE_FAIL,      "txef",   LOG )           /* [prefix]{height}{txid} --> {error code, error message} */ \
         /**** tx receipt db                                                                    */ \
         DEFINE( TX_RECEIPT,           "txrc",   RECEIPT )       /* [prefix]{txid} --> {receipts} */ \
+        /**** address tx index db                                                             */ \
+        DEFINE( ADDR_TX_INDEX,        "atix",   ADDRTX )        /* [prefix]{$KeyId}{height}{index} --> txid */ \
+        DEFINE( ADDR_TX_BACKFILL,     "atbf",   ADDRTX )        /* [prefix] --> {next_height, end_height} */ \
         /*                                                                             */ \
         /* Add new Enum elements above, PREFIX_COUNT Must be the last one              */ \
         DEFINE( PREFIX_COUNT,         "",       DB_NAME_NONE)   /* enum count, must be the last one */
@@ -161,14 +166,111 @@ namespace dbk {
         return EMPTY;
     };
 
+    // Serializes a db key into a buffer on the stack, into a string only if the key is larger, which
+    // saves the allocations and the copies of a CDataStream for the keys of every db read
+    class CDBKeyBuffer {
+    public:
+        enum { INLINE_CAPACITY = 128 };
+
+        int nType;
+        int nVersion;
+
+        CDBKeyBuffer(int nTypeIn = SER_DISK, int nVersionIn = CLIENT_VERSION)
+            : nType(nTypeIn), nVersion(nVersionIn) {}
+
+        CDBKeyBuffer(const CDBKeyBuffer &) = delete;
+        CDBKeyBuffer &operator=(const CDBKeyBuffer &) = delete;
+
+        CDBKeyBuffer &write(const char *pch, size_t size) {
+            if (!onHeap && nSize + size > INLINE_CAPACITY) {
+                heapData.reserve(nSize + size);
+                heapData.assign(inlineData, nSize);
+                onHeap = true;
+            }
+            if (onHeap)
+                heapData.append(pch, size);
+            else
+                memcpy(inlineData + nSize, pch, size);
+            nSize += size;
+            return *this;
+        }
+
+        template<typename T>
+        CDBKeyBuffer &operator<<(const T &obj) {
+            ::Serialize(*this, obj, nType, nVersion);
+            return *this;
+        }
+
+        int GetType() const { return nType; }
+        int GetVersion() const { return nVersion; }
+
+        const char *data() const { return onHeap ? heapData.data() : inlineData; }
+        size_t size() const { return nSize; }
+        Slice GetSlice() const { return Slice(data(), nSize); }
+        std::string str() const { return std::string(data(), nSize); }
+
+    private:
+        char inlineData[INLINE_CAPACITY];
+        size_t nSize = 0;
+        bool onHeap  = false;
+        std::string heapData;
+    };
+
+    // Deserializes a db key in place from the memory of a leveldb slice, which must outlive the reader
+    class CDBKeyReader {
+    public:
+        int nType;
+        int nVersion;
+
+        CDBKeyReader(const Slice &slice, int nTypeIn = SER_DISK, int nVersionIn = CLIENT_VERSION)
+            : nType(nTypeIn), nVersion(nVersionIn), pCur(slice.data()), pEnd(slice.data() + slice.size()) {}
+
+        CDBKeyReader &read(char *pch, size_t size) {
+            if (size > (size_t)(pEnd - pCur))
+                throw std::ios_base::failure("CDBKeyReader::read() : end of data");
+            memcpy(pch, pCur, size);
+            pCur += size;
+            return *this;
+        }
+
+        CDBKeyReader &ignore(size_t size) {
+            if (size > (size_t)(pEnd - pCur))
+                throw std::ios_base::failure("CDBKeyReader::ignore() : end of data");
+            pCur += size;
+            return *this;
+        }
+
+        template<typename T>
+        CDBKeyReader &operator>>(T &obj) {
+            ::Unserialize(*this, obj, nType, nVersion);
+            return *this;
+        }
+
+        int GetType() const { return nType; }
+        int GetVersion() const { return nVersion; }
+
+        // the unread size
+        size_t size() const { return pEnd - pCur; }
+        bool empty() const { return pCur == pEnd; }
+
+    private:
+        const char *pCur;
+        const char *pEnd;
+    };
+
     template<typename KeyElement>
-    std::string GenDbKey(PrefixType keyPrefixType, const KeyElement &keyElement) {
-        CDataStream ssKeyTemp(SER_DISK, CLIENT_VERSION);
+    void GenDbKey(PrefixType keyPrefixType, const KeyElement &keyElement, CDBKeyBuffer &keyBuf) {
         assert(keyPrefixType != EMPTY);
         const string &prefix = GetKeyPrefix(keyPrefixType);
-        ssKeyTemp.write(prefix.c_str(), prefix.size()); // write buffer only, exclude size prefix
-        ssKeyTemp << keyElement;
-        return std::string(ssKeyTemp.begin(), ssKeyTemp.end());
+        keyBuf.write(prefix.c_str(), prefix.size()); // write buffer only, exclude size prefix
+        keyBuf << keyElement;
+    }
+
+    template<typename KeyElement>
+    std::string GenDbKey(PrefixType keyPrefixType, const KeyElement &keyElement) {
+        CDBKeyBuffer keyBuf;
+        GenDbKey(keyPrefixType, keyElement, keyBuf);
+        return keyBuf.str();
     }
 
     template<typename KeyElement>
@@ -179,9 +281,9 @@ namespace dbk {
             return false;
         }
 
-        CDataStream ssKeyTemp(slice.data(), slice.data() + slice.size(), SER_DISK, CLIENT_VERSION);
-        ssKeyTemp.ignore(prefix.size());
-        ssKeyTemp >> keyElement;
+        CDBKeyReader keyReader(slice);
+        keyReader.ignore(prefix.size());
+        keyReader >> keyElement;
 
         return true;
     }
@@ -218,11 +320,13 @@ namespace dbk {
             return key.size();
         }
 
-        void Serialize(CDataStream &s, int nType, int nVersion) const {
+        template<typename Stream>
+        void Serialize(Stream &s, int nType, int nVersion) const {
             s.write(key.data(), key.size());
         }
 
-        void Unserialize(CDataStream &s, int nType, int nVersion) {
+        template<typename Stream>
+        void Unserialize(Stream &s, int nType, int nVersion) {
             if (s.size() > MAX_KEY_SIZE) {
                 throw ios_base::failure("CDBTailKey::Unserialize size excceded max size");
             }
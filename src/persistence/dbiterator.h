@@ -30,6 +30,10 @@ public:
 
     virtual bool SeekUpper(const KeyType *pKey) = 0;
 
+    // seek the last key < *pKey, or <= *pKey if inclusive, the last key if pKey is null or empty.
+    // Next() may follow, it seeks the key upper than the current one
+    virtual bool SeekLower(const KeyType *pKey, bool inclusive = false) = 0;
+
     virtual bool Next() = 0;
 
     virtual bool IsValid() const {
@@ -70,15 +74,37 @@ public:
     bool SeekUpper(const KeyType *pKey) {
         if (pKey == nullptr || db_util::IsEmpty(*pKey))
             return First();
-        string lastKeyStr = dbk::GenDbKey(CacheType::PREFIX_TYPE, *pKey);
-        p_db_it->Seek(lastKeyStr);
-        if (p_db_it->Valid() && p_db_it->key() == Slice(lastKeyStr)) {
+        dbk::CDBKeyBuffer lastKeyBuf;
+        dbk::GenDbKey(CacheType::PREFIX_TYPE, *pKey, lastKeyBuf);
+        p_db_it->Seek(lastKeyBuf.GetSlice());
+        if (p_db_it->Valid() && p_db_it->key() == lastKeyBuf.GetSlice()) {
             p_db_it->Next(); // skip the last key
         }
 
         return ProcessData();
     }
 
+    bool SeekLower(const KeyType *pKey, bool inclusive = false) {
+        dbk::CDBKeyBuffer keyBuf;
+        if (pKey == nullptr || db_util::IsEmpty(*pKey)) {
+            // the first key after all keys of the prefix type
+            string prefix = dbk::GetKeyPrefix(CacheType::PREFIX_TYPE);
+            prefix.back()++;
+            keyBuf.write(prefix.data(), prefix.size());
+            inclusive = false;
+        } else {
+            dbk::GenDbKey(CacheType::PREFIX_TYPE, *pKey, keyBuf);
+        }
+        p_db_it->Seek(keyBuf.GetSlice());
+        if (!p_db_it->Valid()) {
+            p_db_it->SeekToLast();
+        } else if (!inclusive || p_db_it->key() != keyBuf.GetSlice()) {
+            p_db_it->Prev();
+        }
+
+        return ProcessData();
+    }
+
     bool Next() {
         p_db_it->Next();
         return ProcessData();
@@ -130,6 +156,20 @@ public:
         return ProcessData();
     }
 
+    bool SeekLower(const KeyType *pKey, bool inclusive = false) {
+        auto &mapData = this->db_cache.GetMapData();
+        if (pKey == nullptr || db_util::IsEmpty(*pKey))
+            map_it = mapData.end();
+        else
+            map_it = inclusive ? mapData.upper_bound(*pKey) : mapData.lower_bound(*pKey);
+
+        if (map_it == mapData.begin())
+            map_it = mapData.end();
+        else
+            map_it--;
+        return ProcessData();
+    }
+
     bool Next() {
         assert(this->IsValid());
         map_it++;
@@ -174,6 +214,7 @@ public:
     bool First() {
         sp_map_it->First();
         sp_base_it->First();
+        is_backward = false;
         return ProcessData();
     }
 
@@ -182,9 +223,38 @@ public:
             return First();
         sp_map_it->SeekUpper(pKey);
         sp_base_it->SeekUpper(pKey);
+        is_backward = false;
         return ProcessData();
     }
 
+    bool SeekLower(const KeyType *pKey, bool inclusive = false) {
+        sp_map_it->SeekLower(pKey, inclusive);
+        sp_base_it->SeekLower(pKey, inclusive);
+        is_backward = true;
+        // the larger key of both levels, the map data wins on the same key, skip the erased data
+        while (true) {
+            this->is_valid = sp_map_it->IsValid() || sp_base_it->IsValid();
+            if (!this->is_valid)
+                return false;
+
+            if (sp_map_it->IsValid() && (!sp_base_it->IsValid() || !(*sp_map_it->sp_key < *sp_base_it->sp_key))) {
+                this->sp_key   = sp_map_it->sp_key;
+                this->sp_value = sp_map_it->sp_value;
+            } else {
+                this->sp_key   = sp_base_it->sp_key;
+                this->sp_value = sp_base_it->sp_value;
+            }
+            if (!db_util::IsEmpty(*this->sp_value))
+                break;
+
+            KeyType erasedKey = *this->sp_key;
+            sp_map_it->SeekLower(&erasedKey);
+            sp_base_it->SeekLower(&erasedKey);
+        }
+        count++;
+        return true;
+    }
+
     const KeyType& GetKey() {
         assert(this->is_valid);
         return *this->sp_key;
@@ -192,6 +262,11 @@ public:
 
 
     bool Next() {
+        if (is_backward) {
+            // the levels are positioned below the current key, seek them forward from it
+            KeyType curKey = *this->sp_key;
+            return SeekUpper(&curKey);
+        }
         InternalNext();
         return ProcessData();
     }
@@ -206,6 +281,7 @@ private:
     shared_ptr<Base> sp_base_it = nullptr;
     bool is_map_data = false;
     bool is_same_key = false;
+    bool is_backward = false;
     int32_t count = 0;
 
     virtual void InternalNext() {
@@ -285,6 +361,10 @@ public:
         return sp_it_Impl->SeekUpper(pKey);
     }
 
+    virtual bool SeekLower(const KeyType *pKey, bool inclusive = false) {
+        return sp_it_Impl->SeekLower(pKey, inclusive);
+    }
+
     virtual bool Next() {
         return sp_it_Impl->Next();
     }
@@ -318,7 +398,7 @@ struct CommonPrefixMatcher {
     // 1/2: make 2 pair key object by 1 prefix
     template<typename T1, typename T2>
     static void MakeKeyByPrefix(const T1 &prefix, std::pair<T1, T2> &keyObj) {
-        keyObj = make_pair<T1, T2>(prefix, db_util::MakeEmpty<T2>());
+        keyObj = std::make_pair(prefix, db_util::MakeEmpty<T2>());
     }
 
     // 2/2: make 2 pair key object by 2 prefix, the 2nd prefix must support partial match
@@ -330,13 +410,13 @@ struct CommonPrefixMatcher {
     // 1/3: make 3 tuple key object by 1 prefix
     template<typename T1, typename T2, typename T3>
     static void MakeKeyByPrefix(const T1 &prefix, std::tuple<T1, T2, T3> &keyObj) {
-        keyObj = make_tuple<T1, T2, T3>(prefix, db_util::MakeEmpty<T2>(), db_util::MakeEmpty<T3>());
+        keyObj = std::make_tuple(prefix, db_util::MakeEmpty<T2>(), db_util::MakeEmpty<T3>());
     }
 
     // 2/3: make 3 tuple key object by 2 pair prefix
     template<typename T1, typename T2, typename T3>
     static void MakeKeyByPrefix(const std::pair<T1, T2> &prefix, std::tuple<T1, T2, T3> &keyObj) {
-        keyObj = make_tuple<T1, T2, T3>(prefix.first, prefix.second, db_util::MakeEmpty<T3>());
+        keyObj = std::make_tuple(prefix.first, prefix.second, db_util::MakeEmpty<T3>());
     }
 
     // empty prefix, will match all keys
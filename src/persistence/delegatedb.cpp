@@ -7,11 +7,73 @@
 
 #include "config/configuration.h"
 
+bool CDelegateVoteBoard::GetTopNElements(const uint32_t maxNum, set<KeyType> &expiredKeys, set<KeyType> &keys) {
+    LOCK(cs_board);
+    if (!loaded && !Load())
+        return false;
+
+    // same as CDBAccess::GetTopNElements() of the vote prefix
+    uint32_t count = 0;
+    for (auto it = voteKeys.begin(); count < maxNum && it != voteKeys.end(); ++it) {
+        if (expiredKeys.count(it->second) || keys.count(it->second))
+            continue;
+
+        keys.emplace(it->second);
+        ++count;
+    }
+
+    return true;
+}
+
+void CDelegateVoteBoard::BatchWrite(const map<KeyType, uint8_t> &mapData) {
+    LOCK(cs_board);
+    // reload from db on next use
+    if (!loaded)
+        return;
+
+    for (const auto &item : mapData) {
+        string dbKey = dbk::GenDbKey(dbk::VOTE, item.first);
+        if (db_util::IsEmpty(item.second))
+            voteKeys.erase(dbKey);
+        else
+            voteKeys[dbKey] = item.first;
+    }
+}
+
+size_t CDelegateVoteBoard::GetSize() {
+    LOCK(cs_board);
+    return voteKeys.size();
+}
+
+bool CDelegateVoteBoard::Load() {
+    int64_t nStart = GetTimeMillis();
+    map<KeyType, uint8_t> elements;
+    if (!pDbAccess->GetAllElements(dbk::VOTE, elements))
+        return ERRORMSG("%s(), load delegate votes from db failed", __func__);
+
+    voteKeys.clear();
+    for (const auto &item : elements) {
+        voteKeys.emplace(dbk::GenDbKey(dbk::VOTE, item.first), item.first);
+    }
+    loaded = true;
+
+    LogPrint(BCLog::INFO, "%s(), loaded %u delegate votes (%dms)\n", __func__, voteKeys.size(), GetTimeMillis() - nStart);
+    return true;
+}
+
 bool CDelegateDBCache::GetTopVoteDelegates(VoteDelegateVector &topVotedDelegates) {
 
     // votes{(uint64t)MAX - $votedBcoins}{$RegId} --> 1
     set<decltype(voteRegIdCache)::KeyType> topKeys;
-    voteRegIdCache.GetTopNElements(IniCfg().GetTotalDelegateNum(), topKeys);
+    if (pVoteBoard) {
+        voteRegIdCache.GetTopNElements(IniCfg().GetTotalDelegateNum(), topKeys,
+            [this](const uint32_t maxNum, set<CDelegateVoteBoard::KeyType> &expiredKeys,
+                   set<CDelegateVoteBoard::KeyType> &keys) {
+                return pVoteBoard->GetTopNElements(maxNum, expiredKeys, keys);
+            });
+    } else {
+        voteRegIdCache.GetTopNElements(IniCfg().GetTotalDelegateNum(), topKeys);
+    }
 
     // assert(regIds.size() == IniCfg().GetTotalDelegateNum());
 
@@ -123,6 +185,10 @@ bool CDelegateDBCache::GetVoterList(map<string/* CRegID */, vector<CCandidateRec
 }
 
 bool CDelegateDBCache::Flush() {
+    // the db layer, keep the vote board in step with db
+    if (pVoteBoard && voteRegIdCache.GetBasePtr() == nullptr)
+        pVoteBoard->BatchWrite(voteRegIdCache.GetMapData());
+
     voteRegIdCache.Flush();
     regId2VoteCache.Flush();
     last_vote_height_cache.Flush();
@@ -12,13 +12,45 @@
 #include "commons/serialize.h"
 #include "dbaccess.h"
 #include "dbconf.h"
+#include "sync.h"
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
 using namespace std;
 
+/**
+ * In-memory copy of the delegate vote keys persisted in db, which is kept in the order of the db
+ * iterator so that the top voted delegates are read without seeking the db.
+ * It is loaded on first use and updated when the vote cache is flushed to db, the unflushed
+ * changes of the cache layers are merged by CCompositeKVCache::GetTopNElements as before.
+ */
+class CDelegateVoteBoard {
+public:
+    // {(uint64t)MAX - $votedBcoins}{$RegId}
+    typedef std::pair<string, string> KeyType;
+
+public:
+    CDelegateVoteBoard(CDBAccess *pDbAccessIn) : pDbAccess(pDbAccessIn) {}
+
+    bool GetTopNElements(const uint32_t maxNum, set<KeyType> &expiredKeys, set<KeyType> &keys);
+    // apply the vote data which is being written to db
+    void BatchWrite(const map<KeyType, uint8_t> &mapData);
+
+    size_t GetSize();
+
+private:
+    bool Load();
+
+private:
+    CCriticalSection cs_board;
+    CDBAccess *pDbAccess;
+    bool loaded = false;
+    map<string /* db key */, KeyType> voteKeys;
+};
+
 class CDelegateDBCache {
 public:
     CDelegateDBCache() {}
@@ -27,14 +59,16 @@ public:
           regId2VoteCache(pDbAccess),
           last_vote_height_cache(pDbAccess),
           pending_delegates_cache(pDbAccess),
-          active_delegates_cache(pDbAccess) {}
+          active_delegates_cache(pDbAccess),
+          pVoteBoard(make_shared<CDelegateVoteBoard>(pDbAccess)) {}
 
     CDelegateDBCache(CDelegateDBCache *pBaseIn)
         : voteRegIdCache(pBaseIn->voteRegIdCache),
         regId2VoteCache(pBaseIn->regId2VoteCache),
         last_vote_height_cache(pBaseIn->last_vote_height_cache),
         pending_delegates_cache(pBaseIn->pending_delegates_cache),
-        active_delegates_cache(pBaseIn->active_delegates_cache) {}
+        active_delegates_cache(pBaseIn->active_delegates_cache),
+        pVoteBoard(pBaseIn->pVoteBoard) {}
 
     bool GetTopVoteDelegates(VoteDelegateVector &topVotedDelegates);
 
@@ -68,6 +102,7 @@ public:
         last_vote_height_cache.SetBase(&pBaseIn->last_vote_height_cache);
         pending_delegates_cache.SetBase(&pBaseIn->pending_delegates_cache);
         active_delegates_cache.SetBase(&pBaseIn->active_delegates_cache);
+        pVoteBoard = pBaseIn->pVoteBoard;
     }
 
     void SetDbOpLogMap(CDBOpLogMap *pDbOpLogMapIn) {
@@ -97,6 +132,8 @@ private:
     CSimpleKVCache<dbk::ACTIVE_DELEGATES, VoteDelegateVector> active_delegates_cache;
 
     vector<CRegID> delegateRegIds;
+    // shared by all the cache layers, owned by the db layer
+    shared_ptr<CDelegateVoteBoard> pVoteBoard;
 };
 
 #endif // PERSIST_DELEGATEDB_H
\ No newline at end of file
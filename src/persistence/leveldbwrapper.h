@@ -29,9 +29,9 @@ public:
     template<typename K, typename V>
     void Set(const K& keyIn, const V& valueIn){
 
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
-        ssKey << keyIn;
-        key = ssKey.str();
+        dbk::CDBKeyBuffer keyBuf;
+        keyBuf << keyIn;
+        key.assign(keyBuf.data(), keyBuf.size());
 
         CDataStream ssValue(SER_DISK, CLIENT_VERSION);
         ssValue << valueIn;
@@ -49,8 +49,8 @@ public:
     // for key-value
     template<typename K, typename V>
     void Get(K& keyOut, V& valueOut) const {
-        CDataStream ssKey(key, SER_DISK, CLIENT_VERSION);
-        ssKey >> keyOut;
+        dbk::CDBKeyReader keyReader(key);
+        keyReader >> keyOut;
 
         CDataStream ssValue(value, SER_DISK, CLIENT_VERSION);
         ssValue >> valueOut;
@@ -131,8 +131,7 @@ private:
 
 public:
     template<typename V>
-    void Write(const std::string &key, const V& value) {
-    	leveldb::Slice slKey(key);
+    void Write(const leveldb::Slice &slKey, const V& value) {
         CDataStream ssValue(SER_DISK, CLIENT_VERSION);
         ssValue.reserve(ssValue.GetSerializeSize(value));
         ssValue << value;
@@ -140,7 +139,12 @@ public:
         batch.Put(slKey, slValue);
     }
 
-    void Erase(const std::string &key) {
+    // put an already serialized value, e.g. a record copied from another db
+    void WriteRaw(const leveldb::Slice &key, const leveldb::Slice &value) {
+        batch.Put(key, value);
+    }
+
+    void Erase(const leveldb::Slice &key) {
         batch.Delete(key);
     }
 
@@ -174,9 +178,7 @@ public:
     ~CLevelDBWrapper();
 
     template<typename V>
-    bool Read(std::string key, V &value) {
-    	leveldb::Slice slKey(key);
-
+    bool Read(const leveldb::Slice &slKey, V &value) {
         string strValue;
         leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
         if (!status.ok()) {
@@ -201,8 +203,7 @@ public:
         return WriteBatch(batch, fSync);
     }
 
-    bool Exists(const std::string &key) {
-    	leveldb::Slice slKey(key);
+    bool Exists(const leveldb::Slice &slKey) {
         string strValue;
         leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
         if (!status.ok()) {
@@ -236,6 +237,21 @@ public:
     leveldb::Iterator *NewIterator() {
         return pdb->NewIterator(iteroptions);
     }
+
+    // consistent read-only view of the database, must be released by ReleaseSnapshot()
+    const leveldb::Snapshot *GetSnapshot() {
+        return pdb->GetSnapshot();
+    }
+
+    void ReleaseSnapshot(const leveldb::Snapshot *pSnapshot) {
+        pdb->ReleaseSnapshot(pSnapshot);
+    }
+
+    leveldb::Iterator *NewIterator(const leveldb::Snapshot *pSnapshot) {
+        leveldb::ReadOptions options = iteroptions;
+        options.snapshot             = pSnapshot;
+        return pdb->NewIterator(options);
+    }
     int64_t GetDbCount();
    // Object ToJsonObj();
 };
@@ -0,0 +1,580 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "snapshot.h"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include "block.h"
+#include "blockundo.h"
+#include "cachewrapper.h"
+#include "commons/messagequeue.h"
+#include "commons/util/util.h"
+#include "init.h"
+#include "logging.h"
+#include "main.h"
+
+using namespace std;
+
+/**
+ * The snapshot file is: network magic | version | chunk ... | SNAPSHOT_CHUNK_END | manifest | manifest hash,
+ * where a chunk is: type | db id | payload | Hash(payload). The block chunks come first in height order,
+ * then the chunks of each db in key order.
+ */
+enum SnapshotChunkType : uint8_t {
+    SNAPSHOT_CHUNK_END   = 0,
+    SNAPSHOT_CHUNK_BLOCK = 1,  // payload: block | has undo | block undo
+    SNAPSHOT_CHUNK_DB    = 2,  // payload: raw key/value records of a db in key order
+};
+
+static const size_t SNAPSHOT_CHUNK_SIZE     = 4 << 20;
+static const size_t SNAPSHOT_LOAD_QUEUE_LEN = 4;  // chunks queued per db while loading
+
+typedef vector<pair<string, string>> SnapshotRecords;
+
+typedef std::function<bool(uint8_t type, uint8_t dbId, const string &payload)> SnapshotChunkHandler;
+
+static uint256 ChainHash(const uint256 &chainHash, const uint256 &hash) {
+    return Hash(chainHash.begin(), chainHash.end(), hash.begin(), hash.end());
+}
+
+static void WriteChunk(CAutoFile &file, uint8_t type, uint8_t dbId, const string &payload, uint256 &chainHash) {
+    uint256 hash = Hash(payload.begin(), payload.end());
+    file << type << dbId << payload << hash;
+    chainHash = ChainHash(chainHash, hash);
+}
+
+static bool StartsWith(const string &str, const string &prefix) {
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+struct CSnapshotDbSource {
+    uint8_t dbId;
+    CLevelDBWrapper *pDb;
+    const leveldb::Snapshot *pSnapshot;
+};
+
+struct CSnapshotBlockRef {
+    uint256 blockHash;
+    uint256 prevBlockHash;
+    CDiskBlockPos blockPos;
+    CDiskBlockPos undoPos;
+};
+
+bool DumpStateSnapshot(const boost::filesystem::path &path, CStateSnapshotManifest &manifest) {
+    int64_t beginTime = GetTimeMillis();
+    manifest          = CStateSnapshotManifest();
+
+    vector<CSnapshotDbSource> sources;
+    vector<CSnapshotBlockRef> blockRefs;
+    // release the leveldb snapshots however the dump ends
+    struct CSnapshotReleaser {
+        vector<CSnapshotDbSource> &sources;
+        ~CSnapshotReleaser() {
+            for (const auto &source : sources)
+                source.pDb->ReleaseSnapshot(source.pSnapshot);
+        }
+    } releaser{sources};
+
+    {
+        LOCK(cs_main);
+        const CBlockIndex *pTip = chainActive.Tip();
+        if (pTip == nullptr)
+            return ERRORMSG("%s : no active chain", __func__);
+
+        // the dbs hold the state at the tip once the global caches are written
+        pCdMan->Flush();
+        for (CDBAccess *pDbAccess : pCdMan->GetDbAccesses()) {
+            CLevelDBWrapper &db = pDbAccess->GetLevelDB();
+            sources.push_back({(uint8_t)pDbAccess->GetDbNameType(), &db, db.GetSnapshot()});
+        }
+        sources.push_back({SNAPSHOT_BLOCK_INDEX_DB, pCdMan->pBlockIndexDb, pCdMan->pBlockIndexDb->GetSnapshot()});
+
+        manifest.height    = pTip->height;
+        manifest.blockHash = pTip->GetBlockHash();
+        pair<int32_t, uint256> finBlock;
+        if (pCdMan->pBlockCache->ReadGlobalFinBlock(finBlock)) {
+            manifest.finHeight    = finBlock.first;
+            manifest.finBlockHash = finBlock.second;
+        }
+
+        // the genesis block, then the latest blocks which connecting the next blocks reads
+        vector<const CBlockIndex *> indexes = {chainActive.Genesis()};
+        for (int32_t height = max(1, pTip->height - GetMinBlocksToKeep() + 1); height <= pTip->height; height++)
+            indexes.push_back(chainActive[height]);
+
+        for (const CBlockIndex *pIndex : indexes) {
+            uint256 prevBlockHash = pIndex->pprev ? pIndex->pprev->GetBlockHash() : uint256();
+            blockRefs.push_back({pIndex->GetBlockHash(), prevBlockHash, pIndex->GetBlockPos(), pIndex->GetUndoPos()});
+        }
+    }
+
+    boost::filesystem::path pathTmp = path;
+    pathTmp += ".new";
+    CAutoFile file(fopen(pathTmp.string().c_str(), "wb"), SER_DISK, CLIENT_VERSION);
+    if (!file)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        file << FLATDATA(SysCfg().MessageStart()) << STATE_SNAPSHOT_VERSION;
+
+        for (const auto &ref : blockRefs) {
+            CBlock block;
+            if (!ReadBlockFromDisk(ref.blockPos, block) || block.GetHash() != ref.blockHash)
+                return ERRORMSG("%s : failed to read block %s", __func__, ref.blockHash.ToString());
+
+            CBlockUndo blockUndo;
+            bool fHaveUndo = !ref.undoPos.IsNull();
+            if (fHaveUndo && !blockUndo.ReadFromDisk(ref.undoPos, ref.prevBlockHash))
+                return ERRORMSG("%s : failed to read undo data of block %s", __func__, ref.blockHash.ToString());
+
+            CDataStream ssPayload(SER_DISK, CLIENT_VERSION);
+            ssPayload << block << fHaveUndo << blockUndo;
+            WriteChunk(file, SNAPSHOT_CHUNK_BLOCK, 0, ssPayload.str(), manifest.blocksHash);
+            manifest.blockCount++;
+        }
+
+        for (const auto &source : sources) {
+            if (ShutdownRequested())
+                return ERRORMSG("%s : interrupted by shutdown", __func__);
+
+            CStateSnapshotDbInfo info;
+            info.dbId = source.dbId;
+
+            SnapshotRecords records;
+            size_t recordsSize = 0;
+            auto writeRecords  = [&]() {
+                CDataStream ssPayload(SER_DISK, CLIENT_VERSION);
+                ssPayload << records;
+                WriteChunk(file, SNAPSHOT_CHUNK_DB, info.dbId, ssPayload.str(), info.chunksHash);
+                info.records += records.size();
+                info.chunks++;
+                records.clear();
+                recordsSize = 0;
+            };
+
+            unique_ptr<leveldb::Iterator> pCursor(source.pDb->NewIterator(source.pSnapshot));
+            for (pCursor->SeekToFirst(); pCursor->Valid(); pCursor->Next()) {
+                records.emplace_back(pCursor->key().ToString(), pCursor->value().ToString());
+                recordsSize += records.back().first.size() + records.back().second.size();
+                if (recordsSize >= SNAPSHOT_CHUNK_SIZE)
+                    writeRecords();
+            }
+            if (!pCursor->status().ok())
+                return ERRORMSG("%s : failed to iterate db %u - %s", __func__, info.dbId, pCursor->status().ToString());
+            if (!records.empty())
+                writeRecords();
+
+            manifest.dbs.push_back(info);
+        }
+
+        file << (uint8_t)SNAPSHOT_CHUNK_END << manifest << manifest.GetHash();
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+    }
+
+    FileCommit(file);
+    file.fclose();
+    if (!RenameOver(pathTmp, path))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    LogPrint(BCLog::INFO, "Dumped state snapshot at block[%d]: %s with %u blocks to %s, manifest hash %s (%dms)\n",
+             manifest.height, manifest.blockHash.ToString(), manifest.blockCount, path.string(),
+             manifest.GetHash().ToString(), GetTimeMillis() - beginTime);
+    return true;
+}
+
+/**
+ * Read the chunks of the snapshot file in order and pass each one to the handler once its checksum is
+ * checked. The block and db summaries are computed from the chunks the way the manifest records them.
+ */
+static bool ReadStateSnapshot(const boost::filesystem::path &path, const SnapshotChunkHandler &handler,
+                              CStateSnapshotManifest &computed, CStateSnapshotManifest &manifest,
+                              uint256 &manifestHash) {
+    CAutoFile file(fopen(path.string().c_str(), "rb"), SER_DISK, CLIENT_VERSION);
+    if (!file)
+        return ERRORMSG("%s : Failed to open file %s", __func__, path.string());
+
+    computed = CStateSnapshotManifest();
+    try {
+        uint8_t pchMsgTmp[4];
+        uint32_t version;
+        file >> FLATDATA(pchMsgTmp) >> version;
+        if (memcmp(pchMsgTmp, SysCfg().MessageStart(), sizeof(pchMsgTmp)))
+            return ERRORMSG("%s : Invalid network magic number", __func__);
+        if (version != STATE_SNAPSHOT_VERSION)
+            return ERRORMSG("%s : Unsupported snapshot version %u", __func__, version);
+
+        while (true) {
+            uint8_t type;
+            file >> type;
+            if (type == SNAPSHOT_CHUNK_END)
+                break;
+
+            uint8_t dbId;
+            string payload;
+            uint256 hash;
+            file >> dbId >> payload >> hash;
+            if (Hash(payload.begin(), payload.end()) != hash)
+                return ERRORMSG("%s : Checksum mismatch of a chunk of db %u", __func__, dbId);
+
+            if (type == SNAPSHOT_CHUNK_BLOCK) {
+                computed.blockCount++;
+                computed.blocksHash = ChainHash(computed.blocksHash, hash);
+            } else if (type == SNAPSHOT_CHUNK_DB && dbId <= SNAPSHOT_BLOCK_INDEX_DB) {
+                if (computed.dbs.empty() || computed.dbs.back().dbId != dbId) {
+                    computed.dbs.emplace_back();
+                    computed.dbs.back().dbId = dbId;
+                }
+                CStateSnapshotDbInfo &info = computed.dbs.back();
+                CDataStream ssPayload(payload.data(), payload.data() + payload.size(), SER_DISK, CLIENT_VERSION);
+                info.records += ReadCompactSize(ssPayload);
+                info.chunks++;
+                info.chunksHash = ChainHash(info.chunksHash, hash);
+            } else {
+                return ERRORMSG("%s : Invalid chunk type %u of db %u", __func__, type, dbId);
+            }
+
+            if (!handler(type, dbId, payload))
+                return false;
+        }
+
+        file >> manifest >> manifestHash;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    return true;
+}
+
+static bool CheckManifest(const CStateSnapshotManifest &computed, const CStateSnapshotManifest &manifest,
+                          const uint256 &manifestHash, const uint256 &trustedHash) {
+    if (manifest.GetHash() != manifestHash)
+        return ERRORMSG("%s : Checksum mismatch of the manifest", __func__);
+
+    if (!trustedHash.IsNull() && manifestHash != trustedHash)
+        return ERRORMSG("%s : Manifest hash %s differs from the trusted hash %s", __func__, manifestHash.ToString(),
+                        trustedHash.ToString());
+
+    if (manifest.version != STATE_SNAPSHOT_VERSION || manifest.blockCount == 0)
+        return ERRORMSG("%s : Invalid manifest", __func__);
+
+    if (computed.blockCount != manifest.blockCount || computed.blocksHash != manifest.blocksHash)
+        return ERRORMSG("%s : The blocks do not match the manifest", __func__);
+
+    if (computed.dbs.size() != manifest.dbs.size())
+        return ERRORMSG("%s : The dbs do not match the manifest", __func__);
+
+    for (size_t i = 0; i < manifest.dbs.size(); i++) {
+        if (SerializeHash(computed.dbs[i]) != SerializeHash(manifest.dbs[i]))
+            return ERRORMSG("%s : The records of db %u do not match the manifest", __func__, manifest.dbs[i].dbId);
+    }
+
+    return true;
+}
+
+// Bulk writer of one db, the chunks are written in the order they are queued by a thread of its own
+class CSnapshotDbLoader {
+public:
+    CSnapshotDbLoader(const boost::filesystem::path &dbPath, size_t nCacheSize)
+        : db(dbPath, nCacheSize, false, true), queue(SNAPSHOT_LOAD_QUEUE_LEN),
+          worker(&CSnapshotDbLoader::Run, this) {}
+
+    ~CSnapshotDbLoader() { Finish(); }
+
+    void Push(SnapshotRecords &&records) { queue.Push(std::move(records)); }
+
+    // wait for the queued chunks to be written, false if any write failed
+    bool Finish() {
+        fDone = true;
+        if (worker.joinable())
+            worker.join();
+        return !fFailed && db.Sync();
+    }
+
+private:
+    void Run() {
+        RenameThread("coin-snapshotload");
+
+        SnapshotRecords records;
+        // everything is queued before fDone is set, so the queue is drained once it is seen
+        while (!fDone || !queue.Empty()) {
+            if (!queue.Pop(&records) || fFailed)
+                continue;
+
+            try {
+                CLevelDBBatch batch;
+                for (const auto &record : records)
+                    batch.WriteRaw(record.first, record.second);
+                db.WriteBatch(batch);
+            } catch (std::exception &e) {
+                LogPrint(BCLog::ERROR, "%s : failed to write snapshot records - %s\n", __func__, e.what());
+                fFailed = true;
+            }
+        }
+    }
+
+    CLevelDBWrapper db;
+    MsgQueue<SnapshotRecords> queue;
+    std::atomic<bool> fDone{false};
+    std::atomic<bool> fFailed{false};
+    std::thread worker;
+};
+
+/**
+ * Writes the carried blocks to new block files, then the records of the dbs. The block index and the
+ * tx index records are patched to the new block positions, and the blocks before the carried ones are
+ * kept in the index without data.
+ */
+class CStateSnapshotImporter {
+public:
+    explicit CStateSnapshotImporter(const CStateSnapshotManifest &manifestIn) : manifest(manifestIn) {
+        const boost::filesystem::path &dbDir = GetDataDir() / "blocks";
+        for (uint8_t dbId = 0; dbId < DBNameType::DB_NAME_COUNT; dbId++)
+            loaders.emplace_back(new CSnapshotDbLoader(dbDir / GetDbName((DBNameType)dbId), DBCacheSize[dbId]));
+        loaders.emplace_back(new CSnapshotDbLoader(dbDir / "index", 2 << 20 /* 2MB, as CBlockIndexDB */));
+    }
+
+    bool LoadChunk(uint8_t type, uint8_t dbId, const string &payload) {
+        if (ShutdownRequested())
+            return ERRORMSG("%s : interrupted by shutdown", __func__);
+
+        try {
+            CDataStream ssPayload(payload.data(), payload.data() + payload.size(), SER_DISK, CLIENT_VERSION);
+            if (type == SNAPSHOT_CHUNK_BLOCK)
+                return LoadBlock(ssPayload);
+
+            SnapshotRecords records;
+            ssPayload >> records;
+            if (dbId == SNAPSHOT_BLOCK_INDEX_DB)
+                PatchBlockIndexRecords(records);
+            else if (dbId == DBNameType::BLOCK)
+                PatchBlockRecords(records);
+
+            loaders[dbId]->Push(std::move(records));
+        } catch (std::exception &e) {
+            return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+        }
+        return true;
+    }
+
+    bool Finish() {
+        SnapshotRecords fileInfoRecords;
+        for (size_t nFile = 0; nFile < fileInfos.size(); nFile++) {
+            CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+            ssValue << fileInfos[nFile];
+            fileInfoRecords.emplace_back(dbk::GenDbKey(dbk::BLOCKFILE_NUM_INFO, (int32_t)nFile), ssValue.str());
+        }
+        loaders[SNAPSHOT_BLOCK_INDEX_DB]->Push(std::move(fileInfoRecords));
+
+        CDataStream ssLastFile(SER_DISK, CLIENT_VERSION);
+        ssLastFile << (int32_t)(fileInfos.size() - 1);
+        loaders[DBNameType::BLOCK]->Push({{dbk::GetKeyPrefix(dbk::LAST_BLOCKFILE), ssLastFile.str()}});
+
+        bool fLoaded = true;
+        for (auto &pLoader : loaders)
+            fLoaded = pLoader->Finish() && fLoaded;
+
+        for (size_t nFile = 0; nFile < fileInfos.size(); nFile++) {
+            CDiskBlockPos pos(nFile, 0);
+            for (FILE *file : {OpenBlockFile(pos, true), OpenUndoFile(pos, true)}) {
+                if (file) {
+                    FileCommit(file);
+                    fclose(file);
+                }
+            }
+        }
+
+        return fLoaded;
+    }
+
+    // remove the block files written by a failed load, the dbs are wiped by the next load
+    void RemoveBlockFiles() {
+        for (size_t nFile = 0; nFile < fileInfos.size(); nFile++) {
+            boost::filesystem::remove(GetDataDir() / "blocks" / strprintf("blk%05u.dat", nFile));
+            boost::filesystem::remove(GetDataDir() / "blocks" / strprintf("rev%05u.dat", nFile));
+        }
+    }
+
+private:
+    struct CBlockPosition {
+        int32_t nFile;
+        uint32_t nDataPos;
+        uint32_t nUndoPos;
+        bool fHaveUndo;
+    };
+
+    bool LoadBlock(CDataStream &ssPayload) {
+        CBlock block;
+        bool fHaveUndo;
+        CBlockUndo blockUndo;
+        ssPayload >> block >> fHaveUndo >> blockUndo;
+
+        // the block is preceded by the network magic and its size, as WriteBlockToDisk() does
+        uint32_t nBlockSize = ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION) + 8;
+        if (fileInfos.empty() || fileInfos.back().nSize + nBlockSize >= MAX_BLOCKFILE_SIZE)
+            fileInfos.emplace_back();
+        int32_t nFile        = fileInfos.size() - 1;
+        CBlockFileInfo &info = fileInfos.back();
+
+        CDiskBlockPos blockPos(nFile, info.nSize);
+        if (!WriteBlockToDisk(block, blockPos))
+            return ERRORMSG("%s : failed to write block %s", __func__, block.GetHash().ToString());
+        info.nSize += nBlockSize;
+        info.AddBlock(block.GetHeight(), block.GetTime());
+
+        CBlockPosition &position = blockPositions[block.GetHash()];
+        position.nFile           = nFile;
+        position.nDataPos        = blockPos.nPos;
+        position.nUndoPos        = 0;
+        position.fHaveUndo       = fHaveUndo;
+        if (fHaveUndo) {
+            CDiskBlockPos undoPos(nFile, info.nUndoSize);
+            if (!blockUndo.WriteToDisk(undoPos, block.GetPrevBlockHash()))
+                return ERRORMSG("%s : failed to write undo data of block %s", __func__, block.GetHash().ToString());
+            info.nUndoSize += ::GetSerializeSize(blockUndo, SER_DISK, CLIENT_VERSION) + 40;
+            position.nUndoPos = undoPos.nPos;
+        }
+
+        // same as the tx positions written by ConnectBlock()
+        CDiskTxPos txPos(blockPos, GetSizeOfCompactSize(block.vptx.size()));
+        for (const auto &pTx : block.vptx) {
+            txPositions[pTx->GetHash()] = txPos;
+            txPos.nTxOffset += ::GetSerializeSize(pTx, SER_DISK, CLIENT_VERSION);
+        }
+        return true;
+    }
+
+    void PatchBlockIndexRecords(SnapshotRecords &records) {
+        const string &indexPrefix    = dbk::GetKeyPrefix(dbk::BLOCK_INDEX);
+        const string &fileInfoPrefix = dbk::GetKeyPrefix(dbk::BLOCKFILE_NUM_INFO);
+
+        auto itOut = records.begin();
+        for (auto &record : records) {
+            // the infos of the old block files are replaced by the ones of the new files
+            if (StartsWith(record.first, fileInfoPrefix))
+                continue;
+
+            if (StartsWith(record.first, indexPrefix)) {
+                CDataStream ssValue(record.second.data(), record.second.data() + record.second.size(), SER_DISK,
+                                    CLIENT_VERSION);
+                CDiskBlockIndex diskIndex;
+                ssValue >> diskIndex;
+
+                // the blocks of forks at or above the snapshot could never be connected without their data
+                if (diskIndex.height > manifest.height ||
+                    (diskIndex.height == manifest.height && diskIndex.GetBlockHash() != manifest.blockHash))
+                    continue;
+
+                diskIndex.nStatus &= ~BLOCK_HAVE_MASK;
+                diskIndex.nFile    = 0;
+                diskIndex.nDataPos = 0;
+                diskIndex.nUndoPos = 0;
+                auto it = blockPositions.find(diskIndex.GetBlockHash());
+                if (it != blockPositions.end()) {
+                    diskIndex.nStatus |= BLOCK_HAVE_DATA;
+                    diskIndex.nFile    = it->second.nFile;
+                    diskIndex.nDataPos = it->second.nDataPos;
+                    if (it->second.fHaveUndo) {
+                        diskIndex.nStatus |= BLOCK_HAVE_UNDO;
+                        diskIndex.nUndoPos = it->second.nUndoPos;
+                    }
+                }
+
+                CDataStream ssNewValue(SER_DISK, CLIENT_VERSION);
+                ssNewValue << diskIndex;
+                record.second = ssNewValue.str();
+            }
+
+            if (&*itOut != &record)
+                *itOut = std::move(record);
+            ++itOut;
+        }
+        records.erase(itOut, records.end());
+    }
+
+    void PatchBlockRecords(SnapshotRecords &records) {
+        const string &txIndexPrefix   = dbk::GetKeyPrefix(dbk::TXID_DISKINDEX);
+        const string &lastFileKey     = dbk::GetKeyPrefix(dbk::LAST_BLOCKFILE);
+        const string &reindexKey      = dbk::GetKeyPrefix(dbk::REINDEX);
+
+        auto itOut = records.begin();
+        for (auto &record : records) {
+            // the last block file is written by Finish()
+            if (record.first == lastFileKey || record.first == reindexKey)
+                continue;
+
+            if (StartsWith(record.first, txIndexPrefix)) {
+                // only the txs of the carried blocks can be read from disk
+                uint256 txid;
+                if (!dbk::ParseDbKey(record.first, dbk::TXID_DISKINDEX, txid))
+                    continue;
+                auto it = txPositions.find(txid);
+                if (it == txPositions.end())
+                    continue;
+
+                CDataStream ssNewValue(SER_DISK, CLIENT_VERSION);
+                ssNewValue << it->second;
+                record.second = ssNewValue.str();
+            }
+
+            if (&*itOut != &record)
+                *itOut = std::move(record);
+            ++itOut;
+        }
+        records.erase(itOut, records.end());
+    }
+
+    const CStateSnapshotManifest &manifest;
+    vector<CBlockFileInfo> fileInfos;  // by file number
+    map<uint256, CBlockPosition> blockPositions;
+    map<uint256, CDiskTxPos> txPositions;
+    vector<unique_ptr<CSnapshotDbLoader>> loaders;  // by db id
+};
+
+bool LoadStateSnapshot(const boost::filesystem::path &path, const uint256 &trustedHash,
+                       CStateSnapshotManifest &manifest) {
+    int64_t beginTime = GetTimeMillis();
+    if (trustedHash.IsNull())
+        LogPrint(BCLog::INFO, "Warning: loading state snapshot %s without -snapshothash, only its integrity is checked\n",
+                 path.string());
+
+    // verify the whole file before touching the data dir
+    CStateSnapshotManifest computed;
+    uint256 manifestHash;
+    auto verifyChunk = [](uint8_t type, uint8_t dbId, const string &payload) { return true; };
+    if (!ReadStateSnapshot(path, verifyChunk, computed, manifest, manifestHash) ||
+        !CheckManifest(computed, manifest, manifestHash, trustedHash))
+        return ERRORMSG("%s : invalid state snapshot %s", __func__, path.string());
+
+    LogPrint(BCLog::INFO, "Verified state snapshot at block[%d]: %s, finalized block[%d]: %s, manifest hash %s (%dms)\n",
+             manifest.height, manifest.blockHash.ToString(), manifest.finHeight, manifest.finBlockHash.ToString(),
+             manifestHash.ToString(), GetTimeMillis() - beginTime);
+
+    bool fLoaded = false;
+    CStateSnapshotImporter importer(manifest);
+    {
+        auto loadChunk = [&importer](uint8_t type, uint8_t dbId, const string &payload) {
+            return importer.LoadChunk(type, dbId, payload);
+        };
+        CStateSnapshotManifest reread;
+        uint256 rereadHash;
+        fLoaded = ReadStateSnapshot(path, loadChunk, computed, reread, rereadHash) && rereadHash == manifestHash;
+        fLoaded = importer.Finish() && fLoaded;
+    }
+    if (!fLoaded) {
+        importer.RemoveBlockFiles();
+        return ERRORMSG("%s : failed to load state snapshot %s", __func__, path.string());
+    }
+
+    LogPrint(BCLog::INFO, "Loaded state snapshot %s with %u blocks (%dms)\n", path.string(), manifest.blockCount,
+             GetTimeMillis() - beginTime);
+    return true;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef PERSIST_SNAPSHOT_H
+#define PERSIST_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include "commons/serialize.h"
+#include "commons/uint256.h"
+#include "crypto/hash.h"
+#include "dbconf.h"
+
+static const uint32_t STATE_SNAPSHOT_VERSION = 1;
+// the block index db has no DBNameType, it takes the id after the state dbs in a snapshot
+static const uint8_t SNAPSHOT_BLOCK_INDEX_DB = DBNameType::DB_NAME_COUNT;
+
+class CStateSnapshotDbInfo {
+public:
+    uint8_t dbId      = 0;
+    uint64_t records  = 0;
+    uint32_t chunks   = 0;
+    uint256 chunksHash;  // chained hash of the chunk hashes in file order
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(dbId);
+        READWRITE(records);
+        READWRITE(chunks);
+        READWRITE(chunksHash);
+    )
+};
+
+/**
+ * Summary of a state snapshot file, written at its end. The hash of the manifest covers every
+ * chunk of the file, so a node given a trusted manifest hash can verify the whole snapshot.
+ */
+class CStateSnapshotManifest {
+public:
+    uint32_t version   = STATE_SNAPSHOT_VERSION;
+    int32_t height     = 0;
+    uint256 blockHash;
+    int32_t finHeight  = 0;  // the PBFT globally finalized block at the time of the snapshot
+    uint256 finBlockHash;
+    uint32_t blockCount = 0;  // the latest blocks carried along, see GetMinBlocksToKeep()
+    uint256 blocksHash;
+    std::vector<CStateSnapshotDbInfo> dbs;
+
+    IMPLEMENT_SERIALIZE(
+        READWRITE(version);
+        READWRITE(height);
+        READWRITE(blockHash);
+        READWRITE(finHeight);
+        READWRITE(finBlockHash);
+        READWRITE(blockCount);
+        READWRITE(blocksHash);
+        READWRITE(dbs);
+    )
+
+    uint256 GetHash() const { return SerializeHash(*this); }
+};
+
+/**
+ * Dump every db of pCdMan and the block index db at the active tip into one file, along with the
+ * latest blocks and their undo data which connecting the next blocks reads. The dbs are read from
+ * leveldb snapshots taken under cs_main, so the node keeps running while the file is written.
+ */
+bool DumpStateSnapshot(const boost::filesystem::path &path, CStateSnapshotManifest &manifest);
+
+/**
+ * Verify the snapshot file, against trustedHash unless it is null, then bulk load it into the
+ * empty data dir: the records of each db are written in key order by a thread per db, bypassing
+ * the caches. Must run before pCdMan is created.
+ */
+bool LoadStateSnapshot(const boost::filesystem::path &path, const uint256 &trustedHash,
+                       CStateSnapshotManifest &manifest);
+
+#endif  // PERSIST_SNAPSHOT_H
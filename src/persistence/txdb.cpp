@@ -15,55 +15,187 @@
 #include <algorithm>
 
 bool CTxMemCache::AddBlockTx(const CBlock &block) {
+    auto pBucket = std::make_shared<TxidBucket>();
+    pBucket->reserve(block.vptx.size());
     for (auto &ptx : block.vptx) {
-        txids.insert(ptx->GetHash());
+        pBucket->push_back(ptx->GetHash());
     }
+    std::sort(pBucket->begin(), pBucket->end());
+
+    SetBucket(block.GetHeight(), pBucket);
     return true;
 }
 
-bool CTxMemCache::RemoveBlockTx(const CBlock &block) {
-    for (auto &ptx : block.vptx) {
-        txids.erase(ptx->GetHash());
-    }
+bool CTxMemCache::RemoveBlockTx(const CBlock &block) { return RemoveBlockTx(block.GetHeight()); }
+
+bool CTxMemCache::RemoveBlockTx(uint32_t height) {
+    SetBucket(height, nullptr);
+    // the top layer has no base to shadow, so it forgets the block entirely
+    if (pBase == nullptr)
+        buckets.erase(height);
+
     return true;
 }
 
 bool CTxMemCache::HaveTx(const uint256 &txid) {
-    bool found = txids.count(txid) > 0;
-    if (found)
+    uint32_t height;
+    return GetTxHeight(txid, height);
+}
+
+bool CTxMemCache::GetTxHeight(const uint256 &txid, uint32_t &height) const {
+    auto it = txHeights.find(txid);
+    if (it != txHeights.end()) {
+        height = it->second;
         return true;
-    else if (pBase == nullptr) {
+    }
+
+    if (pBase == nullptr || !pBase->GetTxHeight(txid, height))
         return false;
-    } else
-        return pBase->HaveTx(txid);
+
+    // the bucket of the base is shadowed if this layer has removed or replaced the block
+    return buckets.count(height) == 0;
 }
 
-void CTxMemCache::BatchWrite(const UnorderedHashSet &txidsIn) {
-    txids.clear();
+void CTxMemCache::SetBucket(uint32_t height, const TxidBucketPtr &pBucket) {
+    auto it = buckets.find(height);
+    if (it != buckets.end() && it->second) {
+        for (const auto &txid : *it->second) {
+            auto heightIt = txHeights.find(txid);
+            if (heightIt != txHeights.end() && heightIt->second == height)
+                txHeights.erase(heightIt);
+        }
+    }
 
-    for (const auto &txid : txidsIn) {
-        txids.insert(txid);
+    if (pBucket) {
+        for (const auto &txid : *pBucket) {
+            txHeights[txid] = height;
+        }
     }
+
+    buckets[height] = pBucket;
 }
 
 void CTxMemCache::Flush() {
     assert(pBase);
 
-    pBase->BatchWrite(txids);
-    txids.clear();
+    for (const auto &item : buckets) {
+        if (item.second)
+            pBase->SetBucket(item.first, item.second);
+        else
+            pBase->RemoveBlockTx(item.first);
+    }
+    Clear();
 }
 
-void CTxMemCache::Clear() { txids.clear(); }
+void CTxMemCache::Clear() {
+    buckets.clear();
+    txHeights.clear();
+}
 
-uint64_t CTxMemCache::GetSize() { return txids.size(); }
+uint64_t CTxMemCache::GetSize() { return txHeights.size(); }
 
 Object CTxMemCache::ToJsonObj() const {
     Array txArray;
-    for (auto &txid : txids) {
-        txArray.push_back(txid.ToString());
+    for (const auto &item : buckets) {
+        if (!item.second)
+            continue;
+
+        for (const auto &txid : *item.second) {
+            txArray.push_back(txid.ToString());
+        }
     }
 
     Object txCacheObj;
     txCacheObj.push_back(Pair("tx_cache", txArray));
     return txCacheObj;
 }
+
+bool CTxMemCache::Dump(const boost::filesystem::path &path, const uint256 &tipBlockHash) const {
+    map<uint32_t, vector<uint256>> bucketData;
+    for (const auto &item : buckets) {
+        if (item.second)
+            bucketData.emplace(item.first, *item.second);
+    }
+
+    // serialize buckets, checksum data up to that point, then append csum
+    CDataStream ssCache(SER_DISK, CLIENT_VERSION);
+    ssCache << FLATDATA(SysCfg().MessageStart());
+    ssCache << tipBlockHash;
+    ssCache << SysCfg().GetTxCacheHeight();
+    ssCache << bucketData;
+    uint256 hash = Hash(ssCache.begin(), ssCache.end());
+    ssCache << hash;
+
+    boost::filesystem::path pathTmp = path;
+    pathTmp += ".new";
+    FILE *file         = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout  = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!fileout)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        fileout << ssCache;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout);
+    fileout.fclose();
+
+    if (!RenameOver(pathTmp, path))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    return true;
+}
+
+bool CTxMemCache::Load(const boost::filesystem::path &path, const uint256 &tipBlockHash) {
+    if (!boost::filesystem::exists(path))
+        return false;
+
+    FILE *file       = fopen(path.string().c_str(), "rb");
+    CAutoFile filein = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!filein)
+        return ERRORMSG("%s : Failed to open file %s", __func__, path.string());
+
+    int64_t dataSize = boost::filesystem::file_size(path) - sizeof(uint256);
+    if (dataSize < 0)
+        return ERRORMSG("%s : File %s is truncated", __func__, path.string());
+
+    vector<uint8_t> vchData(dataSize);
+    uint256 hashIn;
+    try {
+        filein.read((char *)vchData.data(), dataSize);
+        filein >> hashIn;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+    filein.fclose();
+
+    CDataStream ssCache(vchData, SER_DISK, CLIENT_VERSION);
+    if (hashIn != Hash(ssCache.begin(), ssCache.end()))
+        return ERRORMSG("%s : Checksum mismatch, data corrupted", __func__);
+
+    uint8_t pchMsgTmp[4];
+    uint256 blockHash;
+    int32_t cacheHeight;
+    map<uint32_t, vector<uint256>> bucketData;
+    try {
+        ssCache >> FLATDATA(pchMsgTmp);
+        if (memcmp(pchMsgTmp, SysCfg().MessageStart(), sizeof(pchMsgTmp)))
+            return ERRORMSG("%s : Invalid network magic number", __func__);
+
+        ssCache >> blockHash >> cacheHeight;
+        // written at another tip, e.g. after a crash
+        if (blockHash != tipBlockHash || cacheHeight != SysCfg().GetTxCacheHeight())
+            return false;
+
+        ssCache >> bucketData;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    Clear();
+    for (auto &item : bucketData) {
+        SetBucket(item.first, std::make_shared<TxidBucket>(std::move(item.second)));
+    }
+    return true;
+}
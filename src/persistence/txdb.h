@@ -15,12 +15,28 @@
 #include "block.h"
 
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
+#include <boost/filesystem/path.hpp>
+
 using namespace std;
 using namespace json_spirit;
 
+static const char *const TX_CACHE_FILE_NAME = "txcache.dat";
+
+/**
+ * Txids of the recent blocks within the tx cache height, one bucket of sorted txids per block height.
+ * A block enters, leaves and is merged into the base layer as a whole bucket. A child layer holds
+ * only the buckets it changed, where a null bucket marks a block removed from the base.
+ */
 class CTxMemCache {
+public:
+    typedef std::vector<uint256> TxidBucket;
+    typedef std::shared_ptr<const TxidBucket> TxidBucketPtr;
+    typedef std::map<uint32_t, TxidBucketPtr> TxidBucketMap;
+
 public:
     CTxMemCache() : pBase(nullptr) {}
     CTxMemCache(CTxMemCache *pBaseIn) : pBase(pBaseIn) {}
@@ -30,6 +46,8 @@ public:
 
     bool AddBlockTx(const CBlock &block);
     bool RemoveBlockTx(const CBlock &block);
+    // drop the bucket of the block at height, e.g. when it falls out of the cache window
+    bool RemoveBlockTx(uint32_t height);
 
     void Clear();
     void SetBaseViewPtr(CTxMemCache *pBaseIn) { pBase = pBaseIn; }
@@ -38,13 +56,22 @@ public:
     Object ToJsonObj() const;
     uint64_t GetSize();
 
+    /**
+     * Persist the buckets of the top layer with the tip they belong to, so that the startup need not
+     * read the blocks of the cache window again. Load fails if the file does not match the tip.
+     */
+    bool Dump(const boost::filesystem::path &path, const uint256 &tipBlockHash) const;
+    bool Load(const boost::filesystem::path &path, const uint256 &tipBlockHash);
+
 private:
-    bool HaveBlock(const uint256 &blockHash) const;
-    bool HaveBlock(const CBlock &block);
-    void BatchWrite(const UnorderedHashSet &mapBlockTxHashSetIn);
+    // height of the block containing txid, as seen by this layer
+    bool GetTxHeight(const uint256 &txid, uint32_t &height) const;
+    void SetBucket(uint32_t height, const TxidBucketPtr &pBucket);
 
 private:
-    UnorderedHashSet txids;
+    TxidBucketMap buckets;
+    // txid -> height of the non-null buckets of this layer
+    std::unordered_map<uint256, uint32_t, CUint256Hasher> txHeights;
     CTxMemCache *pBase;
 };
 
@@ -86,6 +86,16 @@ private:
     HTTPRequestHandler func;
 };
 
+/** Generic task queued by EnqueueHTTPWork */
+class HTTPFuncItem final : public HTTPClosure {
+public:
+    explicit HTTPFuncItem(const std::function<void()>& _func) : func(_func) {}
+    void operator()() override { func(); }
+
+private:
+    std::function<void()> func;
+};
+
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
  */
@@ -447,6 +457,18 @@ void StartHTTPServer() {
     }
 }
 
+bool EnqueueHTTPWork(const std::function<void()>& func) {
+    if (!workQueue)
+        return false;
+
+    std::unique_ptr<HTTPFuncItem> item(new HTTPFuncItem(func));
+    if (!workQueue->Enqueue(item.get()))
+        return false;
+
+    item.release(); /* queue took ownership */
+    return true;
+}
+
 void InterruptHTTPServer() {
     LogPrint(BCLog::RPC, "Interrupting HTTP server\n");
     if (eventHTTP) {
@@ -517,12 +539,16 @@ void HTTPEvent::trigger(struct timeval* tv) {
         evtimer_add(ev, tv);  // trigger after timeval passed
 }
 
-HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req), replySent(false) {
+HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req), replySent(false), chunkedReplyStarted(false) {
 
 }
 
 HTTPRequest::~HTTPRequest() {
-    if (!replySent) {
+    if (chunkedReplyStarted && !replySent) {
+        // the status line is out already, end the reply as is
+        LogPrint(BCLog::ERROR, "%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrint(BCLog::ERROR, "%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -570,7 +596,7 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  * this cannot be done from worker threads.
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply) {
-    assert(!replySent && req);
+    assert(!replySent && !chunkedReplyStarted && req);
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
@@ -598,6 +624,59 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply) {
     req       = nullptr;  // transferred back to main thread
 }
 
+void HTTPRequest::StartChunkedReply(int nStatus) {
+    assert(!replySent && !chunkedReplyStarted && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus] {
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+    chunkedReplyStarted = true;
+}
+
+void HTTPRequest::WriteReplyChunk(const std::string& strChunk) {
+    assert(!replySent && chunkedReplyStarted && req);
+    if (strChunk.empty())
+        return;
+
+    // The chunk is copied here, the caller reuses its buffer while the main thread sends this one.
+    // Events of the same priority run in the order of activation, so chunks keep their order.
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, evb] {
+        // a no-op when the client has gone away, evhttp keeps the request until the reply is ended
+        evhttp_send_reply_chunk(req_copy, evb);
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::EndChunkedReply() {
+    assert(!replySent && chunkedReplyStarted && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy] {
+        evhttp_send_reply_end(req_copy);
+        // Re-enable reading from the socket, see WriteReply.
+        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+            if (conn) {
+                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+                if (bev) {
+                    bufferevent_enable(bev, EV_READ | EV_WRITE);
+                }
+            }
+        }
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req       = nullptr;  // transferred back to main thread
+}
+
 CService HTTPRequest::GetPeer() const {
     evhttp_connection* con = evhttp_request_get_connection(req);
     CService peer;
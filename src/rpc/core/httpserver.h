@@ -46,6 +46,11 @@ void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPR
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Queue a task on the HTTP worker threads, e.g. to spread the parts of one request over them.
+ * Returns false if the work queue is full or not running, the caller should then run the task itself.
+ */
+bool EnqueueHTTPWork(const std::function<void()>& func);
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -59,6 +64,7 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool chunkedReplyStarted;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -114,6 +120,24 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, used for bodies which are produced incrementally.
+     * Follow with any number of WriteReplyChunk calls and finish with EndChunkedReply.
+     *
+     * @note Call this instead of WriteReply, after all headers have been written.
+     */
+    void StartChunkedReply(int nStatus);
+
+    /** Write one chunk of a reply started by StartChunkedReply. */
+    void WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a chunked reply.
+     *
+     * @note Like WriteReply this gives the request back to the main thread.
+     */
+    void EndChunkedReply();
 };
 
 /** Event handler closure.
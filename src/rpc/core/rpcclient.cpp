@@ -122,6 +122,9 @@ Array RPCConvertValues(const string &strMethod, const vector<string> &strParams)
     //
     if (strMethod == "stop"                   && n > 0) ConvertTo<bool>(params[0]);
     if (strMethod == "getaddednodeinfo"       && n > 0) ConvertTo<bool>(params[0]);
+    if (strMethod == "getlockstats"           && n > 0) ConvertTo<int64_t>(params[0]);
+    if (strMethod == "setlockprofiling"       && n > 0) ConvertTo<bool>(params[0]);
+    if (strMethod == "setlockprofiling"       && n > 1) ConvertTo<bool>(params[1]);
     if (strMethod == "setgenerate"            && n > 0) ConvertTo<bool>(params[0]);
     if (strMethod == "setgenerate"            && n > 1) ConvertTo<int64_t>(params[1]);
 
@@ -165,6 +168,9 @@ Array RPCConvertValues(const string &strMethod, const vector<string> &strParams)
 
     if (strMethod == "listtx"                 && n > 0) ConvertTo<int32_t>(params[0]);
     if (strMethod == "listtx"                 && n > 1) ConvertTo<int32_t>(params[1]);
+    if (strMethod == "getaddrtxs"             && n > 1) ConvertTo<int64_t>(params[1]);
+    if (strMethod == "getaddrtxs"             && n > 2) ConvertTo<int64_t>(params[2]);
+    if (strMethod == "getaddrtxs"             && n > 3) ConvertTo<int64_t>(params[3]);
     if (strMethod == "listdelegates"          && n > 0) ConvertTo<int32_t>(params[0]);
 
     if (strMethod == "invalidateblock"        && n > 0) { if (params[0].get_str().size() < 32) ConvertTo<int32_t>(params[0]); }
@@ -187,6 +193,8 @@ Array RPCConvertValues(const string &strMethod, const vector<string> &strParams)
     if (strMethod == "getdexorders"              && n > 1) ConvertTo<int64_t>(params[1]);
     if (strMethod == "getdexorders"              && n > 2) ConvertTo<int64_t>(params[2]);
     if (strMethod == "getdexoperator"            && n > 0) ConvertTo<int64_t>(params[0]);
+    if (strMethod == "simulatedexmatch"          && n > 0) ConvertTo<Array>(params[0]);
+    if (strMethod == "simulatedexmatch"          && n > 1) ConvertTo<int64_t>(params[1]);
 
     if (strMethod == "startcommontpstest"       && n > 0)    ConvertTo<int64_t>(params[0]);
     if (strMethod == "startcommontpstest"       && n > 1)    ConvertTo<int64_t>(params[1]);
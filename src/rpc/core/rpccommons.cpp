@@ -7,6 +7,7 @@
 #include "entities/key.h"
 #include "init.h"
 #include "main.h"
+#include "persistence/blockfilereader.h"
 #include "rpcserver.h"
 #include "vm/luavm/luavmrunenv.h"
 #include "wallet/wallet.h"
@@ -274,13 +275,11 @@ Object GetTxDetailJSON(const uint256& txid) {
         if (SysCfg().IsTxIndex()) {
             CDiskTxPos postx;
             if (pCdMan->pBlockCache->ReadTxIndex(txid, postx)) {
-                CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
                 CBlockHeader header;
+                if (!blockFileReader.ReadBlockHeader(postx, header) || !blockFileReader.ReadTx(postx, pBaseTx))
+                    throw runtime_error(tfm::format("%s : read tx %s from the block file failed", __func__, txid.GetHex()));
 
                 try {
-                    file >> header;
-                    fseek(file, postx.nTxOffset, SEEK_CUR);
-                    file >> pBaseTx;
                     //obj = pBaseTx->IsMultiSignSupport()?pBaseTx->ToJsonMultiSign(*database):pBaseTx->ToJson(*pCdMan->pAccountCache);
                     obj = pBaseTx->ToJson(*pCdMan->pAccountCache);
 
@@ -13,10 +13,14 @@
 #include "main.h"
 
 #include <boost/algorithm/string.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include "wallet/wallet.h"
 #include "commons/json/json_spirit_writer_template.h"
 #include "httpserver.h"
+#include "rpcstreamwriter.h"
 #include "rpc/rpcvm.h"
 
 using namespace std;
@@ -64,6 +68,45 @@ static RPCTimerInterface* timerInterface = nullptr;
 /* Map of name to timer. */
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers;
 
+/** Counters of the executed batch requests */
+class CRPCBatchStats {
+public:
+    void Add(uint32_t batchSize, uint32_t concurrentCount, int64_t elapsedMicros) {
+        LOCK(cs);
+        batches++;
+        requests += batchSize;
+        concurrent_requests += concurrentCount;
+        total_micros += elapsedMicros;
+        max_batch_size = std::max(max_batch_size, batchSize);
+        max_micros     = std::max(max_micros, elapsedMicros);
+    }
+
+    Object ToJson() const {
+        LOCK(cs);
+        Object obj;
+        obj.push_back(Pair("batches",               batches));
+        obj.push_back(Pair("requests",              requests));
+        obj.push_back(Pair("concurrent_requests",   concurrent_requests));
+        obj.push_back(Pair("max_batch_size",        (int64_t)max_batch_size));
+        obj.push_back(Pair("avg_batch_size",        batches ? (double)requests / batches : 0.0));
+        obj.push_back(Pair("total_time_ms",         total_micros / 1000));
+        obj.push_back(Pair("avg_time_ms",           batches ? 0.001 * total_micros / batches : 0.0));
+        obj.push_back(Pair("max_time_ms",           0.001 * max_micros));
+        return obj;
+    }
+
+private:
+    mutable CCriticalSection cs;
+    int64_t batches             = 0;
+    int64_t requests            = 0;
+    int64_t concurrent_requests = 0;
+    int64_t total_micros        = 0;
+    uint32_t max_batch_size     = 0;
+    int64_t max_micros          = 0;
+};
+
+static CRPCBatchStats rpcBatchStats;
+
 //! Substitute for C++14 std::make_unique.
 template <typename T, typename... Args>
 std::unique_ptr<T> MakeUnique(Args&&... args) {
@@ -229,17 +272,48 @@ Value stop(const Array& params, bool fHelp) {
     return "coin daemon being stopped...";
 }
 
+Value getrpcbatchstats(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getrpcbatchstats\n"
+            "\nReturns the statistics of the JSON-RPC batch requests since startup.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"concurrency\" : n,           (numeric) max threads of one batch, -rpcbatchconcurrency\n"
+            "  \"batches\" : n,               (numeric) executed batches\n"
+            "  \"requests\" : n,              (numeric) requests of all batches\n"
+            "  \"concurrent_requests\" : n,   (numeric) requests executed concurrently\n"
+            "  \"max_batch_size\" : n,        (numeric) requests of the largest batch\n"
+            "  \"avg_batch_size\" : n,        (numeric) average requests of a batch\n"
+            "  \"total_time_ms\" : n,         (numeric) wall time of all batches\n"
+            "  \"avg_time_ms\" : n,           (numeric) average wall time of a batch\n"
+            "  \"max_time_ms\" : n            (numeric) wall time of the slowest batch\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getrpcbatchstats", "") + "\nAs json rpc\n" + HelpExampleRpc("getrpcbatchstats", ""));
+
+    Object obj;
+    obj.push_back(Pair("concurrency", SysCfg().GetArg("-rpcbatchconcurrency", DEFAULT_RPC_BATCH_CONCURRENCY)));
+    for (const auto& item : rpcBatchStats.ToJson())
+        obj.push_back(item);
+    return obj;
+}
+
 //
 // Call Table
 //
 
 static const CRPCCommand vRPCCommands[] =
-{ //  name                      actor (function)         okSafeMode threadSafe reqWallet
-  //  ------------------------  -----------------------  ---------- ---------- ---------
+{ //  name                      actor (function)         okSafeMode threadSafe reqWallet  okConcurrent (optional) streamActor (optional)
+  //  ------------------------  -----------------------  ---------- ---------- ---------  ----------------------- ----------------------
     /* Overall control/query calls */
     { "help",                   &help,                   true,      true,       false },
     { "getinfo",                &getinfo,                true,      false,      false }, /* uses wallet if enabled */
     { "stop",                   &stop,                   true,      true,       false },
+    { "getrpcbatchstats",       &getrpcbatchstats,       true,      true,       false },
+    { "getperfstats",           &getperfstats,           true,      true,       false },
+    { "getlockstats",           &getlockstats,           true,      true,       false },
+    { "setlockprofiling",       &setlockprofiling,       true,      true,       false },
     { "validateaddr",           &validateaddr,           true,      true,       false },
     { "createmulsig",           &createmulsig,           true,      true ,      false },
 
@@ -255,10 +329,11 @@ static const CRPCCommand vRPCCommands[] =
 
     /* Block chain and UTXO */
     { "getfcoingenesistxinfo",  &getfcoingenesistxinfo,  true,      true,       false },
-    { "getblockcount",          &getblockcount,          true,      true,       false },
-    { "getblock",               &getblock,               true,      false,      false },
-    { "getrawmempool",          &getrawmempool,          true,      false,      false },
+    { "getblockcount",          &getblockcount,          true,      true,       false,      true },
+    { "getblock",               &getblock,               true,      true,       false,      true },
+    { "getrawmempool",          &getrawmempool,          true,      false,      false,      true,       &getrawmempool_stream },
     { "verifychain",            &verifychain,            true,      false,      false },
+    { "dumpstatesnapshot",      &dumpstatesnapshot,      true,      true,       false },
 
     { "gettotalcoins",          &gettotalcoins,          true,      false,      false },
     { "invalidateblock",        &invalidateblock,        true,      true,       false },
@@ -275,9 +350,9 @@ static const CRPCCommand vRPCCommands[] =
 
     /* uses wallet if enabled */
     { "addmulsigaddr",          &addmulsigaddr,          false,     false,      true },
-    { "getaccountinfo",         &getaccountinfo,         true,      false,      true },
+    { "getaccountinfo",         &getaccountinfo,         true,      false,      true,       true },
     { "getnewaddr",             &getnewaddr,             false,     false,      true },
-    { "gettxdetail",            &gettxdetail,            true,      false,      true },
+    { "gettxdetail",            &gettxdetail,            true,      false,      true,       true },
     { "getclosedcdp",           &getclosedcdp,           true,      false,      true },
     { "getwalletinfo",          &getwalletinfo,          true,      false,      true },
 
@@ -295,11 +370,12 @@ static const CRPCCommand vRPCCommands[] =
 
     { "listaddr",               &listaddr,               true,      false,      true },
     { "listtx",                 &listtx,                 true,      false,      true },
+    { "getaddrtxs",             &getaddrtxs,             true,      false,      false,      true },
     { "setgenerate",            &setgenerate,            true,      true,       false },
     { "listcontracts",          &listcontracts,          true,      false,      true },
-    { "getcontractinfo",        &getcontractinfo,        true,      false,      true },
+    { "getcontractinfo",        &getcontractinfo,        true,      false,      true,       true },
     { "listtxcache",            &listtxcache,            true,      false,      true },
-    { "getcontractdata",        &getcontractdata,        true,      false,      true },
+    { "getcontractdata",        &getcontractdata,        true,      false,      true,       true },
     { "signmessage",            &signmessage,            false,     false,      true },
     { "verifymessage",          &verifymessage,          true,      false,      false },
     { "getcoinunitinfo",        &getcoinunitinfo,        true,      false,      false },
@@ -335,8 +411,8 @@ static const CRPCCommand vRPCCommands[] =
     { "submitcdpliquidatetx",   &submitcdpliquidatetx,   false,     false,      true },
 
     { "getscoininfo",           &getscoininfo,           true,      false,      false },
-    { "getcdp",                 &getcdp,                 true,      false,      false },
-    { "getusercdp",             &getusercdp,             true,      false,      false },
+    { "getcdp",                 &getcdp,                 true,      false,      false,      true },
+    { "getusercdp",             &getusercdp,             true,      false,      false,      true },
 
     /* for dex */
     { "submitdexbuylimitordertx",   &submitdexbuylimitordertx,   false,     false,      false },
@@ -346,22 +422,23 @@ static const CRPCCommand vRPCCommands[] =
     { "submitdexsettletx",          &submitdexsettletx,          false,     false,      false },
     { "submitdexcancelordertx",     &submitdexcancelordertx,     false,     false,      false },
 
-    { "getdexorder",                &getdexorder,                true,      false,      false },
+    { "getdexorder",                &getdexorder,                true,      false,      false,      true },
     { "getdexsysorders",            &getdexsysorders,            true,      false,      false },
     { "getdexorders",               &getdexorders,               true,      false,      false },
     { "getdexoperator",             &getdexoperator,             true,      false,      false },
     { "getdexoperatorbyowner",      &getdexoperatorbyowner,      true,      false,      false },
+    { "simulatedexmatch",           &simulatedexmatch,           true,      false,      false },
 
     /* for asset */
     { "submitassetissuetx",         &submitassetissuetx,         false,     false,      false },
     { "submitassetupdatetx",        &submitassetupdatetx,        false,     false,      false },
-    { "getasset",                   &getasset,                   true,      false,      false },
+    { "getasset",                   &getasset,                   true,      false,      false,      true },
     { "getassets",                  &getassets,                  true,      false,      false },
 
     /* for wasm */
     { "submitwasmcontractdeploytx", &submitwasmcontractdeploytx,       true,      false,      true },
     { "submitwasmcontractcalltx",   &submitwasmcontractcalltx,          true,      false,      true },
-    { "gettablewasm",               &gettablewasm,      true,      false,      true },
+    { "gettablewasm",               &gettablewasm,      true,      false,      true,       true,       &gettablewasm_stream },
     { "jsontobinwasm",              &jsontobinwasm,     true,      false,      true },
     { "bintojsonwasm",              &bintojsonwasm,     true,      false,      true },
     { "getcodewasm",                &getcodewasm,       true,      false,      true },
@@ -577,16 +654,99 @@ Object JSONRPCExecOne(const Value& req) {
     return rpc_result;
 }
 
+static bool IsConcurrentRequest(const Value& req) {
+    if (req.type() != obj_type)
+        return false;
+
+    const Value& valMethod = find_value(req.get_obj(), "method");
+    if (valMethod.type() != str_type)
+        return false;
+
+    const CRPCCommand* pcmd = tableRPC[valMethod.get_str()];
+    return pcmd && pcmd->okConcurrent;
+}
+
+/** Shared state of a run of concurrent requests [next, end) of a batch */
+struct RPCBatchRun {
+    const Array* pReq;
+    Array* pRet;
+    std::atomic<size_t> next;
+    size_t end;
+    std::atomic<size_t> remaining;
+    std::mutex cs;
+    std::condition_variable cond;
+
+    RPCBatchRun(const Array* pReqIn, Array* pRetIn, size_t beginIn, size_t endIn)
+        : pReq(pReqIn), pRet(pRetIn), next(beginIn), end(endIn), remaining(endIn - beginIn) {}
+};
+
+/**
+ * Take requests of the run until none is left. The batch arrays are only touched for a taken request,
+ * so a helper which starts after the batch has finished just returns.
+ */
+static void RunBatchRequests(const std::shared_ptr<RPCBatchRun>& run) {
+    while (true) {
+        size_t reqIdx = run->next++;
+        if (reqIdx >= run->end)
+            return;
+
+        (*run->pRet)[reqIdx] = JSONRPCExecOne((*run->pReq)[reqIdx]);
+        if (--run->remaining == 0) {
+            std::lock_guard<std::mutex> lock(run->cs);
+            run->cond.notify_all();
+        }
+    }
+}
+
+static void ExecConcurrentRequests(const Array& vReq, Array& ret, size_t begin, size_t end, int32_t concurrency) {
+    auto run = std::make_shared<RPCBatchRun>(&vReq, &ret, begin, end);
+
+    // the calling thread takes part as well, so the batch finishes even if no helper gets a worker thread
+    int32_t helpers = std::min<int64_t>(concurrency - 1, end - begin - 1);
+    for (int32_t i = 0; i < helpers; i++) {
+        if (!EnqueueHTTPWork([run]() { RunBatchRequests(run); }))
+            break;
+    }
+    RunBatchRequests(run);
+
+    // wait for the requests still running on helpers
+    std::unique_lock<std::mutex> lock(run->cs);
+    run->cond.wait(lock, [&run]() { return run->remaining == 0; });
+}
+
 string JSONRPCExecBatch(const Array& vReq) {
-    Array ret;
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
+    int64_t beginTime   = GetTimeMicros();
+    int32_t concurrency = SysCfg().GetArg("-rpcbatchconcurrency", DEFAULT_RPC_BATCH_CONCURRENCY);
+    uint32_t concurrentCount = 0;
+
+    Array ret(vReq.size());
+    size_t reqIdx = 0;
+    while (reqIdx < vReq.size()) {
+        size_t runEnd = reqIdx;
+        if (concurrency > 1) {
+            while (runEnd < vReq.size() && IsConcurrentRequest(vReq[runEnd]))
+                runEnd++;
+        }
+
+        if (runEnd - reqIdx > 1) {
+            ExecConcurrentRequests(vReq, ret, reqIdx, runEnd, concurrency);
+            concurrentCount += runEnd - reqIdx;
+            reqIdx = runEnd;
+        } else {
+            ret[reqIdx] = JSONRPCExecOne(vReq[reqIdx]);
+            reqIdx++;
+        }
+    }
+
+    int64_t elapsed = GetTimeMicros() - beginTime;
+    rpcBatchStats.Add(vReq.size(), concurrentCount, elapsed);
+    LogPrint(BCLog::RPC, "%s: batch of %u requests (%u concurrent) in %.2fms\n", __func__, vReq.size(),
+             concurrentCount, 0.001 * elapsed);
 
     return write_string(Value(ret), false) + "\n";
 }
 
-json_spirit::Value CRPCTable::execute(const string& strMethod,
-                                      const json_spirit::Array& params) const {
+const CRPCCommand* CRPCTable::checkCommand(const string& strMethod) const {
     // Find method
     const CRPCCommand* pcmd = tableRPC[strMethod];
     if (!pcmd)
@@ -606,6 +766,13 @@ json_spirit::Value CRPCTable::execute(const string& strMethod,
             throw JSONRPCError(RPC_FORBIDDEN_BY_SAFE_MODE, "Banned RPC method by blacklist");
     }
 
+    return pcmd;
+}
+
+json_spirit::Value CRPCTable::execute(const string& strMethod,
+                                      const json_spirit::Array& params) const {
+    const CRPCCommand* pcmd = checkCommand(strMethod);
+
     try {
         // Execute
         Value result;
@@ -627,6 +794,30 @@ json_spirit::Value CRPCTable::execute(const string& strMethod,
     }
 }
 
+static void ExecuteStreamActor(const CRPCCommand* pcmd, const json_spirit::Array& params, CJsonStreamWriter& writer) {
+    if (!pcmd->streamActor || !pcmd->streamActor(params, writer))
+        writer.Write(pcmd->actor(params, false));
+}
+
+void CRPCTable::executeStream(const string& strMethod, const json_spirit::Array& params,
+                              CJsonStreamWriter& writer) const {
+    const CRPCCommand* pcmd = checkCommand(strMethod);
+
+    try {
+        if (pcmd->threadSafe)
+            ExecuteStreamActor(pcmd, params, writer);
+        else if (!pWalletMain) {
+            LOCK(cs_main);
+            ExecuteStreamActor(pcmd, params, writer);
+        } else {
+            LOCK2(cs_main, pWalletMain->cs_wallet);
+            ExecuteStreamActor(pcmd, params, writer);
+        }
+    } catch (std::exception& e) {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
+
 string HelpExampleCli(string methodname, string args) {
     return "> ./coind " + methodname + " " + args + "\n";
 }
@@ -640,6 +831,60 @@ string HelpExampleRpc(string methodname, string args) {
 
 const CRPCTable tableRPC;
 
+static bool IsStreamRequest(const JSONRequest& jreq) {
+    if (SysCfg().GetArg("-rpcstreamchunksize", DEFAULT_RPC_STREAM_CHUNK_SIZE) <= 0)
+        return false;
+
+    const CRPCCommand* pcmd = tableRPC[jreq.strMethod];
+    return pcmd && pcmd->streamActor;
+}
+
+/**
+ * Execute a singleton request with a streaming actor. The reply is sent as a chunked HTTP body
+ * once the result outgrows one chunk, smaller results are sent as a normal reply.
+ */
+static bool JSONRPCExecStream(HTTPRequest* req, const JSONRequest& jreq) {
+    bool fStarted = false;
+    auto sink = [&](const std::string& chunk) {
+        if (!fStarted) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->StartChunkedReply(HTTP_OK);
+            fStarted = true;
+        }
+        req->WriteReplyChunk(chunk);
+    };
+    uint32_t chunkSize = SysCfg().GetArg("-rpcstreamchunksize", DEFAULT_RPC_STREAM_CHUNK_SIZE);
+    CJsonStreamWriter writer(sink, chunkSize);
+
+    // same layout as JSONRPCReply()
+    writer.WriteRaw("{\"result\":");
+    try {
+        tableRPC.executeStream(jreq.strMethod, jreq.params, writer);
+    } catch (Object& objError) {
+        if (!writer.HasFlushed()) {
+            ErrorReply(req, objError, jreq.id);
+            return false;
+        }
+        // the status is sent already, end the body here and let the client fail on the truncated json
+        LogPrint(BCLog::ERROR, "%s: %s failed after %llu bytes of reply: %s\n", __func__, jreq.strMethod,
+                 writer.GetWrittenBytes(), write_string(Value(objError), false));
+        req->EndChunkedReply();
+        return false;
+    }
+    writer.WriteRaw(",\"error\":null,\"id\":" + write_string(jreq.id, false) + "}\n");
+
+    if (!writer.HasFlushed()) {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, writer.GetBuffer());
+    } else {
+        writer.Flush();
+        req->EndChunkedReply();
+        LogPrint(BCLog::RPC, "%s: streamed %llu bytes of %s reply, max buffer %llu bytes\n", __func__,
+                 writer.GetWrittenBytes(), jreq.strMethod, writer.GetMaxBufferSize());
+    }
+    return true;
+}
+
 /** json rpc handler registered to http server */
 static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
     // JSONRPC handles only POST or GET
@@ -684,6 +929,9 @@ static bool JsonRPCHandler(HTTPRequest* req, const std::string&) {
         // singleton request
         if (valRequest.type() == obj_type) {
             jreq.parse(valRequest);
+            if (IsStreamRequest(jreq))
+                return JSONRPCExecStream(req, jreq);
+
             Value result = tableRPC.execute(jreq.strMethod, jreq.params);
 
             // Send reply
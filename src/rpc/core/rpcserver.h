@@ -51,7 +51,15 @@ void RPCTypeCheck(const json_spirit::Object& o,
  */
 void RPCRunLater(const std::string& name, std::function<void()> func, int64_t nSeconds);
 
+class CJsonStreamWriter;
+
 typedef json_spirit::Value (*rpcfn_type)(const json_spirit::Array& params, bool fHelp);
+/**
+ * Streaming variant of a command for potentially large results, which writes the result
+ * into the writer instead of building a Value. Returns false without writing anything
+ * when the params are left to the regular actor, e.g. small results or bad params.
+ */
+typedef bool (*rpcstreamfn_type)(const json_spirit::Array& params, CJsonStreamWriter& writer);
 
 class CRPCCommand {
 public:
@@ -60,6 +68,8 @@ public:
     bool okSafeMode;
     bool threadSafe;
     bool reqWallet;
+    bool okConcurrent;  // read-only, may run concurrently with its neighbours in a batch
+    rpcstreamfn_type streamActor;
 };
 
 /**
@@ -82,6 +92,17 @@ public:
      * @throws an exception (json_spirit::Value) when an error happens.
      */
     json_spirit::Value execute(const string& method, const json_spirit::Array& params) const;
+
+    /**
+     * Execute a method and write the result into writer, with the streaming actor if the method has one.
+     * @throws an exception (json_spirit::Value) when an error happens, part of the result
+     *         may have been written already.
+     */
+    void executeStream(const string& method, const json_spirit::Array& params, CJsonStreamWriter& writer) const;
+
+private:
+    // find the method and check whether it may be called, throws if not
+    const CRPCCommand* checkCommand(const string& method) const;
 };
 
 extern const CRPCTable tableRPC;
@@ -141,6 +162,9 @@ extern json_spirit::Value walletpassphrasechange(const json_spirit::Array& param
 extern json_spirit::Value walletlock(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value encryptwallet(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getinfo(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value getperfstats(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value getlockstats(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value setlockprofiling(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getwalletinfo(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getnetworkinfo(const json_spirit::Array& params, bool fHelp);
 
@@ -160,8 +184,10 @@ extern json_spirit::Value getfcoingenesistxinfo(const json_spirit::Array& params
 extern json_spirit::Value getblockcount(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getdifficulty(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getrawmempool(const json_spirit::Array& params, bool fHelp);
+extern bool getrawmempool_stream(const json_spirit::Array& params, CJsonStreamWriter& writer);
 extern json_spirit::Value getblock(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value verifychain(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value dumpstatesnapshot(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getcontractregid(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value invalidateblock(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value reconsiderblock(const json_spirit::Array& params, bool fHelp);
@@ -183,6 +209,7 @@ extern json_spirit::Value getdexsysorders(const json_spirit::Array& params, bool
 extern json_spirit::Value getdexorders(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getdexoperator(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getdexoperatorbyowner(const json_spirit::Array& params, bool fHelp);
+extern json_spirit::Value simulatedexmatch(const json_spirit::Array& params, bool fHelp);
 
 extern json_spirit::Value submitcdpstaketx(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value submitcdpredeemtx(const json_spirit::Array& params, bool fHelp);
@@ -201,6 +228,7 @@ extern json_spirit::Value getassets(const json_spirit::Array& params, bool fHelp
 extern json_spirit::Value submitwasmcontractdeploytx(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value submitwasmcontractcalltx(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value gettablewasm(const json_spirit::Array& params, bool fHelp);
+extern bool gettablewasm_stream(const json_spirit::Array& params, CJsonStreamWriter& writer);
 extern json_spirit::Value jsontobinwasm(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value bintojsonwasm(const json_spirit::Array& params, bool fHelp);
 extern json_spirit::Value getcodewasm(const json_spirit::Array& params, bool fHelp);
@@ -209,6 +237,13 @@ extern json_spirit::Value gettxtrace(const json_spirit::Array& params, bool fHel
 
 json_spirit::Object JSONRPCExecOne(const json_spirit::Value& req);
 
+static const int DEFAULT_RPC_BATCH_CONCURRENCY = 4;
+
+/**
+ * Execute a batch of requests, the replies are in the order of the requests.
+ * Consecutive requests of okConcurrent commands are spread over up to -rpcbatchconcurrency
+ * HTTP worker threads, all other requests run in order on the calling thread.
+ */
 std::string JSONRPCExecBatch(const json_spirit::Array& vReq);
 
 /** Opaque base class for timers returned by NewTimerFunc.
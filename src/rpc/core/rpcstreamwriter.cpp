@@ -0,0 +1,85 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpcstreamwriter.h"
+
+#include <cassert>
+
+#include "commons/json/json_spirit_writer_template.h"
+
+void CJsonStreamWriter::BeginValue() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (!first_element.empty()) {
+        if (!first_element.back())
+            buffer += ',';
+        first_element.back() = false;
+    }
+}
+
+void CJsonStreamWriter::EndValue() {
+    if (buffer.size() > max_buffer_size)
+        max_buffer_size = buffer.size();
+    if (buffer.size() >= chunk_size)
+        Flush();
+}
+
+void CJsonStreamWriter::BeginObject() {
+    BeginValue();
+    buffer += '{';
+    first_element.push_back(true);
+}
+
+void CJsonStreamWriter::EndObject() {
+    assert(!first_element.empty() && !after_key);
+    first_element.pop_back();
+    buffer += '}';
+    EndValue();
+}
+
+void CJsonStreamWriter::BeginArray() {
+    BeginValue();
+    buffer += '[';
+    first_element.push_back(true);
+}
+
+void CJsonStreamWriter::EndArray() {
+    assert(!first_element.empty() && !after_key);
+    first_element.pop_back();
+    buffer += ']';
+    EndValue();
+}
+
+void CJsonStreamWriter::Key(const std::string &name) {
+    assert(!first_element.empty() && !after_key);
+    BeginValue();
+    buffer += '"';
+    buffer += json_spirit::add_esc_chars(name);
+    buffer += "\":";
+    after_key = true;
+}
+
+void CJsonStreamWriter::Write(const json_spirit::Value &value) {
+    BeginValue();
+    value_stream.str("");
+    json_spirit::write_stream(value, value_stream, false);
+    buffer += value_stream.str();
+    EndValue();
+}
+
+void CJsonStreamWriter::WriteRaw(const std::string &text) {
+    buffer += text;
+    EndValue();
+}
+
+void CJsonStreamWriter::Flush() {
+    if (buffer.empty())
+        return;
+
+    flushed_bytes += buffer.size();
+    sink(buffer);
+    buffer.clear();
+}
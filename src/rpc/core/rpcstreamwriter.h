@@ -0,0 +1,75 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef RPC_CORE_RPCSTREAMWRITER_H
+#define RPC_CORE_RPCSTREAMWRITER_H
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "commons/json/json_spirit_value.h"
+
+static const uint32_t DEFAULT_RPC_STREAM_CHUNK_SIZE = 64 << 10;
+
+/**
+ * Compact JSON writer which emits the text incrementally.
+ * The text is buffered and handed to the sink whenever the buffer exceeds the chunk size,
+ * so a large result never exists as a whole, neither as a json_spirit tree nor as a string.
+ * The output is byte-identical to write_string(value, false) of the equivalent Value.
+ */
+class CJsonStreamWriter {
+public:
+    typedef std::function<void(const std::string &chunk)> ChunkSink;
+
+    CJsonStreamWriter(const ChunkSink &sinkIn, uint32_t chunkSizeIn = DEFAULT_RPC_STREAM_CHUNK_SIZE)
+        : sink(sinkIn), chunk_size(chunkSizeIn) {}
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    // member name of the next value, only inside an object
+    void Key(const std::string &name);
+
+    // a complete value: an array element, or the value of the last Key()
+    void Write(const json_spirit::Value &value);
+
+    void Pair(const std::string &name, const json_spirit::Value &value) {
+        Key(name);
+        Write(value);
+    }
+
+    // pre-serialized JSON text appended as is, e.g. the trailing newline of a reply
+    void WriteRaw(const std::string &text);
+
+    // hand the buffered text to the sink
+    void Flush();
+
+    // the buffered text which has not been handed to the sink
+    std::string &GetBuffer() { return buffer; }
+
+    bool HasFlushed() const { return flushed_bytes > 0; }
+    uint64_t GetWrittenBytes() const { return flushed_bytes + buffer.size(); }
+    uint64_t GetMaxBufferSize() const { return max_buffer_size; }
+
+private:
+    void BeginValue();
+    void EndValue();
+
+    ChunkSink sink;
+    uint32_t chunk_size;
+    std::string buffer;
+    std::ostringstream value_stream;
+    // one flag per open object/array, true until the first element is written
+    std::vector<bool> first_element;
+    bool after_key           = false;
+    uint64_t flushed_bytes   = 0;
+    uint64_t max_buffer_size = 0;
+};
+
+#endif  // RPC_CORE_RPCSTREAMWRITER_H
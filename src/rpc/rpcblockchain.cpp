@@ -13,7 +13,9 @@
 #include "init.h"
 #include "commons/json/json_spirit_value.h"
 #include "main.h"
+#include "persistence/snapshot.h"
 #include "rpc/core/rpcserver.h"
+#include "rpc/core/rpcstreamwriter.h"
 #include "sync.h"
 #include "tx/merkletx.h"
 #include "tx/tx.h"
@@ -106,6 +108,17 @@ Value getfcoingenesistxinfo(const Array& params, bool fHelp) {
     return output;
 }
 
+static Object MemPoolEntryToJSON(const CTxMemPoolEntry& e) {
+    Object info;
+    info.push_back(Pair("size",         (int)e.GetTxSize()));
+    info.push_back(Pair("fees_type",    std::get<0>(e.GetFees())));
+    info.push_back(Pair("fees",         ValueFromAmount(std::get<1>(e.GetFees()))));
+    info.push_back(Pair("time",         e.GetTime()));
+    info.push_back(Pair("height",       (int)e.GetHeight()));
+    info.push_back(Pair("priority",     e.GetPriority()));
+    return info;
+}
+
 Value getrawmempool(const Array& params, bool fHelp)
 {
     if (fHelp || params.size() > 1)
@@ -142,17 +155,7 @@ Value getrawmempool(const Array& params, bool fHelp)
         LOCK(mempool.cs);
         Object obj;
         for (const auto& entry : mempool.memPoolTxs) {
-            const uint256& hash      = entry.first;
-            const CTxMemPoolEntry& e = entry.second;
-            Object info;
-            info.push_back(Pair("size",         (int)e.GetTxSize()));
-            info.push_back(Pair("fees_type",    std::get<0>(e.GetFees())));
-            info.push_back(Pair("fees",         ValueFromAmount(std::get<1>(e.GetFees()))));
-            info.push_back(Pair("time",         e.GetTime()));
-            info.push_back(Pair("height",       (int)e.GetHeight()));
-            info.push_back(Pair("priority",     e.GetPriority()));
-
-            obj.push_back(Pair(hash.ToString(), info));
+            obj.push_back(Pair(entry.first.ToString(), MemPoolEntryToJSON(entry.second)));
         }
         return obj;
     } else {
@@ -168,6 +171,32 @@ Value getrawmempool(const Array& params, bool fHelp)
     }
 }
 
+bool getrawmempool_stream(const Array& params, CJsonStreamWriter& writer) {
+    // leave bad params to getrawmempool for the help message
+    if (params.size() > 1)
+        return false;
+
+    bool fVerbose = false;
+    if (params.size() > 0)
+        fVerbose = params[0].get_bool();
+
+    LOCK(mempool.cs);
+    if (fVerbose) {
+        writer.BeginObject();
+        for (const auto& entry : mempool.memPoolTxs) {
+            writer.Pair(entry.first.ToString(), MemPoolEntryToJSON(entry.second));
+        }
+        writer.EndObject();
+    } else {
+        writer.BeginArray();
+        for (const auto& entry : mempool.memPoolTxs) {
+            writer.Write(entry.first.ToString());
+        }
+        writer.EndArray();
+    }
+    return true;
+}
+
 Value getblock(const Array& params, bool fHelp) {
     if (fHelp || params.size() < 1 || params.size() > 2) {
         throw runtime_error(
@@ -207,28 +236,34 @@ Value getblock(const Array& params, bool fHelp) {
 
     // RPCTypeCheck(params, boost::assign::list_of(str_type)(bool_type)); disable this to allow either string or int argument
 
-    std::string strHash;
-    if (int_type == params[0].type()) {
-        int height = params[0].get_int();
-        if (height < 0 || height > chainActive.Height())
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
-
-        CBlockIndex* pBlockIndex = chainActive[height];
-        strHash                  = pBlockIndex->GetBlockHash().GetHex();
-    } else {
-        strHash = params[0].get_str();
-    }
-    uint256 hash(uint256S(strHash));
-
     bool fVerbose = true;
     if (params.size() > 1)
         fVerbose = params[1].get_bool();
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+    // cs_main is held for the index lookups only, the block is read and serialized without it
+    CBlockIndex* pBlockIndex = nullptr;
+    {
+        LOCK(cs_main);
+        std::string strHash;
+        if (int_type == params[0].type()) {
+            int height = params[0].get_int();
+            if (height < 0 || height > chainActive.Height())
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range.");
+
+            strHash = chainActive[height]->GetBlockHash().GetHex();
+        } else {
+            strHash = params[0].get_str();
+        }
+        uint256 hash(uint256S(strHash));
+
+        auto it = mapBlockIndex.find(hash);
+        if (it == mapBlockIndex.end())
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+        pBlockIndex = it->second;
+    }
 
     CBlock block;
-    CBlockIndex* pBlockIndex = mapBlockIndex[hash];
     if (!ReadBlockFromDisk(pBlockIndex, block)) {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
     }
@@ -240,6 +275,7 @@ Value getblock(const Array& params, bool fHelp) {
         return strHex;
     }
 
+    LOCK(cs_main);
     return BlockToJSON(block, pBlockIndex);
 }
 
@@ -267,6 +303,48 @@ Value verifychain(const Array& params, bool fHelp) {
     return VerifyDB(nCheckLevel, nCheckDepth);
 }
 
+Value dumpstatesnapshot(const Array& params, bool fHelp) {
+    if (fHelp || params.size() != 1) {
+        throw runtime_error(
+            "dumpstatesnapshot \"filename\"\n"
+            "\nDumps the state dbs at the tip, with the latest blocks, into a snapshot file to bootstrap another node\n"
+            "with -loadsnapshot=<file> -snapshothash=<manifest hash>.\n"
+            "\nArguments:\n"
+            "1.\"filename\"    (string, required) The snapshot file, relative to the data dir if not absolute\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"filename\" : \"xxx\",        (string) The full path of the snapshot file\n"
+            "  \"height\" : n,              (numeric) The height of the snapshot\n"
+            "  \"block_hash\" : \"xxx\",      (string) The tip block of the snapshot\n"
+            "  \"finalized_height\" : n,    (numeric) The PBFT globally finalized block at the time of the snapshot\n"
+            "  \"finalized_block_hash\" : \"xxx\",\n"
+            "  \"block_count\" : n,         (numeric) The number of latest blocks carried along\n"
+            "  \"manifest_hash\" : \"xxx\"    (string) The hash covering the whole snapshot, for -snapshothash\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("dumpstatesnapshot", "\"snapshot.dat\"") + "\nAs json rpc\n" +
+            HelpExampleRpc("dumpstatesnapshot", "\"snapshot.dat\""));
+    }
+
+    boost::filesystem::path path = params[0].get_str();
+    if (!path.is_complete())
+        path = GetDataDir() / path;
+
+    CStateSnapshotManifest manifest;
+    if (!DumpStateSnapshot(path, manifest))
+        throw JSONRPCError(RPC_MISC_ERROR, "Failed to dump the state snapshot, see the log for details");
+
+    Object obj;
+    obj.push_back(Pair("filename",              path.string()));
+    obj.push_back(Pair("height",                manifest.height));
+    obj.push_back(Pair("block_hash",            manifest.blockHash.GetHex()));
+    obj.push_back(Pair("finalized_height",      manifest.finHeight));
+    obj.push_back(Pair("finalized_block_hash",  manifest.finBlockHash.GetHex()));
+    obj.push_back(Pair("block_count",           (int64_t)manifest.blockCount));
+    obj.push_back(Pair("manifest_hash",         manifest.GetHash().GetHex()));
+    return obj;
+}
+
 Value getcontractregid(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 1) {
         throw runtime_error(
@@ -15,6 +15,7 @@
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "tx/dextx.h"
+#include "miner/dexmatcher.h"
 
 static Object DexOperatorToJson(const CAccountDBCache &accountCache, const DexOperatorDetail &dexOperator) {
     Object result;
@@ -503,4 +504,103 @@ extern Value getdexoperatorbyowner(const Array& params, bool fHelp) {
     Object obj = DexOperatorToJson(*pCdMan->pAccountCache, dexOperator);
     obj.insert(obj.begin(), Pair("id", (uint64_t)dexOrderId));
     return obj;
-}
\ No newline at end of file
+}
+static void ParseRecordedOrder(const Value &orderObj, uint256 &orderId, CDEXOrderDetail &order) {
+    orderId = RPC_PARAM::GetTxid(JSON::GetObjectFieldValue(orderObj, "order_id"), "order_id");
+
+    const string &orderSide = JSON::GetObjectFieldValue(orderObj, "order_side").get_str();
+    const string &orderType = JSON::GetObjectFieldValue(orderObj, "order_type").get_str();
+    if (orderSide != GetOrderSideName(ORDER_BUY) && orderSide != GetOrderSideName(ORDER_SELL))
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("invalid order_side=%s", orderSide));
+    if (orderType != GetOrderTypeName(ORDER_LIMIT_PRICE) && orderType != GetOrderTypeName(ORDER_MARKET_PRICE))
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("invalid order_type=%s", orderType));
+
+    order.generate_type           = USER_GEN_ORDER;
+    order.order_side              = (orderSide == GetOrderSideName(ORDER_BUY)) ? ORDER_BUY : ORDER_SELL;
+    order.order_type              = (orderType == GetOrderTypeName(ORDER_LIMIT_PRICE)) ? ORDER_LIMIT_PRICE : ORDER_MARKET_PRICE;
+    order.coin_symbol             = JSON::GetObjectFieldValue(orderObj, "coin_symbol").get_str();
+    order.asset_symbol            = JSON::GetObjectFieldValue(orderObj, "asset_symbol").get_str();
+    order.coin_amount             = JSON::GetObjectFieldValue(orderObj, "coin_amount").get_uint64();
+    order.asset_amount            = JSON::GetObjectFieldValue(orderObj, "asset_amount").get_uint64();
+    order.price                   = JSON::GetObjectFieldValue(orderObj, "price").get_uint64();
+    order.tx_cord                 = CTxCord(JSON::GetObjectFieldValue(orderObj, "tx_cord").get_str());
+    order.total_deal_coin_amount  = JSON::GetObjectFieldValue(orderObj, "total_deal_coin_amount").get_uint64();
+    order.total_deal_asset_amount = JSON::GetObjectFieldValue(orderObj, "total_deal_asset_amount").get_uint64();
+}
+
+extern Value simulatedexmatch(const Array& params, bool fHelp) {
+    if (fHelp || params.size() > 2) {
+        throw runtime_error(
+            "simulatedexmatch [\"orders\"] [max_items]\n"
+            "\nrun the built-in dex matching engine without submitting settle txs.\n"
+            "\nArguments:\n"
+            "1.\"orders\":    (array, optional) recorded orders in the format of getdexorders,"
+            " default is all active orders at the tip block\n"
+            "2.\"max_items\": (numeric, optional) max count of deal items, default is 10000\n"
+            "\nResult:\n"
+            "\"order_count\"        (numeric) count of orders loaded into the order books\n"
+            "\"book_count\"         (numeric) count of trading pairs\n"
+            "\"settle_tx_count\"    (numeric) count of settle txs needed for the deal items\n"
+            "\"load_time_us\"       (numeric) time used to load the orders, in microseconds\n"
+            "\"match_time_us\"      (numeric) time used to match the orders, in microseconds\n"
+            "\"deal_items\"         (array) the deal items\n"
+            "\nExamples:\n"
+            + HelpExampleCli("simulatedexmatch", "")
+            + "\nAs json rpc call\n"
+            + HelpExampleRpc("simulatedexmatch", "")
+        );
+    }
+
+    int64_t maxItems = MAX_SETTLE_ITEM_COUNT;
+    if (params.size() > 1) {
+        maxItems = params[1].get_int64();
+        if (maxItems <= 0)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("max_items=%d must > 0", maxItems));
+    }
+
+    CDEXMatchEngine engine;
+    engine.max_items_per_tx = CDEXMatchEngine::GetMaxItemsPerTx(
+        SysCfg().GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE),
+        SysCfg().GetArg("-dexmatchbatchsize", DEFAULT_DEX_MATCH_BATCH));
+
+    int64_t startTime = GetTimeMicros();
+    if (params.size() > 0 && params[0].type() != null_type) {
+        for (const auto &orderObj : params[0].get_array()) {
+            uint256 orderId;
+            CDEXOrderDetail order;
+            ParseRecordedOrder(orderObj, orderId, order);
+            engine.UpdateOrder(orderId, order);
+        }
+    } else {
+        LOCK(cs_main);
+        if (!engine.SyncOrders(*pCdMan->pDexCache, chainActive.Tip()))
+            throw JSONRPCError(RPC_INVALID_PARAMS, "load active orders error");
+    }
+    int64_t loadTime = GetTimeMicros();
+
+    vector<DEXDealItem> dealItems;
+    engine.Match(maxItems, dealItems);
+    int64_t matchTime = GetTimeMicros();
+
+    Array dealArray;
+    for (const auto &item : dealItems) {
+        Object itemObj;
+        itemObj.push_back(Pair("buy_order_id",      item.buyOrderId.GetHex()));
+        itemObj.push_back(Pair("sell_order_id",     item.sellOrderId.GetHex()));
+        itemObj.push_back(Pair("deal_price",        item.dealPrice));
+        itemObj.push_back(Pair("deal_coin_amount",  item.dealCoinAmount));
+        itemObj.push_back(Pair("deal_asset_amount", item.dealAssetAmount));
+        dealArray.push_back(itemObj);
+    }
+
+    uint64_t settleTxCount = (dealItems.size() + engine.max_items_per_tx - 1) / engine.max_items_per_tx;
+    Object obj;
+    obj.push_back(Pair("order_count",       (uint64_t)engine.GetOrderCount()));
+    obj.push_back(Pair("book_count",        (uint64_t)engine.GetBookCount()));
+    obj.push_back(Pair("max_items_per_tx",  (uint64_t)engine.max_items_per_tx));
+    obj.push_back(Pair("settle_tx_count",   settleTxCount));
+    obj.push_back(Pair("load_time_us",      loadTime - startTime));
+    obj.push_back(Pair("match_time_us",     matchTime - loadTime));
+    obj.push_back(Pair("deal_items",        dealArray));
+    return obj;
+}
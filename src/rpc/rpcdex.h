@@ -23,6 +23,7 @@ extern Value getdexorders(const Array& params, bool fHelp);
 extern Value getdexsysorders(const Array& params, bool fHelp);
 extern Value getdexoperator(const Array& params, bool fHelp);
 extern Value getdexoperatorbyowner(const Array& params, bool fHelp);
+extern Value simulatedexmatch(const Array& params, bool fHelp);
 
 
 #endif /* RPC_SCOIN_H_ */
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "commons/base58.h"
+#include "commons/perfstats.h"
 #include "init.h"
 #include "main.h"
 #include "net.h"
@@ -59,6 +60,15 @@ Value getcoinunitinfo(const Array& params, bool fHelp){
     return obj;
 }
 
+static Object FinalityStatsToJSON(const CPBFTFinalityStats &stats) {
+    Object obj;
+    obj.push_back(Pair("count",     (uint64_t)stats.count));
+    obj.push_back(Pair("avg_ms",    stats.count > 0 ? stats.total_ms / (int64_t)stats.count : 0));
+    obj.push_back(Pair("max_ms",    stats.max_ms));
+    obj.push_back(Pair("last_ms",   stats.last_ms));
+    return obj;
+}
+
 Value getinfo(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 0)
         throw runtime_error(
@@ -93,6 +103,9 @@ Value getinfo(const Array& params, bool fHelp) {
             "  \"tipblock_hash\": \"xxxxx\",    (string) the tip block hash\n"
             "  \"tipblock_height\": xxxxx ,     (numeric) the number of blocks contained the most work in the network\n"
             "  \"synblock_height\": xxxxx ,     (numeric) the block height of the loggest chain found in the network\n"
+            "  \"local_finality_delay\": {...}, (object) count, avg_ms, max_ms and last_ms of the delay from block arrival to local finality\n"
+            "  \"finality_delay\": {...},       (object) count, avg_ms, max_ms and last_ms of the delay from block arrival to global finality\n"
+            "  \"pubkey_cache\": {...},         (object) hits, misses and size of the parsed public key cache\n"
             "  \"connections\": xxxxx,          (numeric) the number of connections\n"
             "  \"errors\": \"xxxxx\"            (string) any error messages\n"
             "}\n"
@@ -141,12 +154,306 @@ Value getinfo(const Array& params, bool fHelp) {
     obj.push_back(Pair("local_finblock_height",  localFinIndex->height)) ;
     obj.push_back(Pair("local_finblock_hash",    localFinIndex->GetBlockHash().GetHex())) ;
 
+    CPBFTFinalityStats localFinStats, globalFinStats;
+    pbftMan.GetFinalityStats(localFinStats, globalFinStats);
+    obj.push_back(Pair("local_finality_delay",  FinalityStatsToJSON(localFinStats)));
+    obj.push_back(Pair("finality_delay",        FinalityStatsToJSON(globalFinStats)));
+
+    Object pubKeyCacheObj;
+    pubKeyCacheObj.push_back(Pair("hits",       pubKeyCache.GetHits()));
+    pubKeyCacheObj.push_back(Pair("misses",     pubKeyCache.GetMisses()));
+    pubKeyCacheObj.push_back(Pair("size",       (uint64_t)pubKeyCache.GetSize()));
+    obj.push_back(Pair("pubkey_cache",          pubKeyCacheObj));
+
     obj.push_back(Pair("connections",           (int32_t)vNodes.size()));
     obj.push_back(Pair("errors",                GetWarnings("statusbar")));
 
     return obj;
 }
 
+static Object PerfHistogramToJSON(const CPerfHistogram &histogram) {
+    Object obj;
+    uint64_t count = histogram.GetCount();
+    obj.push_back(Pair("count",     count));
+    obj.push_back(Pair("avg_us",    count > 0 ? histogram.GetSumMicros() / count : 0));
+    obj.push_back(Pair("p50_us",    histogram.GetPercentileMicros(0.50)));
+    obj.push_back(Pair("p99_us",    histogram.GetPercentileMicros(0.99)));
+    obj.push_back(Pair("max_us",    histogram.GetMaxMicros()));
+    return obj;
+}
+
+static void WritePrometheusHistogram(string &out, const string &name, const string &labels,
+                                     const CPerfHistogram &histogram) {
+    string prefix = labels.empty() ? "" : labels + ",";
+    uint64_t cumulative = 0;
+    for (uint32_t i = 0; i < CPerfHistogram::BUCKET_COUNT; i++) {
+        cumulative += histogram.GetBucket(i);
+        uint64_t bound = CPerfHistogram::GetBucketBound(i);
+        out += strprintf("%s_bucket{%sle=\"%s\"} %u\n", name, prefix, bound > 0 ? std::to_string(bound) : "+Inf",
+                         cumulative);
+    }
+    string braces = labels.empty() ? "" : "{" + labels + "}";
+    out += strprintf("%s_sum%s %u\n", name, braces, histogram.GetSumMicros());
+    out += strprintf("%s_count%s %u\n", name, braces, histogram.GetCount());
+}
+
+static string PerfStatsToPrometheus() {
+    string out;
+    auto WriteHistogramType = [&](const string &name, const string &help) {
+        out += "# HELP " + name + " " + help + "\n";
+        out += "# TYPE " + name + " histogram\n";
+    };
+
+    auto WriteTxHistograms = [&](const string &name, const CPerfHistogram *histograms) {
+        for (uint32_t txType = 0; txType < CPerfStats::TX_TYPE_COUNT; txType++) {
+            if (histograms[txType].GetCount() > 0)
+                WritePrometheusHistogram(out, name, strprintf("tx_type=\"%s\"", GetTxTypeName((TxType)txType)),
+                                         histograms[txType]);
+        }
+    };
+    WriteHistogramType("coin_tx_check_microseconds", "Latency of CheckTx() by tx type");
+    WriteTxHistograms("coin_tx_check_microseconds", perfStats.txCheck);
+    WriteHistogramType("coin_tx_execute_microseconds", "Latency of ExecuteTx() by tx type");
+    WriteTxHistograms("coin_tx_execute_microseconds", perfStats.txExecute);
+
+    out += "# HELP coin_cache_lookups_total Lookups of the db caches by key prefix, at every cache level\n";
+    out += "# TYPE coin_cache_lookups_total counter\n";
+    for (uint32_t prefix = 0; prefix < dbk::PREFIX_COUNT; prefix++) {
+        const CPerfCacheCounters &counters = perfStats.cache[prefix];
+        if (counters.hits == 0 && counters.misses == 0)
+            continue;
+        const string &name = dbk::GetKeyPrefix((dbk::PrefixType)prefix);
+        out += strprintf("coin_cache_lookups_total{prefix=\"%s\",result=\"hit\"} %u\n", name, counters.hits.load());
+        out += strprintf("coin_cache_lookups_total{prefix=\"%s\",result=\"miss\"} %u\n", name, counters.misses.load());
+    }
+    out += "# HELP coin_cache_db_reads_total Db reads of the db caches by key prefix\n";
+    out += "# TYPE coin_cache_db_reads_total counter\n";
+    for (uint32_t prefix = 0; prefix < dbk::PREFIX_COUNT; prefix++) {
+        const CPerfCacheCounters &counters = perfStats.cache[prefix];
+        if (counters.dbReads > 0)
+            out += strprintf("coin_cache_db_reads_total{prefix=\"%s\"} %u\n", dbk::GetKeyPrefix((dbk::PrefixType)prefix),
+                             counters.dbReads.load());
+    }
+
+    WriteHistogramType("coin_block_connect_microseconds", "Latency of the block connect phases");
+    const vector<pair<string, const CPerfHistogram *> > blockHistograms = {
+        {"check",       &perfStats.blockCheck},
+        {"execute",     &perfStats.blockExecute},
+        {"undo_write",  &perfStats.blockUndoWrite},
+        {"flush",       &perfStats.blockFlush},
+        {"total",       &perfStats.blockConnect}};
+    for (const auto &item : blockHistograms)
+        WritePrometheusHistogram(out, "coin_block_connect_microseconds", strprintf("phase=\"%s\"", item.first), *item.second);
+
+    WriteHistogramType("coin_mempool_accept_microseconds", "Latency of accepting a tx to the mempool");
+    WritePrometheusHistogram(out, "coin_mempool_accept_microseconds", "", perfStats.mempoolAccept);
+    WriteHistogramType("coin_miner_pack_microseconds", "Time of packing the txs of a new block");
+    WritePrometheusHistogram(out, "coin_miner_pack_microseconds", "", perfStats.minerPack);
+
+    out += "# HELP coin_wasm_allocators_acquired_total Linear memory allocators handed out to the wasm contexts\n";
+    out += "# TYPE coin_wasm_allocators_acquired_total counter\n";
+    out += strprintf("coin_wasm_allocators_acquired_total %u\n", perfStats.wasmAllocPool.acquired.load());
+    out += "# HELP coin_wasm_allocators_reused_total Linear memory allocators taken from the pool\n";
+    out += "# TYPE coin_wasm_allocators_reused_total counter\n";
+    out += strprintf("coin_wasm_allocators_reused_total %u\n", perfStats.wasmAllocPool.reused.load());
+    out += "# HELP coin_wasm_allocators_idle Linear memory allocators in the pool\n";
+    out += "# TYPE coin_wasm_allocators_idle gauge\n";
+    out += strprintf("coin_wasm_allocators_idle %u\n", perfStats.wasmAllocPool.idle.load());
+
+    WriteHistogramType("coin_net_message_microseconds", "Processing time of the p2p messages by command");
+    for (const auto &item : perfStats.GetNetMessages())
+        WritePrometheusHistogram(out, "coin_net_message_microseconds", strprintf("command=\"%s\"", item.first), *item.second);
+
+    return out;
+}
+
+Value getperfstats(const Array& params, bool fHelp) {
+    if (fHelp || params.size() > 1)
+        throw runtime_error(
+            "getperfstats ( \"format\" )\n"
+            "\nReturns the performance counters of the node since startup, the latencies are in microseconds.\n"
+            "\nArguments:\n"
+            "1. \"format\"      (string, optional, default=json) json, or prometheus for a text dump in the Prometheus format\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"tx\" : {                 (object) CheckTx() and ExecuteTx() by tx type\n"
+            "    \"tx_type\" : { \"check\" : {...}, \"execute\" : {...} }\n"
+            "  },\n"
+            "  \"cache\" : {              (object) db cache lookups by key prefix, at every cache level\n"
+            "    \"prefix\" : { \"hits\" : n, \"misses\" : n, \"db_reads\" : n }\n"
+            "  },\n"
+            "  \"block_connect\" : {      (object) phases of connecting a block: check, execute, undo_write, flush, total\n"
+            "  },\n"
+            "  \"mempool_accept\" : {...},\n"
+            "  \"miner_pack\" : {...},\n"
+            "  \"wasm_allocator_pool\" : {  (object) the linear memory allocators of the wasm contexts\n"
+            "    \"acquired\" : n, \"reused\" : n, \"hit_rate\" : x, \"idle\" : n\n"
+            "  },\n"
+            "  \"net_messages\" : {       (object) processing time of the p2p messages by command\n"
+            "  }\n"
+            "}\n"
+            "where each latency is { \"count\" : n, \"avg_us\" : n, \"p50_us\" : n, \"p99_us\" : n, \"max_us\" : n },\n"
+            "the percentiles are the upper bounds of power of 2 buckets.\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getperfstats", "") + HelpExampleCli("getperfstats", "\"prometheus\"") +
+            "\nAs json rpc\n" + HelpExampleRpc("getperfstats", ""));
+
+    string format = params.size() > 0 ? params[0].get_str() : "json";
+    if (format == "prometheus")
+        return PerfStatsToPrometheus();
+    if (format != "json")
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid format, must be json or prometheus");
+
+    Object txObj;
+    for (uint32_t txType = 0; txType < CPerfStats::TX_TYPE_COUNT; txType++) {
+        const CPerfHistogram &check   = perfStats.txCheck[txType];
+        const CPerfHistogram &execute = perfStats.txExecute[txType];
+        if (check.GetCount() == 0 && execute.GetCount() == 0)
+            continue;
+
+        Object obj;
+        obj.push_back(Pair("check",     PerfHistogramToJSON(check)));
+        obj.push_back(Pair("execute",   PerfHistogramToJSON(execute)));
+        txObj.push_back(Pair(GetTxTypeName((TxType)txType), obj));
+    }
+
+    Object cacheObj;
+    for (uint32_t prefix = 0; prefix < dbk::PREFIX_COUNT; prefix++) {
+        const CPerfCacheCounters &counters = perfStats.cache[prefix];
+        if (counters.hits == 0 && counters.misses == 0)
+            continue;
+
+        Object obj;
+        obj.push_back(Pair("hits",      counters.hits.load()));
+        obj.push_back(Pair("misses",    counters.misses.load()));
+        obj.push_back(Pair("db_reads",  counters.dbReads.load()));
+        cacheObj.push_back(Pair(dbk::GetKeyPrefix((dbk::PrefixType)prefix), obj));
+    }
+
+    Object blockObj;
+    blockObj.push_back(Pair("check",        PerfHistogramToJSON(perfStats.blockCheck)));
+    blockObj.push_back(Pair("execute",      PerfHistogramToJSON(perfStats.blockExecute)));
+    blockObj.push_back(Pair("undo_write",   PerfHistogramToJSON(perfStats.blockUndoWrite)));
+    blockObj.push_back(Pair("flush",        PerfHistogramToJSON(perfStats.blockFlush)));
+    blockObj.push_back(Pair("total",        PerfHistogramToJSON(perfStats.blockConnect)));
+
+    const CPerfWasmAllocPool &wasmAllocPool = perfStats.wasmAllocPool;
+    uint64_t acquired = wasmAllocPool.acquired;
+    Object wasmAllocObj;
+    wasmAllocObj.push_back(Pair("acquired",     acquired));
+    wasmAllocObj.push_back(Pair("reused",       wasmAllocPool.reused.load()));
+    wasmAllocObj.push_back(Pair("hit_rate",     acquired > 0 ? (double)wasmAllocPool.reused / acquired : 0.0));
+    wasmAllocObj.push_back(Pair("idle",         wasmAllocPool.idle.load()));
+
+    Object netObj;
+    for (const auto &item : perfStats.GetNetMessages())
+        netObj.push_back(Pair(item.first, PerfHistogramToJSON(*item.second)));
+
+    Object obj;
+    obj.push_back(Pair("tx",                txObj));
+    obj.push_back(Pair("cache",             cacheObj));
+    obj.push_back(Pair("block_connect",     blockObj));
+    obj.push_back(Pair("mempool_accept",    PerfHistogramToJSON(perfStats.mempoolAccept)));
+    obj.push_back(Pair("miner_pack",        PerfHistogramToJSON(perfStats.minerPack)));
+    obj.push_back(Pair("wasm_allocator_pool", wasmAllocObj));
+    obj.push_back(Pair("net_messages",      netObj));
+    return obj;
+}
+
+Value setlockprofiling(const Array& params, bool fHelp) {
+    if (fHelp || params.size() < 1 || params.size() > 2)
+        throw runtime_error(
+            "setlockprofiling enable ( reset )\n"
+            "\nTurn the lock contention profiler on or off, see getlockstats.\n"
+            "\nArguments:\n"
+            "1. enable      (boolean, required) true to profile the LOCK/LOCK2/TRY_LOCK sections from now on\n"
+            "2. reset       (boolean, optional, default=false) clear the stats gathered so far\n"
+            "\nResult:\n"
+            "true|false     (boolean) whether the profiler was on before\n"
+            "\nExamples:\n" +
+            HelpExampleCli("setlockprofiling", "true true") +
+            "\nAs json rpc\n" + HelpExampleRpc("setlockprofiling", "true, true"));
+
+    if (params.size() > 1 && params[1].get_bool())
+        ResetLockProfile();
+
+    return fLockProfiling.exchange(params[0].get_bool());
+}
+
+Value getlockstats(const Array& params, bool fHelp) {
+    if (fHelp || params.size() > 2)
+        throw runtime_error(
+            "getlockstats ( count \"sort\" )\n"
+            "\nReturns the most contended lock acquisition sites seen by the lock contention profiler,\n"
+            "which is turned on by -lockprofiling or setlockprofiling.\n"
+            "\nArguments:\n"
+            "1. count       (numeric, optional, default=20) the number of sites to return\n"
+            "2. \"sort\"      (string, optional, default=wait) wait, hold, contentions or acquisitions\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"enabled\" : true|false,   (boolean) whether the profiler is on\n"
+            "  \"sites\" : [\n"
+            "    {\n"
+            "      \"lock\" : \"name\",        (string) the lock, e.g. cs_main\n"
+            "      \"site\" : \"file:line\",   (string) where it was acquired\n"
+            "      \"acquisitions\" : n,     (numeric) times it was acquired\n"
+            "      \"contentions\" : n,      (numeric) times it had to wait for another thread\n"
+            "      \"try_failures\" : n,     (numeric) times TRY_LOCK did not get it\n"
+            "      \"wait_us\" : n,          (numeric) total wait time of the contended acquisitions\n"
+            "      \"max_wait_us\" : n,      (numeric)\n"
+            "      \"hold_us\" : n,          (numeric) total time it was held, including the nested sections\n"
+            "      \"max_hold_us\" : n       (numeric)\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getlockstats", "") + HelpExampleCli("getlockstats", "10 \"hold\"") +
+            "\nAs json rpc\n" + HelpExampleRpc("getlockstats", "10, \"hold\""));
+
+    int64_t count = params.size() > 0 ? params[0].get_int64() : 20;
+    if (count < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid count, must be non-negative");
+
+    string sort = params.size() > 1 ? params[1].get_str() : "wait";
+    std::function<uint64_t(const CLockSiteStats &)> sortKey;
+    if (sort == "wait")
+        sortKey = [](const CLockSiteStats &stats) { return stats.waitMicros; };
+    else if (sort == "hold")
+        sortKey = [](const CLockSiteStats &stats) { return stats.holdMicros; };
+    else if (sort == "contentions")
+        sortKey = [](const CLockSiteStats &stats) { return stats.contentions; };
+    else if (sort == "acquisitions")
+        sortKey = [](const CLockSiteStats &stats) { return stats.acquisitions; };
+    else
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sort, must be wait, hold, contentions or acquisitions");
+
+    vector<CLockSiteStats> sites = GetLockProfile();
+    size_t topCount = std::min<size_t>(count, sites.size());
+    std::partial_sort(sites.begin(), sites.begin() + topCount, sites.end(),
+                      [&](const CLockSiteStats &a, const CLockSiteStats &b) { return sortKey(a) > sortKey(b); });
+
+    Array siteArray;
+    for (size_t i = 0; i < topCount; i++) {
+        const CLockSiteStats &stats = sites[i];
+        Object obj;
+        obj.push_back(Pair("lock",          stats.lockName));
+        obj.push_back(Pair("site",          strprintf("%s:%d", stats.file, stats.line)));
+        obj.push_back(Pair("acquisitions",  stats.acquisitions));
+        obj.push_back(Pair("contentions",   stats.contentions));
+        obj.push_back(Pair("try_failures",  stats.tryFailures));
+        obj.push_back(Pair("wait_us",       stats.waitMicros));
+        obj.push_back(Pair("max_wait_us",   stats.maxWaitMicros));
+        obj.push_back(Pair("hold_us",       stats.holdMicros));
+        obj.push_back(Pair("max_hold_us",   stats.maxHoldMicros));
+        siteArray.push_back(obj);
+    }
+
+    Object obj;
+    obj.push_back(Pair("enabled",   fLockProfiling.load()));
+    obj.push_back(Pair("sites",     siteArray));
+    return obj;
+}
+
 Value verifymessage(const Array& params, bool fHelp) {
     if (fHelp || params.size() != 3)
         throw runtime_error(
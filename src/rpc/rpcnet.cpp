@@ -8,6 +8,7 @@
 #include "main.h"
 #include "net.h"
 #include "netbase.h"
+#include "p2p/blockencodings.h"
 #include "p2p/protocol.h"
 #include "sync.h"
 #include "commons/util/util.h"
@@ -340,7 +341,20 @@ Value getnetworkinfo(const Array& params, bool fHelp) {
             "    \"address\": \"xxxx\",      (string) network address\n"
             "    \"port\": xxx,              (numeric) network port\n"
             "    \"score\": xxx              (numeric) relative score\n"
-            "  ]\n"
+            "  ],\n"
+            "  \"compactblocks\": {        (object) compact block relay counters\n"
+            "    \"sent\": n,                (numeric) compact blocks sent\n"
+            "    \"received\": n,            (numeric) compact blocks received\n"
+            "    \"reconstructed\": n,       (numeric) blocks rebuilt from the mempool without any round trip\n"
+            "    \"txn_round_trips\": n,     (numeric) blocks rebuilt after asking the missing txs\n"
+            "    \"fallbacks\": n,           (numeric) blocks downloaded in full since they could not be rebuilt\n"
+            "    \"txs_from_mempool\": n,    (numeric) txs of rebuilt blocks taken from the mempool\n"
+            "    \"txs_requested\": n,       (numeric) txs asked by getblocktxn\n"
+            "    \"bytes_sent\": n,          (numeric) bytes of the compact blocks sent\n"
+            "    \"bytes_saved\": n,         (numeric) bytes saved against sending the full blocks\n"
+            "    \"avg_rebuild_ms\": n,      (numeric) average time from receiving to rebuilding a block\n"
+            "    \"avg_propagation_ms\": n   (numeric) average time from the block time to rebuilding it\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("getnetworkinfo", "") + "\nAs json rpc\n" + HelpExampleRpc("getnetworkinfo", ""));
@@ -368,6 +382,21 @@ Value getnetworkinfo(const Array& params, bool fHelp) {
         }
     }
     obj.push_back(Pair("localaddresses",    localAddresses));
+
+    uint64_t rebuilt = compactBlockStats.reconstructed + compactBlockStats.txnRoundTrips;
+    Object cmpctObj;
+    cmpctObj.push_back(Pair("sent",                 compactBlockStats.sent.load()));
+    cmpctObj.push_back(Pair("received",             compactBlockStats.received.load()));
+    cmpctObj.push_back(Pair("reconstructed",        compactBlockStats.reconstructed.load()));
+    cmpctObj.push_back(Pair("txn_round_trips",      compactBlockStats.txnRoundTrips.load()));
+    cmpctObj.push_back(Pair("fallbacks",            compactBlockStats.fallbacks.load()));
+    cmpctObj.push_back(Pair("txs_from_mempool",     compactBlockStats.txsFromMempool.load()));
+    cmpctObj.push_back(Pair("txs_requested",        compactBlockStats.txsRequested.load()));
+    cmpctObj.push_back(Pair("bytes_sent",           compactBlockStats.bytesSent.load()));
+    cmpctObj.push_back(Pair("bytes_saved",          compactBlockStats.fullBytesSent - compactBlockStats.bytesSent));
+    cmpctObj.push_back(Pair("avg_rebuild_ms",       rebuilt > 0 ? compactBlockStats.rebuildTimeMillis / rebuilt : 0));
+    cmpctObj.push_back(Pair("avg_propagation_ms",   rebuilt > 0 ? compactBlockStats.propagationMillis / rebuilt : 0));
+    obj.push_back(Pair("compactblocks",     cmpctObj));
     return obj;
 }
 
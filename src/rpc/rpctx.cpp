@@ -544,6 +544,7 @@ if (fHelp || params.size() > 2) {
         nFrom = params[1].get_int();
     }
     assert(pWalletMain != nullptr);
+    pWalletMain->SyncWithBlockNotify();
 
     Array confirmedTxArray;
     int32_t nCount = 0;
@@ -679,6 +680,114 @@ Value getaccountinfo(const Array& params, bool fHelp) {
     return obj;
 }
 
+Value getaddrtxs(const Array& params, bool fHelp) {
+    if (fHelp || params.size() < 1 || params.size() > 5) {
+        throw runtime_error(
+            "getaddrtxs \"addr\" [\"begin_height\"] [\"end_height\"] [\"max_count\"] [\"last_pos_info\"]\n"
+            "\nget the confirmed transactions involving the account by block height range, requires -addrindex.\n"
+            "\nArguments:\n"
+            "1.\"addr\":            (string, required) account address or regid\n"
+            "2.\"begin_height\":    (numeric, optional) the begin block height, default is 0\n"
+            "3.\"end_height\":      (numeric, optional) the end block height, default is current tip block height\n"
+            "4.\"max_count\":       (numeric, optional) the max tx count to get, default is 500\n"
+            "5.\"last_pos_info\":   (string, optional) the last position info to get more txs, default is empty\n"
+            "\nResult:\n"
+            "\"address\"            (string) the address of the account.\n"
+            "\"begin_height\"       (numeric) the begin block height of returned txs.\n"
+            "\"end_height\"         (numeric) the end block height of returned txs.\n"
+            "\"has_more\"           (bool) has more txs in db.\n"
+            "\"last_pos_info\"      (string) the last position info to get more txs.\n"
+            "\"backfilling\"        (bool) the index of the blocks before -addrindex was enabled is being built.\n"
+            "\"count\"              (numeric) the count of returned txs.\n"
+            "\"txs\"                (array) the txid, block height and index in block of returned txs.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getaddrtxs", "\"WT52jPi8DhHUC85MPYK8y8Ajs8J7CshgaB\" 0 100 500")
+            + "\nAs json rpc call\n"
+            + HelpExampleRpc("getaddrtxs", "\"WT52jPi8DhHUC85MPYK8y8Ajs8J7CshgaB\", 0, 100, 500")
+        );
+    }
+
+    if (!SysCfg().IsAddrIndex())
+        throw JSONRPCError(RPC_INVALID_REQUEST, "Address tx index is disabled, restart with -addrindex to enable it");
+
+    auto pUserId = CUserID::ParseUserId(params[0].get_str());
+    CKeyID keyId;
+    if (!pUserId || !pCdMan->pAccountCache->GetKeyId(*pUserId, keyId))
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+
+    int64_t tipHeight = chainActive.Height();
+    int64_t beginHeight = 0;
+    if (params.size() > 1)
+        beginHeight = params[1].get_int64();
+    if (beginHeight < 0 || beginHeight > tipHeight) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("begin_height=%d must >= 0 and <= tip_height=%d", beginHeight, tipHeight));
+    }
+
+    int64_t endHeight = tipHeight;
+    if (params.size() > 2)
+        endHeight = params[2].get_int64();
+    if (endHeight < beginHeight || endHeight > tipHeight) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("end_height=%d must >= begin_height=%d and <= tip_height=%d",
+            endHeight, beginHeight, tipHeight));
+    }
+
+    int64_t maxCount = 500;
+    if (params.size() > 3) {
+        maxCount = params[3].get_int64();
+        if (maxCount < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("max_count=%d must >= 0", maxCount));
+    }
+
+    AddrTxCache::KeyType lastKey;
+    if (params.size() > 4) {
+        string lastPosInfo = RPC_PARAM::GetBinStrFromHex(params[4], "last_pos_info");
+        auto err = ADDR_TX_DB::ParseLastPos(lastPosInfo, keyId, lastKey);
+        if (err)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Invalid last_pos_info! %s", *err));
+        uint32_t lastHeight = ADDR_TX_DB::GetHeight(lastKey);
+        if (lastHeight < beginHeight || lastHeight > endHeight)
+            throw JSONRPCError(RPC_INVALID_PARAMS,
+                               strprintf("Invalid last_pos_info! height of last_pos_info is not in "
+                                         "range(begin=%d,end=%d) ",
+                                         beginHeight, endHeight));
+    }
+
+    ADDR_TX_DB::AddrTxList txs;
+    bool hasMore = false;
+    if (!pCdMan->pAddrTxCache->GetAddrTxs(keyId, beginHeight, endHeight, maxCount, lastKey, txs, hasMore)) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("get address txs error! begin_height=%d, end_height=%d",
+            beginHeight, endHeight));
+    }
+
+    string newLastPosInfo;
+    if (hasMore) {
+        auto err = ADDR_TX_DB::MakeLastPos(txs.back().first, newLastPosInfo);
+        if (err)
+            throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Make new last_pos_info error! %s", *err));
+    }
+
+    uint32_t backfillHeight = 0, backfillEndHeight = 0;
+    Array txArray;
+    for (const auto &item : txs) {
+        Object txObj;
+        txObj.push_back(Pair("txid", item.second.ToString()));
+        txObj.push_back(Pair("height", (int64_t)ADDR_TX_DB::GetHeight(item.first)));
+        txObj.push_back(Pair("index", (int64_t)ADDR_TX_DB::GetTxIndex(item.first)));
+        txArray.push_back(txObj);
+    }
+
+    Object obj;
+    obj.push_back(Pair("address", keyId.ToAddress()));
+    obj.push_back(Pair("begin_height", beginHeight));
+    obj.push_back(Pair("end_height", endHeight));
+    obj.push_back(Pair("has_more", hasMore));
+    obj.push_back(Pair("last_pos_info", HexStr(newLastPosInfo)));
+    obj.push_back(Pair("backfilling", pCdMan->pAddrTxCache->GetBackfillRange(backfillHeight, backfillEndHeight)));
+    obj.push_back(Pair("count", (int64_t)txs.size()));
+    obj.push_back(Pair("txs", txArray));
+    return obj;
+}
+
 static Value TestDisconnectBlock(int32_t number) {
     CBlock block;
     Object obj;
@@ -27,6 +27,7 @@ extern Value gettxdetail(const Array& params, bool fHelp);
 extern Value getclosedcdp(const Array& params, bool fHelp);
 extern Value sign(const Array& params, bool fHelp);
 extern Value getaccountinfo(const Array& params, bool fHelp);
+extern Value getaddrtxs(const Array& params, bool fHelp);
 extern Value disconnectblock(const Array& params, bool fHelp);
 extern Value reloadtxcache(const Array& params, bool fHelp);
 
@@ -139,10 +139,10 @@ Value vmexecutescript(const Array& params, bool fHelp) {
                            strprintf("input fee could not smaller than: %ld sawi", minFee));
     }
 
-    CBlockIndex *pTip      = chainActive.Tip();
-    uint32_t fuelRate      = GetElementForBurn(pTip);
-    uint32_t blockTime     = pTip->GetBlockTime();
-    uint32_t prevBlockTime = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
+    auto pTipContext       = GetChainTipContext();
+    uint32_t fuelRate      = pTipContext->fuel_rate;
+    uint32_t blockTime     = pTipContext->block_time;
+    uint32_t prevBlockTime = pTipContext->prev_block_time;
 
     auto spCW = std::make_shared<CCacheWrapper>(pCdMan);
     CKeyID srcKeyId;
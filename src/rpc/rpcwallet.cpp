@@ -736,6 +736,8 @@ Value getwalletinfo(const Array& params, bool fHelp) {
         );
     }
 
+    pWalletMain->SyncWithBlockNotify();
+
     Object obj;
 
     obj.push_back(Pair("wallet_version",    pWalletMain->GetVersion()));
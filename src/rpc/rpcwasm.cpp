@@ -6,6 +6,7 @@
 #include "commons/base58.h"
 #include "rpc/core/rpcserver.h"
 #include "rpc/core/rpccommons.h"
+#include "rpc/core/rpcstreamwriter.h"
 #include "init.h"
 #include "net.h"
 #include "netbase.h"
@@ -263,59 +264,70 @@ Value submitwasmcontractcalltx( const Array &params, bool fHelp ) {
 
 }
 
-Value gettablewasm( const Array &params, bool fHelp ) {
+// iterate the rows of the table in params, shared by gettablewasm and gettablewasm_stream
+template<typename RowFunc>
+static bool for_each_table_row( const Array &params, RowFunc row_func ) {
 
-    RESPONSE_RPC_HELP( fHelp || params.size() < 2 || params.size() > 4 , wasm::rpc::get_table_wasm_rpc_help_message)
-    RPCTypeCheck(params, list_of(str_type)(str_type));
+    auto database_account  = pCdMan->pAccountCache;
+    auto database_contract = pCdMan->pContractCache;
 
-    try{
-        auto database_account  = pCdMan->pAccountCache;
-        auto database_contract = pCdMan->pContractCache;
+    auto contract_name     = wasm::name(params[0].get_str());
+    auto contract_table    = wasm::name(params[1].get_str());
 
-        auto contract_name     = wasm::name(params[0].get_str());
-        auto contract_table    = wasm::name(params[1].get_str());
+    JSON_RPC_ASSERT(!is_native_contract(contract_name.value), RPC_INVALID_PARAMS,
+                    strprintf("rpcwasm.gettablewasmcontracttx, Cannot get table from native contract %s", contract_name.to_string().c_str()))
 
-        JSON_RPC_ASSERT(!is_native_contract(contract_name.value), RPC_INVALID_PARAMS,
-                        strprintf("rpcwasm.gettablewasmcontracttx, Cannot get table from native contract %s", contract_name.to_string().c_str()))
+    CAccount contract;
+    CUniversalContract contract_store;
+    get_contract(database_account, database_contract, contract_name, contract, contract_store );
+    std::vector<char> abi = std::vector<char>(contract_store.abi.begin(), contract_store.abi.end());
 
-        CAccount contract;
-        CUniversalContract contract_store;
-        get_contract(database_account, database_contract, contract_name, contract, contract_store );
-        std::vector<char> abi = std::vector<char>(contract_store.abi.begin(), contract_store.abi.end());
+    uint64_t numbers = default_query_rows;
+    if (params.size() > 2) numbers = std::atoi(params[2].get_str().data());
+
+    std::vector<char> key_prefix = wasm::pack(std::tuple(contract_name.value, contract_table.value));
+    string search_key(key_prefix.data(),key_prefix.size());
+    string start_key = (params.size() > 3) ? FromHex(params[3].get_str()) : "";
+
+    auto pContractDataIt = database_contract->CreateContractDataIterator(contract.regid, search_key);
+    JSON_RPC_ASSERT(pContractDataIt, RPC_INVALID_PARAMS,
+                    strprintf("rpcwasm.gettablewasmcontracttx, Cannot get table from contract %s", contract_name.to_string().c_str()))
+
+    bool hasMore = false;
+    for (pContractDataIt->SeekUpper(&start_key); pContractDataIt->IsValid(); pContractDataIt->Next()) {
+        if (pContractDataIt->GotCount() > numbers) {
+            hasMore = true;
+            break;
+        }
+        const string &key   = pContractDataIt->GetContractKey();
+        const string &value = pContractDataIt->GetValue();
+
+        //unpack value in bytes to json
+        std::vector<char> value_bytes(value.begin(), value.end());
+        json_spirit::Value value_json    = wasm::abi_serializer::unpack(abi, contract_table.value, value_bytes, max_serialization_time);
+        json_spirit::Object &object_json = value_json.get_obj();
+
+        //append key and value
+        object_json.push_back(Pair("key",   ToHex(key, "")));
+        object_json.push_back(Pair("value", ToHex(value, "")));
+
+        row_func(value_json);
+    }
 
-        uint64_t numbers = default_query_rows;
-        if (params.size() > 2) numbers = std::atoi(params[2].get_str().data());
+    return hasMore;
+}
 
-        std::vector<char> key_prefix = wasm::pack(std::tuple(contract_name.value, contract_table.value));
-        string search_key(key_prefix.data(),key_prefix.size());
-        string start_key = (params.size() > 3) ? FromHex(params[3].get_str()) : "";
+Value gettablewasm( const Array &params, bool fHelp ) {
 
-        auto pContractDataIt = database_contract->CreateContractDataIterator(contract.regid, search_key);
-        JSON_RPC_ASSERT(pContractDataIt, RPC_INVALID_PARAMS,
-                        strprintf("rpcwasm.gettablewasmcontracttx, Cannot get table from contract %s", contract_name.to_string().c_str()))
+    RESPONSE_RPC_HELP( fHelp || params.size() < 2 || params.size() > 4 , wasm::rpc::get_table_wasm_rpc_help_message)
+    RPCTypeCheck(params, list_of(str_type)(str_type));
 
-        bool                hasMore = false;
+    try{
         json_spirit::Object object_return;
         json_spirit::Array  rows_json;
-        for (pContractDataIt->SeekUpper(&start_key); pContractDataIt->IsValid(); pContractDataIt->Next()) {
-            if (pContractDataIt->GotCount() > numbers) {
-                hasMore = true;
-                break;
-            }
-            const string &key   = pContractDataIt->GetContractKey();
-            const string &value = pContractDataIt->GetValue();
-
-            //unpack value in bytes to json
-            std::vector<char> value_bytes(value.begin(), value.end());
-            json_spirit::Value value_json    = wasm::abi_serializer::unpack(abi, contract_table.value, value_bytes, max_serialization_time);
-            json_spirit::Object &object_json = value_json.get_obj();
-
-            //append key and value
-            object_json.push_back(Pair("key",   ToHex(key, "")));
-            object_json.push_back(Pair("value", ToHex(value, "")));
-
-            rows_json.push_back(value_json);
-        }
+        bool hasMore = for_each_table_row(params, [&](const json_spirit::Value &row) {
+            rows_json.push_back(row);
+        });
 
         object_return.push_back(Pair("rows", rows_json));
         object_return.push_back(Pair("more", hasMore));
@@ -325,6 +337,29 @@ Value gettablewasm( const Array &params, bool fHelp ) {
 
 }
 
+bool gettablewasm_stream( const Array &params, CJsonStreamWriter &writer ) {
+
+    // leave bad params to gettablewasm for the help message
+    if (params.size() < 2 || params.size() > 4)
+        return false;
+    RPCTypeCheck(params, list_of(str_type)(str_type));
+
+    try{
+        writer.BeginObject();
+        writer.Key("rows");
+        writer.BeginArray();
+        bool hasMore = for_each_table_row(params, [&](const json_spirit::Value &row) {
+            writer.Write(row);
+        });
+        writer.EndArray();
+        writer.Pair("more", hasMore);
+        writer.EndObject();
+        return true;
+
+    } JSON_RPC_CAPTURE_AND_RETHROW;
+
+}
+
 Value jsontobinwasm( const Array &params, bool fHelp ) {
 
     RESPONSE_RPC_HELP( fHelp || params.size() < 2 || params.size() > 4 , wasm::rpc::json_to_bin_wasm_rpc_help_message)
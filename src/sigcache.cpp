@@ -6,6 +6,8 @@
 
 #include "sigcache.h"
 
+#include "crypto/siphash.h"
+
 void CSignatureCache::ComputeEntry(uint256& entry, const uint256& sigHash,
                                    const std::vector<unsigned char>& vchSig,
                                    const CPubKey& pubKey) {
@@ -48,3 +50,60 @@ void CSignatureCache::Set(const uint256& sigHash, const std::vector<unsigned cha
 
     setValid.insert(entry);
 }
+
+size_t CPubKeyCache::KeyHasher::operator()(const KeyType& key) const {
+    // keys come from the network, salt the hash to keep the buckets balanced
+    return CSipHasher(k0, k1).Write(key.data(), key.size()).Finalize();
+}
+
+CPubKeyCache::CPubKeyCache()
+    : mapParsed(0, KeyHasher{GetRand(std::numeric_limits<uint64_t>::max()), GetRand(std::numeric_limits<uint64_t>::max())}),
+      nHits(0),
+      nMisses(0) {}
+
+bool CPubKeyCache::GetParsed(const CPubKey& pubKey, secp256k1_pubkey& parsed) {
+    static int64_t nMaxCacheSize = SysCfg().GetArg("-maxpubkeycachesize", DEFAULT_MAX_PUBKEY_CACHE_SIZE);
+    if (nMaxCacheSize <= 0 || pubKey.size() != CPubKey::COMPRESSED_PUBLIC_KEY_SIZE)
+        return pubKey.Parse(parsed);
+
+    KeyType key;
+    std::copy(pubKey.begin(), pubKey.end(), key.begin());
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        auto it = mapParsed.find(key);
+        if (it != mapParsed.end()) {
+            parsed = it->second;
+            nHits++;
+            return true;
+        }
+    }
+
+    nMisses++;
+    if (!pubKey.Parse(parsed))
+        return false;
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (static_cast<int64_t>(mapParsed.size()) >= nMaxCacheSize) {
+        // Evict a random entry, as the signature cache does.
+        size_t bucket = GetRand(mapParsed.bucket_count());
+        auto it       = mapParsed.begin(bucket);
+        if (it != mapParsed.end(bucket))
+            mapParsed.erase(it->first);
+    }
+    mapParsed.emplace(key, parsed);
+
+    return true;
+}
+
+bool CPubKeyCache::Verify(const CPubKey& pubKey, const uint256& sigHash, const std::vector<unsigned char>& vchSig) {
+    secp256k1_pubkey parsed;
+    if (!GetParsed(pubKey, parsed))
+        return false;
+
+    return CPubKey::Verify(parsed, sigHash, vchSig);
+}
+
+size_t CPubKeyCache::GetSize() {
+    std::unique_lock<std::mutex> lock(mtx);
+    return mapParsed.size();
+}
@@ -7,7 +7,10 @@
 #ifndef COIN_SIGCACHE_H
 #define COIN_SIGCACHE_H
 
+#include <array>
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "config/chainparams.h"
@@ -41,4 +44,40 @@ private:
                       const std::vector<unsigned char>& vchSig, const CPubKey& pubKey);
 };
 
+static const int64_t DEFAULT_MAX_PUBKEY_CACHE_SIZE = 10000;
+
+/**
+ * Cache of the parsed secp256k1 public keys, keyed by the compressed key bytes.
+ * Parsing a compressed key decompresses it, and the same few thousand account owner keys
+ * and delegate miner keys sign nearly all the txs, blocks and pbft messages we verify.
+ */
+class CPubKeyCache {
+private:
+    typedef std::array<uint8_t, CPubKey::COMPRESSED_PUBLIC_KEY_SIZE> KeyType;
+
+    struct KeyHasher {
+        uint64_t k0;
+        uint64_t k1;
+        size_t operator()(const KeyType& key) const;
+    };
+
+    std::unordered_map<KeyType, secp256k1_pubkey, KeyHasher> mapParsed;
+    std::mutex mtx;
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+public:
+    CPubKeyCache();
+
+    // Verify a DER signature of pubKey, parsing the key only if it is not cached yet
+    bool Verify(const CPubKey& pubKey, const uint256& sigHash, const std::vector<unsigned char>& vchSig);
+
+    uint64_t GetHits() const { return nHits; }
+    uint64_t GetMisses() const { return nMisses; }
+    size_t GetSize();
+
+private:
+    bool GetParsed(const CPubKey& pubKey, secp256k1_pubkey& parsed);
+};
+
 #endif  // COIN_SIGCACHE_H
\ No newline at end of file
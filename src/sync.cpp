@@ -7,6 +7,168 @@
 #include "commons/util/util.h"
 #include "logging.h"
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+
+std::atomic<bool> fLockProfiling(false);
+
+namespace {
+
+// the names and files are string literals, so a site is keyed by their pointers on the hot path
+struct CLockSiteKey
+{
+    const char* pszName;
+    const char* pszFile;
+    int nLine;
+
+    bool operator==(const CLockSiteKey& other) const
+    {
+        return pszName == other.pszName && pszFile == other.pszFile && nLine == other.nLine;
+    }
+};
+
+struct CLockSiteKeyHasher
+{
+    size_t operator()(const CLockSiteKey& key) const
+    {
+        return std::hash<const void*>()(key.pszName) ^ std::hash<const void*>()(key.pszFile) ^ (size_t)key.nLine * 31;
+    }
+};
+
+typedef std::unordered_map<CLockSiteKey, CLockSiteStats, CLockSiteKeyHasher> LockSiteMap;
+
+// bucket of one thread, its mutex is only contended while GetLockProfile() reads it
+struct CThreadLockProfile
+{
+    std::mutex cs;
+    LockSiteMap sites;
+};
+
+std::mutex cs_lockProfile;
+std::vector<std::shared_ptr<CThreadLockProfile>> threadLockProfiles;
+LockSiteMap exitedLockProfile;  // buckets of the threads that have exited
+
+void AddLockSiteStats(const CLockSiteStats& from, CLockSiteStats& to)
+{
+    to.acquisitions += from.acquisitions;
+    to.contentions += from.contentions;
+    to.tryFailures += from.tryFailures;
+    to.waitMicros += from.waitMicros;
+    to.maxWaitMicros = std::max(to.maxWaitMicros, from.maxWaitMicros);
+    to.holdMicros += from.holdMicros;
+    to.maxHoldMicros = std::max(to.maxHoldMicros, from.maxHoldMicros);
+}
+
+void MergeLockSites(const LockSiteMap& from, LockSiteMap& to)
+{
+    for (const auto& item : from)
+        AddLockSiteStats(item.second, to[item.first]);
+}
+
+class CThreadLockProfileHolder
+{
+public:
+    std::shared_ptr<CThreadLockProfile> pProfile = std::make_shared<CThreadLockProfile>();
+
+    CThreadLockProfileHolder()
+    {
+        std::lock_guard<std::mutex> lock(cs_lockProfile);
+        threadLockProfiles.push_back(pProfile);
+    }
+
+    ~CThreadLockProfileHolder()
+    {
+        std::lock_guard<std::mutex> lock(cs_lockProfile);
+        {
+            std::lock_guard<std::mutex> threadLock(pProfile->cs);
+            MergeLockSites(pProfile->sites, exitedLockProfile);
+        }
+        threadLockProfiles.erase(std::find(threadLockProfiles.begin(), threadLockProfiles.end(), pProfile));
+    }
+};
+
+CLockSiteStats& GetThreadLockSite(CThreadLockProfile& profile, const char* pszName, const char* pszFile, int nLine)
+{
+    return profile.sites[CLockSiteKey{pszName, pszFile, nLine}];
+}
+
+CThreadLockProfile& GetThreadLockProfile()
+{
+    thread_local CThreadLockProfileHolder holder;
+    return *holder.pProfile;
+}
+
+} // namespace
+
+void RecordLockProfile(const char* pszName, const char* pszFile, int nLine, bool fContended, int64_t nWaitMicros,
+                       int64_t nHoldMicros)
+{
+    uint64_t waitMicros = std::max<int64_t>(nWaitMicros, 0);
+    uint64_t holdMicros = std::max<int64_t>(nHoldMicros, 0);
+
+    CThreadLockProfile& profile = GetThreadLockProfile();
+    std::lock_guard<std::mutex> lock(profile.cs);
+    CLockSiteStats& stats = GetThreadLockSite(profile, pszName, pszFile, nLine);
+    stats.acquisitions++;
+    if (fContended) {
+        stats.contentions++;
+        stats.waitMicros += waitMicros;
+        stats.maxWaitMicros = std::max(stats.maxWaitMicros, waitMicros);
+    }
+    stats.holdMicros += holdMicros;
+    stats.maxHoldMicros = std::max(stats.maxHoldMicros, holdMicros);
+}
+
+void RecordLockTryFailure(const char* pszName, const char* pszFile, int nLine)
+{
+    CThreadLockProfile& profile = GetThreadLockProfile();
+    std::lock_guard<std::mutex> lock(profile.cs);
+    GetThreadLockSite(profile, pszName, pszFile, nLine).tryFailures++;
+}
+
+std::vector<CLockSiteStats> GetLockProfile()
+{
+    LockSiteMap sites;
+    {
+        std::lock_guard<std::mutex> lock(cs_lockProfile);
+        sites = exitedLockProfile;
+        for (const auto& pProfile : threadLockProfiles) {
+            std::lock_guard<std::mutex> threadLock(pProfile->cs);
+            MergeLockSites(pProfile->sites, sites);
+        }
+    }
+
+    // merge the sites by value, a header may pass its file name by different pointers from different units
+    std::map<std::tuple<std::string, std::string, int>, CLockSiteStats> merged;
+    for (const auto& item : sites) {
+        CLockSiteStats& stats = merged[std::make_tuple(item.first.pszName, item.first.pszFile, item.first.nLine)];
+        AddLockSiteStats(item.second, stats);
+    }
+
+    std::vector<CLockSiteStats> result;
+    result.reserve(merged.size());
+    for (auto& item : merged) {
+        item.second.lockName = std::get<0>(item.first);
+        item.second.file     = std::get<1>(item.first);
+        item.second.line     = std::get<2>(item.first);
+        result.push_back(std::move(item.second));
+    }
+    return result;
+}
+
+void ResetLockProfile()
+{
+    std::lock_guard<std::mutex> lock(cs_lockProfile);
+    exitedLockProfile.clear();
+    for (const auto& pProfile : threadLockProfiles) {
+        std::lock_guard<std::mutex> threadLock(pProfile->cs);
+        pProfile->sites.clear();
+    }
+}
+
 #ifdef DEBUG_LOCKCONTENTION
 void PrintLockContention(const char* pszName, const char* pszFile, int nLine)
 {
@@ -7,7 +7,12 @@
 #define COIN_SYNC_H
 
 #include "threadsafety.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
@@ -61,16 +66,106 @@ void static inline DeleteLock(void* cs) {}
 void PrintLockContention(const char* pszName, const char* pszFile, int nLine);
 #endif
 
+/**
+ * Runtime lock contention profiler of the LOCK/LOCK2/TRY_LOCK sections, toggled by -lockprofiling or the
+ * setlockprofiling RPC. When it is off an acquisition costs one relaxed atomic load. When it is on the wait
+ * and hold times are added to per-thread buckets keyed by the lock and the acquisition site, which
+ * GetLockProfile() merges on demand.
+ */
+extern std::atomic<bool> fLockProfiling;
+
+struct CLockSiteStats
+{
+    std::string lockName;
+    std::string file;
+    int line               = 0;
+    uint64_t acquisitions  = 0;
+    uint64_t contentions   = 0;  // acquisitions that had to wait for another thread
+    uint64_t tryFailures   = 0;  // TRY_LOCK that did not get the lock
+    uint64_t waitMicros    = 0;
+    uint64_t maxWaitMicros = 0;
+    uint64_t holdMicros    = 0;
+    uint64_t maxHoldMicros = 0;
+};
+
+void RecordLockProfile(const char* pszName, const char* pszFile, int nLine, bool fContended, int64_t nWaitMicros,
+                       int64_t nHoldMicros);
+void RecordLockTryFailure(const char* pszName, const char* pszFile, int nLine);
+// all the sites seen since startup or the last reset, merged across the threads
+std::vector<CLockSiteStats> GetLockProfile();
+void ResetLockProfile();
+
+/** Wait and hold time of one profiled acquisition */
+class CLockProfile
+{
+private:
+    const char* pszName = nullptr;
+    const char* pszFile = nullptr;
+    int nLine           = 0;
+    bool fContended     = false;
+    int64_t nStart      = 0;
+    int64_t nLocked     = 0;
+
+    static int64_t NowMicros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+public:
+    void Begin(const char* pszNameIn, const char* pszFileIn, int nLineIn)
+    {
+        pszName = pszNameIn;
+        pszFile = pszFileIn;
+        nLine   = nLineIn;
+        nStart  = NowMicros();
+    }
+
+    void Acquired(bool fContendedIn)
+    {
+        fContended = fContendedIn;
+        nLocked    = NowMicros();
+    }
+
+    void TryFailed()
+    {
+        RecordLockTryFailure(pszName, pszFile, nLine);
+        pszName = nullptr;
+    }
+
+    void End()
+    {
+        if (pszName == nullptr)
+            return;
+        RecordLockProfile(pszName, pszFile, nLine, fContended, nLocked - nStart, NowMicros() - nLocked);
+        pszName = nullptr;
+    }
+};
+
 /** Wrapper around boost::unique_lock<Mutex> */
 template<typename Mutex>
 class CMutexLock
 {
 private:
     boost::unique_lock<Mutex> lock;
+    CLockProfile profile;
+
+    void ProfiledEnter(const char* pszName, const char* pszFile, int nLine)
+    {
+        profile.Begin(pszName, pszFile, nLine);
+        bool fContended = !lock.try_lock();
+        if (fContended)
+            lock.lock();
+        profile.Acquired(fContended);
+    }
 
     void Enter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()));
+        if (fLockProfiling.load(std::memory_order_relaxed)) {
+            ProfiledEnter(pszName, pszFile, nLine);
+            return;
+        }
 #ifdef DEBUG_LOCKCONTENTION
         if (!lock.try_lock())
         {
@@ -85,9 +180,18 @@ private:
     bool TryEnter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()), true);
+        bool fProfiling = fLockProfiling.load(std::memory_order_relaxed);
+        if (fProfiling)
+            profile.Begin(pszName, pszFile, nLine);
         lock.try_lock();
         if (!lock.owns_lock())
             LeaveCritical();
+        if (fProfiling) {
+            if (lock.owns_lock())
+                profile.Acquired(false);
+            else
+                profile.TryFailed();
+        }
         return lock.owns_lock();
     }
 
@@ -102,8 +206,11 @@ public:
 
     ~CMutexLock()
     {
-        if (lock.owns_lock())
+        if (lock.owns_lock()) {
+            lock.unlock();
+            profile.End();
             LeaveCritical();
+        }
     }
 
     operator bool()
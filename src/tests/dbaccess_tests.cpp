@@ -9,6 +9,9 @@
 #include <map>
 #include <boost/test/unit_test.hpp>
 #include "persistence/dbaccess.h"
+#include "persistence/addrtxdb.h"
+#include "persistence/delegatedb.h"
+#include "config/chainparams.h"
 
 using namespace std;
 
@@ -60,6 +63,75 @@ BOOST_AUTO_TEST_CASE(dbaccess_test)
 
 }
 
+// the keys of the codec are the same bytes as of a CDataStream
+BOOST_AUTO_TEST_CASE(dbkey_codec_test)
+{
+    auto checkKey = [](const auto &key) {
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        ssKey.write("cdat", 4);
+        ssKey << key;
+        string keyStr = dbk::GenDbKey(dbk::CONTRACT_DATA, key);
+        BOOST_CHECK(keyStr == string(ssKey.begin(), ssKey.end()));
+
+        auto parsedKey = key;
+        db_util::SetEmpty(parsedKey);
+        BOOST_CHECK(dbk::ParseDbKey(keyStr, dbk::CONTRACT_DATA, parsedKey));
+        BOOST_CHECK(dbk::GenDbKey(dbk::CONTRACT_DATA, parsedKey) == keyStr);
+    };
+    checkKey(string("regid-1"));
+    checkKey(make_pair(string("regid-1"), dbk::CDBTailKey<512>(string(300, 'k')))); // larger than the stack buffer
+    checkKey(make_tuple(CFixedUInt32(100), (uint8_t)1, uint256S("01")));
+
+    // a truncated key is not read beyond its end
+    string shortKey("cdat\x05" "abc", 8);
+    string parsedKey;
+    BOOST_CHECK_THROW(dbk::ParseDbKey(shortKey, dbk::CONTRACT_DATA, parsedKey), std::ios_base::failure);
+}
+
+// key encoding of the CDataStream before against the codec, and the lookups per second with the codec
+BOOST_AUTO_TEST_CASE(dbkey_codec_throughput)
+{
+    const uint32_t COUNT = 200000;
+    const dbk::PrefixType prefix = dbk::REGID_KEYID;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(db_dir, DBNameType::ACCOUNT, false, true);
+    map<string, string> mapData;
+    for (uint32_t i = 0; i < 1000; i++)
+        mapData[strprintf("regid-%u", i)] = strprintf("keyid-%u", i);
+    pDBAccess->BatchWrite<string, string>(prefix, mapData);
+
+    size_t nSize = 0;
+    int64_t start = GetTimeMicros();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        const string &prefixStr = dbk::GetKeyPrefix(prefix);
+        ssKey.write(prefixStr.c_str(), prefixStr.size());
+        ssKey << make_pair(strprintf("regid-%u", i % 1000), uint256());
+        nSize += string(ssKey.begin(), ssKey.end()).size();
+    }
+    int64_t streamMicros = GetTimeMicros() - start;
+
+    start = GetTimeMicros();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        dbk::CDBKeyBuffer keyBuf;
+        dbk::GenDbKey(prefix, make_pair(strprintf("regid-%u", i % 1000), uint256()), keyBuf);
+        nSize += keyBuf.size();
+    }
+    int64_t codecMicros = GetTimeMicros() - start;
+
+    uint32_t nFound = 0;
+    start = GetTimeMicros();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        string value;
+        nFound += pDBAccess->GetData(prefix, strprintf("regid-%u", i % 1000), value);
+    }
+    int64_t lookupMicros = GetTimeMicros() - start;
+
+    BOOST_TEST_MESSAGE(strprintf("key encoding: CDataStream %d us, codec %d us for %u keys (%u bytes); "
+                                 "%d lookups/s", streamMicros, codecMicros, COUNT, nSize,
+                                 COUNT * 1000000LL / std::max<int64_t>(lookupMicros, 1)));
+    BOOST_CHECK(nFound == COUNT);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -144,4 +216,85 @@ BOOST_AUTO_TEST_CASE(dbcache_scalar_value_Level3_test)
     BOOST_CHECK( value1 == "keyid-1" );
 }
 
+BOOST_AUTO_TEST_CASE(addrtx_cache_range_test)
+{
+    const bool isWipe = true;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::ADDRTX, false, isWipe);
+    SysCfg().SetAddrIndex(true);
+
+    CKeyID keyId1(uint160S("01")), keyId2(uint160S("02"));
+    auto pDBCache1 = make_shared<CAddrTxDBCache>(pDBAccess.get());
+    for (uint32_t height = 1; height <= 3; ++height) {
+        pDBCache1->SetAddrTx(keyId1, height, 0, ArithToUint256(arith_uint256(height * 10)));
+        pDBCache1->SetAddrTx(keyId1, height, 1, ArithToUint256(arith_uint256(height * 10 + 1)));
+        pDBCache1->SetAddrTx(keyId2, height, 0, ArithToUint256(arith_uint256(height * 100)));
+    }
+    pDBCache1->Flush();
+
+    // level 2 cache is merged with the db while iterating
+    auto pDBCache2 = make_shared<CAddrTxDBCache>();
+    pDBCache2->SetBaseViewPtr(pDBCache1.get());
+    pDBCache2->SetAddrTx(keyId1, 4, 0, ArithToUint256(arith_uint256(40)));
+
+    ADDR_TX_DB::AddrTxList txs;
+    bool hasMore = false;
+    AddrTxCache::KeyType lastKey;
+    BOOST_CHECK(pDBCache2->GetAddrTxs(keyId1, 0, 4, 4, lastKey, txs, hasMore));
+    BOOST_CHECK(txs.size() == 4 && hasMore);
+    BOOST_CHECK(ADDR_TX_DB::GetHeight(txs[0].first) == 1 && ADDR_TX_DB::GetTxIndex(txs[0].first) == 0);
+    BOOST_CHECK(txs[3].second == ArithToUint256(arith_uint256(21)));
+
+    lastKey = txs.back().first;
+    BOOST_CHECK(pDBCache2->GetAddrTxs(keyId1, 0, 4, 4, lastKey, txs, hasMore));
+    BOOST_CHECK(txs.size() == 3 && !hasMore);
+    BOOST_CHECK(txs.back().second == ArithToUint256(arith_uint256(40)));
+
+    // the begin height includes the first tx of the block
+    lastKey = AddrTxCache::KeyType();
+    BOOST_CHECK(pDBCache2->GetAddrTxs(keyId2, 2, 2, 0, lastKey, txs, hasMore));
+    BOOST_CHECK(txs.size() == 1 && txs[0].second == ArithToUint256(arith_uint256(200)));
+}
+
+BOOST_AUTO_TEST_CASE(delegate_vote_board_test)
+{
+    const bool isWipe = true;
+    shared_ptr<CDBAccess> pDBAccess = make_shared<CDBAccess>(
+        db_dir, DBNameType::DELEGATE, false, isWipe);
+    const uint32_t delegateNum = IniCfg().GetTotalDelegateNum();
+
+    auto pDBCache1 = make_shared<CDelegateDBCache>(pDBAccess.get());
+    for (uint32_t i = 1; i <= delegateNum + 4; ++i) {
+        BOOST_CHECK(pDBCache1->SetDelegateVotes(CRegID(i, 1), i * 100));
+    }
+    pDBCache1->Flush();
+
+    VoteDelegateVector delegates;
+    BOOST_CHECK(pDBCache1->GetTopVoteDelegates(delegates));
+    BOOST_CHECK(delegates.size() == delegateNum);
+    BOOST_CHECK(delegates.front().regid == CRegID(delegateNum + 4, 1) && delegates.front().votes == (delegateNum + 4) * 100);
+
+    // the changes of level 2 cache are merged with the board
+    auto pDBCache2 = make_shared<CDelegateDBCache>();
+    pDBCache2->SetBaseViewPtr(pDBCache1.get());
+    BOOST_CHECK(pDBCache2->EraseDelegateVotes(CRegID(1, 1), 100));
+    BOOST_CHECK(pDBCache2->SetDelegateVotes(CRegID(1, 1), 10000));
+    BOOST_CHECK(pDBCache2->EraseDelegateVotes(CRegID(delegateNum + 4, 1), (delegateNum + 4) * 100));
+
+    delegates.clear();
+    BOOST_CHECK(pDBCache2->GetTopVoteDelegates(delegates));
+    BOOST_CHECK(delegates.size() == delegateNum);
+    BOOST_CHECK(delegates.front().regid == CRegID(1, 1) && delegates.front().votes == 10000);
+    BOOST_CHECK(delegates.back().regid == CRegID(5, 1));
+
+    // the board follows the db after flushing
+    pDBCache2->Flush();
+    pDBCache1->Flush();
+    delegates.clear();
+    BOOST_CHECK(pDBCache1->GetTopVoteDelegates(delegates));
+    BOOST_CHECK(delegates.size() == delegateNum);
+    BOOST_CHECK(delegates.front().regid == CRegID(1, 1));
+    BOOST_CHECK(delegates[1].regid == CRegID(delegateNum + 3, 1));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
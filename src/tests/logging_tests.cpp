@@ -0,0 +1,83 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "logging.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(logging_tests)
+
+static uint32_t LogFromThreads(BCLog::Logger &logger, uint32_t threadCount, uint32_t recordCount) {
+    vector<thread> threads;
+    for (uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back([&logger, i, recordCount] {
+            for (uint32_t j = 0; j < recordCount; j++)
+                logger.LogPrintStr(BCLog::INFO, __FILE__, __LINE__, tfm::format("thread %u record %u\n", i, j));
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    return threadCount * recordCount;
+}
+
+BOOST_AUTO_TEST_CASE(async_logging_block_policy) {
+    // the logger is leaked on purpose, as LogInstance() does
+    BCLog::Logger &logger = *(new BCLog::Logger());
+    logger.m_log_timestamps = false;
+
+    mutex cs;
+    vector<string> records;
+    logger.PushBackCallback([&cs, &records](const string &s) {
+        lock_guard<mutex> lock(cs);
+        records.push_back(s);
+    });
+    BOOST_CHECK(logger.StartLogging());
+
+    logger.StartAsyncLogging(1024, false);
+    BOOST_CHECK(logger.IsAsync());
+    uint32_t total = LogFromThreads(logger, 4, 5000);
+    logger.StopAsyncLogging();
+    BOOST_CHECK(!logger.IsAsync());
+
+    // nothing is lost and the records of each thread keep their order
+    BOOST_CHECK_EQUAL(records.size(), total);
+    BOOST_CHECK_EQUAL(logger.GetAsyncWritten(), total);
+    BOOST_CHECK_EQUAL(logger.GetAsyncDropped(), 0U);
+    vector<uint32_t> nextRecord(4, 0);
+    for (const auto &s : records) {
+        uint32_t i, j;
+        BOOST_REQUIRE(sscanf(s.c_str(), "[INFO] thread %u record %u", &i, &j) == 2);
+        BOOST_CHECK_EQUAL(j, nextRecord[i]++);
+    }
+
+    // back to the synchronous path
+    logger.LogPrintStr(BCLog::INFO, __FILE__, __LINE__, "sync\n");
+    BOOST_CHECK_EQUAL(records.back(), "[INFO] sync\n");
+}
+
+BOOST_AUTO_TEST_CASE(async_logging_drop_policy) {
+    BCLog::Logger &logger = *(new BCLog::Logger());
+    logger.m_log_timestamps = false;
+
+    atomic<uint32_t> received{0};
+    logger.PushBackCallback([&received](const string &s) { received++; });
+    BOOST_CHECK(logger.StartLogging());
+
+    logger.StartAsyncLogging(1024, true);
+    uint32_t total = LogFromThreads(logger, 4, 5000);
+    logger.StopAsyncLogging();
+
+    BOOST_CHECK_EQUAL(received + logger.GetAsyncDropped(), total);
+    BOOST_CHECK_EQUAL(logger.GetAsyncWritten(), received);
+    BOOST_CHECK_EQUAL(logger.GetAsyncBlocked(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,64 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "commons/perfstats.h"
+
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(perfstats_tests)
+
+BOOST_AUTO_TEST_CASE(perf_histogram_buckets) {
+    CPerfHistogram histogram;
+    BOOST_CHECK_EQUAL(histogram.GetPercentileMicros(0.99), 0U);
+
+    histogram.Record(0);
+    histogram.Record(1);
+    histogram.Record(1023);
+    histogram.Record(1024);
+    histogram.Record(-5);  // a clock going backwards counts as 0
+    BOOST_CHECK_EQUAL(histogram.GetBucket(0), 2U);
+    BOOST_CHECK_EQUAL(histogram.GetBucket(1), 1U);
+    BOOST_CHECK_EQUAL(histogram.GetBucket(10), 1U);
+    BOOST_CHECK_EQUAL(histogram.GetBucket(11), 1U);
+    BOOST_CHECK_EQUAL(histogram.GetCount(), 5U);
+    BOOST_CHECK_EQUAL(histogram.GetSumMicros(), 2048U);
+    BOOST_CHECK_EQUAL(histogram.GetMaxMicros(), 1024U);
+
+    // the huge values fall into the unbounded last bucket, reported by the max
+    histogram.Record(100000000);
+    BOOST_CHECK_EQUAL(histogram.GetBucket(CPerfHistogram::BUCKET_COUNT - 1), 1U);
+    BOOST_CHECK_EQUAL(CPerfHistogram::GetBucketBound(CPerfHistogram::BUCKET_COUNT - 1), 0U);
+    BOOST_CHECK_EQUAL(histogram.GetPercentileMicros(0.99), 100000000U);
+}
+
+BOOST_AUTO_TEST_CASE(perf_histogram_percentile) {
+    CPerfHistogram histogram;
+    for (uint32_t i = 0; i < 99; i++)
+        histogram.Record(100);  // bucket [64, 128)
+    histogram.Record(5000);     // bucket [4096, 8192)
+
+    BOOST_CHECK_EQUAL(histogram.GetPercentileMicros(0.50), 128U);
+    BOOST_CHECK_EQUAL(histogram.GetPercentileMicros(0.98), 128U);
+    BOOST_CHECK_EQUAL(histogram.GetPercentileMicros(0.999), 8192U);
+}
+
+BOOST_AUTO_TEST_CASE(perf_stats_net_message_cap) {
+    CPerfStats stats;
+    CPerfHistogram &tx = stats.GetNetMessage("tx");
+    BOOST_CHECK_EQUAL(&stats.GetNetMessage("tx"), &tx);
+
+    for (uint32_t i = 0; i < CPerfStats::MAX_NET_MESSAGE_COMMANDS * 2; i++)
+        stats.GetNetMessage("cmd" + to_string(i)).Record(1);
+
+    auto netMessages = stats.GetNetMessages();
+    BOOST_CHECK_EQUAL(netMessages.size(), CPerfStats::MAX_NET_MESSAGE_COMMANDS + 1);
+    BOOST_CHECK(netMessages.count("other"));
+    BOOST_CHECK_EQUAL(&stats.GetNetMessage("tx"), &tx);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
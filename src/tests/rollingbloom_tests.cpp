@@ -0,0 +1,109 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "commons/bloom.h"
+
+#include "commons/mruset.h"
+#include "commons/random.h"
+#include "commons/util/time.h"
+#include "p2p/protocol.h"
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(rollingbloom_tests)
+
+static vector<uint256> RandomHashes(uint32_t count) {
+    vector<uint256> hashes(count);
+    for (auto &hash : hashes)
+        GetRandBytes(hash.begin(), hash.size());
+    return hashes;
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom_recent_items) {
+    const uint32_t ITEMS = 1000;
+    CRollingBloomFilter filter(ITEMS, 0.000001);
+    vector<uint256> hashes = RandomHashes(ITEMS * 4);
+
+    for (uint32_t i = 0; i < hashes.size(); i++) {
+        filter.insert(hashes[i], MSG_TX);
+        BOOST_CHECK(filter.contains(hashes[i], MSG_TX));
+
+        // at least the last ITEMS inserted are always remembered
+        if (i >= ITEMS)
+            BOOST_CHECK(filter.contains(hashes[i - ITEMS + 1], MSG_TX));
+    }
+
+    // the extra value is a part of the key
+    uint32_t nFalsePositives = 0;
+    for (const auto &hash : hashes)
+        nFalsePositives += filter.contains(hash, MSG_BLOCK);
+    BOOST_CHECK(nFalsePositives < 10);
+
+    // the oldest items have been forgotten
+    uint32_t nOldFound = 0;
+    for (uint32_t i = 0; i < ITEMS; i++)
+        nOldFound += filter.contains(hashes[i], MSG_TX);
+    BOOST_CHECK(nOldFound < 10);
+
+    filter.reset();
+    uint32_t nFound = 0;
+    for (const auto &hash : hashes)
+        nFound += filter.contains(hash, MSG_TX);
+    BOOST_CHECK(nFound < 10);
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom_byte_keys) {
+    CRollingBloomFilter filter(100, 0.001);
+    vector<uint8_t> key1 = {1, 2, 3, 4, 5, 6};
+    vector<uint8_t> key2 = {1, 2, 3, 4, 5, 7};
+
+    filter.insert(key1);
+    BOOST_CHECK(filter.contains(key1));
+    BOOST_CHECK(!filter.contains(key2));
+
+    // the memory is allocated once on construction
+    size_t memoryUsage = filter.GetMemoryUsage();
+    for (uint8_t i = 0; i < 250; i++) {
+        key2[0] = i;
+        filter.insert(key2);
+    }
+    BOOST_CHECK_EQUAL(filter.GetMemoryUsage(), memoryUsage);
+}
+
+// insert/lookup throughput of the per-peer known inventory against the mruset it replaces
+BOOST_AUTO_TEST_CASE(rolling_bloom_vs_mruset_throughput) {
+    const uint32_t ITEMS = 10000;
+    const uint32_t COUNT = 200000;
+    vector<uint256> hashes = RandomHashes(COUNT);
+    uint32_t nFound = 0;
+
+    mruset<CInv> setKnown(ITEMS);
+    int64_t start = GetTimeMicros();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CInv inv(MSG_TX, hashes[i]);
+        if (!setKnown.count(inv))
+            setKnown.insert(inv);
+        nFound += setKnown.count(CInv(MSG_TX, hashes[i / 2]));
+    }
+    int64_t mrusetMicros = GetTimeMicros() - start;
+
+    CRollingBloomFilter filterKnown(ITEMS, 0.000001);
+    start = GetTimeMicros();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        if (!filterKnown.contains(hashes[i], MSG_TX))
+            filterKnown.insert(hashes[i], MSG_TX);
+        nFound += filterKnown.contains(hashes[i / 2], MSG_TX);
+    }
+    int64_t filterMicros = GetTimeMicros() - start;
+
+    BOOST_TEST_MESSAGE(strprintf("mruset: %d us, rolling bloom filter: %d us (%u bytes) for %u inserts and lookups, found=%u",
+                                 mrusetMicros, filterMicros, filterKnown.GetMemoryUsage(), COUNT, nFound));
+    BOOST_CHECK(nFound > 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
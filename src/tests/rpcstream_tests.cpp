@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/core/rpcstreamwriter.h"
+
+#include <chrono>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include "commons/json/json_spirit_writer_template.h"
+#include "commons/util/util.h"
+
+using namespace std;
+using namespace json_spirit;
+
+BOOST_AUTO_TEST_SUITE(rpc_stream_tests)
+
+static Object MakeEntry(uint32_t i) {
+    Object entry;
+    entry.push_back(Pair("size",     (int)(200 + i % 50)));
+    entry.push_back(Pair("fees",     (int64_t)i * 10000));
+    entry.push_back(Pair("memo",     "entry \"" + to_string(i) + "\"\n"));
+    entry.push_back(Pair("priority", i * 0.5));
+    entry.push_back(Pair("flags",    Array{Value(true), Value(false), Value::null}));
+    return entry;
+}
+
+static void WriteEntries(CJsonStreamWriter &writer, uint32_t count) {
+    writer.BeginObject();
+    writer.Key("rows");
+    writer.BeginArray();
+    for (uint32_t i = 0; i < count; i++)
+        writer.Write(MakeEntry(i));
+    writer.EndArray();
+    writer.Key("empty");
+    writer.BeginObject();
+    writer.EndObject();
+    writer.Pair("more", false);
+    writer.EndObject();
+}
+
+BOOST_AUTO_TEST_CASE(stream_writer_equal_test)
+{
+    for (uint32_t count : {0, 1, 7}) {
+        Object obj;
+        Array rows;
+        for (uint32_t i = 0; i < count; i++)
+            rows.push_back(MakeEntry(i));
+        obj.push_back(Pair("rows", rows));
+        obj.push_back(Pair("empty", Object()));
+        obj.push_back(Pair("more", false));
+
+        // a tiny chunk size flushes after every value
+        string streamed;
+        CJsonStreamWriter writer([&](const string &chunk) { streamed += chunk; }, 1);
+        WriteEntries(writer, count);
+        writer.Flush();
+
+        BOOST_CHECK_EQUAL(streamed, write_string(Value(obj), false));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stream_writer_bench_test)
+{
+    const uint32_t count = 100000;
+
+    auto start = chrono::steady_clock::now();
+    Object obj;
+    Array rows;
+    for (uint32_t i = 0; i < count; i++)
+        rows.push_back(MakeEntry(i));
+    obj.push_back(Pair("rows", rows));
+    obj.push_back(Pair("empty", Object()));
+    obj.push_back(Pair("more", false));
+    string strValue = write_string(Value(obj), false);
+    auto valueTime = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    uint64_t streamedBytes = 0;
+    uint32_t chunks = 0;
+    CJsonStreamWriter writer([&](const string &chunk) { streamedBytes += chunk.size(); chunks++; });
+    WriteEntries(writer, count);
+    writer.Flush();
+    auto streamTime = chrono::steady_clock::now() - start;
+
+    BOOST_CHECK_EQUAL(streamedBytes, strValue.size());
+    BOOST_CHECK(writer.GetMaxBufferSize() < DEFAULT_RPC_STREAM_CHUNK_SIZE + 1024);
+
+    BOOST_TEST_MESSAGE(strprintf("value writer: %llu bytes in %lld ms, whole reply held in memory",
+        strValue.size(), chrono::duration_cast<chrono::milliseconds>(valueTime).count()));
+    BOOST_TEST_MESSAGE(strprintf("stream writer: %llu bytes in %u chunks in %lld ms, max buffer %llu bytes",
+        streamedBytes, chunks, chrono::duration_cast<chrono::milliseconds>(streamTime).count(),
+        writer.GetMaxBufferSize()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sigcache.h"
+
+#include "commons/random.h"
+#include "commons/util/time.h"
+#include "entities/key.h"
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+struct PubKeyCacheTestingSetup {
+    ECCVerifyHandle verifyHandle;
+
+    PubKeyCacheTestingSetup() { ECC_Start(); }
+    ~PubKeyCacheTestingSetup() { ECC_Stop(); }
+};
+
+BOOST_FIXTURE_TEST_SUITE(sigcache_tests, PubKeyCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(pubkey_cache_verify) {
+    CKey key;
+    key.MakeNewKey(true);
+    CPubKey pubKey = key.GetPubKey();
+
+    uint256 hash = GetRandHash();
+    vector<unsigned char> vchSig;
+    BOOST_CHECK(key.Sign(hash, vchSig));
+
+    CPubKeyCache cache;
+    BOOST_CHECK(cache.Verify(pubKey, hash, vchSig));
+    BOOST_CHECK_EQUAL(cache.GetMisses(), 1U);
+    BOOST_CHECK_EQUAL(cache.GetHits(), 0U);
+
+    BOOST_CHECK(cache.Verify(pubKey, hash, vchSig));
+    BOOST_CHECK_EQUAL(cache.GetMisses(), 1U);
+    BOOST_CHECK_EQUAL(cache.GetHits(), 1U);
+    BOOST_CHECK_EQUAL(cache.GetSize(), 1U);
+
+    // a cached key still rejects a bad signature
+    uint256 otherHash = GetRandHash();
+    BOOST_CHECK(!cache.Verify(pubKey, otherHash, vchSig));
+    BOOST_CHECK_EQUAL(cache.GetHits(), 2U);
+
+    // invalid keys are never cached
+    CPubKey invalidKey;
+    BOOST_CHECK(!cache.Verify(invalidKey, hash, vchSig));
+    BOOST_CHECK_EQUAL(cache.GetSize(), 1U);
+}
+
+// verify throughput of a few signing keys with and without the parsed key cache
+BOOST_AUTO_TEST_CASE(pubkey_cache_verify_throughput) {
+    const uint32_t KEYS  = 11;
+    const uint32_t COUNT = 2000;
+
+    vector<CPubKey> pubKeys(KEYS);
+    vector<uint256> hashes(COUNT);
+    vector<vector<unsigned char>> sigs(COUNT);
+    for (uint32_t i = 0; i < KEYS; i++) {
+        CKey key;
+        key.MakeNewKey(true);
+        pubKeys[i] = key.GetPubKey();
+        for (uint32_t j = i; j < COUNT; j += KEYS) {
+            hashes[j] = GetRandHash();
+            BOOST_CHECK(key.Sign(hashes[j], sigs[j]));
+        }
+    }
+
+    int64_t start = GetTimeMicros();
+    for (uint32_t j = 0; j < COUNT; j++)
+        BOOST_CHECK(pubKeys[j % KEYS].Verify(hashes[j], sigs[j]));
+    int64_t uncachedMicros = GetTimeMicros() - start;
+
+    CPubKeyCache cache;
+    start = GetTimeMicros();
+    for (uint32_t j = 0; j < COUNT; j++)
+        BOOST_CHECK(cache.Verify(pubKeys[j % KEYS], hashes[j], sigs[j]));
+    int64_t cachedMicros = GetTimeMicros() - start;
+
+    BOOST_CHECK_EQUAL(cache.GetMisses(), KEYS);
+    BOOST_TEST_MESSAGE(strprintf("verify %u signatures of %u keys: %d us without cache, %d us with cache, hits=%u",
+                                 COUNT, KEYS, uncachedMicros, cachedMicros, cache.GetHits()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
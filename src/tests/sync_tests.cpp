@@ -0,0 +1,73 @@
+// Copyright (c) 2017-2019 The WaykiChain Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sync.h"
+
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(sync_tests)
+
+static const CLockSiteStats *FindLockSite(const vector<CLockSiteStats> &sites, const string &lockName) {
+    for (const auto &stats : sites) {
+        if (stats.lockName == lockName)
+            return &stats;
+    }
+    return nullptr;
+}
+
+BOOST_AUTO_TEST_CASE(lock_profiling) {
+    CCriticalSection cs_profiled;
+    ResetLockProfile();
+
+    // nothing is recorded while the profiler is off
+    {
+        LOCK(cs_profiled);
+    }
+    BOOST_CHECK(FindLockSite(GetLockProfile(), "cs_profiled") == nullptr);
+
+    fLockProfiling = true;
+    thread holder;
+    {
+        LOCK(cs_profiled);
+        holder = thread([&cs_profiled] {
+            TRY_LOCK(cs_profiled, lockProfiled);
+            BOOST_CHECK(!lockProfiled);
+            LOCK(cs_profiled);  // waits for the main thread
+        });
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    holder.join();
+    {
+        LOCK(cs_profiled);
+    }
+    fLockProfiling = false;
+
+    // the thread of the holder has exited, its bucket is kept
+    vector<CLockSiteStats> sites = GetLockProfile();
+    uint64_t acquisitions = 0, contentions = 0, tryFailures = 0, maxWaitMicros = 0, maxHoldMicros = 0;
+    for (const auto &stats : sites) {
+        if (stats.lockName != "cs_profiled")
+            continue;
+        BOOST_CHECK_EQUAL(stats.file, __FILE__);
+        acquisitions += stats.acquisitions;
+        contentions += stats.contentions;
+        tryFailures += stats.tryFailures;
+        maxWaitMicros = max(maxWaitMicros, stats.maxWaitMicros);
+        maxHoldMicros = max(maxHoldMicros, stats.maxHoldMicros);
+    }
+    BOOST_CHECK_EQUAL(acquisitions, 3U);
+    BOOST_CHECK_EQUAL(contentions, 1U);
+    BOOST_CHECK_EQUAL(tryFailures, 1U);
+    BOOST_CHECK(maxWaitMicros >= 10000);
+    BOOST_CHECK(maxHoldMicros >= 50000);
+
+    ResetLockProfile();
+    BOOST_CHECK(FindLockSite(GetLockProfile(), "cs_profiled") == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #ifndef COIN_BASETX_H
 #define COIN_BASETX_H
 
+#include "commons/perfstats.h"
 #include "commons/serialize.h"
 #include "commons/uint256.h"
 #include "entities/account.h"
@@ -161,6 +162,17 @@ protected:
     static bool AddInvolvedKeyIds(vector<CUserID> uids, CCacheWrapper &cw, set<CKeyID> &keyIds);
 };
 
+// CheckTx() and ExecuteTx() timed into the latency histograms of the tx type
+inline bool TimedCheckTx(CBaseTx &tx, CTxExecuteContext &context) {
+    CPerfTimer timer(perfStats.txCheck[tx.nTxType]);
+    return tx.CheckTx(context);
+}
+
+inline bool TimedExecuteTx(CBaseTx &tx, CTxExecuteContext &context) {
+    CPerfTimer timer(perfStats.txExecute[tx.nTxType]);
+    return tx.ExecuteTx(context);
+}
+
 /**################################ Universal Coin Transfer ########################################**/
 
 struct SingleTransfer {
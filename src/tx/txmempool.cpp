@@ -8,8 +8,11 @@
 #include "main.h"
 #include "persistence/txdb.h"
 #include "tx/tx.h"
+#include "tx/txserializer.h"
 #include "miner/miner.h"
 
+#include <algorithm>
+
 using namespace std;
 
 CTxMemPoolEntry::CTxMemPoolEntry() {
@@ -95,12 +98,10 @@ bool CTxMemPool::CheckTxInMemPool(const uint256 &txid, const CTxMemPoolEntry &me
     auto spCW = std::make_shared<CCacheWrapper>(cw.get());
 
     if (bExecute) {
-        CBlockIndex *pTip =  chainActive.Tip();
-        uint32_t fuelRate  = GetElementForBurn(pTip);
-        uint32_t blockTime = pTip->GetBlockTime();
-        uint32_t prevBlockTime = pTip->pprev != nullptr ? pTip->pprev->GetBlockTime() : pTip->GetBlockTime();
-        CTxExecuteContext context(chainActive.Height(), 0, fuelRate, blockTime, prevBlockTime, spCW.get(), &state, false, true);
-        if (!memPoolEntry.GetTransaction()->ExecuteTx(context)) {
+        auto pTipContext = GetChainTipContext();
+        CTxExecuteContext context(pTipContext->height, 0, pTipContext->fuel_rate, pTipContext->block_time,
+                                  pTipContext->prev_block_time, spCW.get(), &state, false, true);
+        if (!TimedExecuteTx(*memPoolEntry.GetTransaction(), context)) {
             pCdMan->pLogCache->SetExecuteFail(chainActive.Height(), memPoolEntry.GetTransaction()->GetHash(),
                                               state.GetRejectCode(), state.GetRejectReason());
             return false;
@@ -155,4 +156,114 @@ std::shared_ptr<CBaseTx> CTxMemPool::Lookup(const uint256 txid) const {
     if (i == memPoolTxs.end())
         return std::shared_ptr<CBaseTx>();
     return i->second.GetTransaction();
-}
\ No newline at end of file
+}
+
+// version of the mempool.dat layout, a file of another version is ignored
+static const int32_t MEMPOOL_DUMP_VERSION = 1;
+
+bool CTxMemPool::Dump(const boost::filesystem::path &path) const {
+    vector<CTxMemPoolDumpEntry> entries;
+    {
+        LOCK(cs);
+        entries.reserve(memPoolTxs.size());
+        for (const auto &item : memPoolTxs) {
+            CTxMemPoolDumpEntry entry;
+            entry.pTx    = item.second.GetTransaction();
+            entry.nTime  = item.second.GetTime();
+            entry.height = item.second.GetHeight();
+            entries.push_back(std::move(entry));
+        }
+    }
+    // the txs of an account depend on each other, keep the order they were accepted in
+    std::stable_sort(entries.begin(), entries.end(), [](const CTxMemPoolDumpEntry &a, const CTxMemPoolDumpEntry &b) {
+        return a.nTime < b.nTime;
+    });
+
+    // serialize entries, checksum data up to that point, then append csum
+    CDataStream ssPool(SER_DISK, CLIENT_VERSION);
+    ssPool << FLATDATA(SysCfg().MessageStart());
+    ssPool << MEMPOOL_DUMP_VERSION;
+    WriteCompactSize(ssPool, entries.size());
+    for (const auto &entry : entries) {
+        ssPool << entry.pTx;
+        ssPool << entry.nTime;
+        ssPool << entry.height;
+    }
+    uint256 hash = Hash(ssPool.begin(), ssPool.end());
+    ssPool << hash;
+
+    boost::filesystem::path pathTmp = path;
+    pathTmp += ".new";
+    FILE *file         = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout  = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!fileout)
+        return ERRORMSG("%s : Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        fileout << ssPool;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout);
+    fileout.fclose();
+
+    if (!RenameOver(pathTmp, path))
+        return ERRORMSG("%s : Rename-into-place failed", __func__);
+
+    LogPrint(BCLog::INFO, "Dumped %u txs of the mempool to %s\n", entries.size(), path.string());
+    return true;
+}
+
+bool CTxMemPool::ReadDump(const boost::filesystem::path &path, vector<CTxMemPoolDumpEntry> &entries) {
+    entries.clear();
+    if (!boost::filesystem::exists(path))
+        return false;
+
+    FILE *file       = fopen(path.string().c_str(), "rb");
+    CAutoFile filein = CAutoFile(file, SER_DISK, CLIENT_VERSION);
+    if (!filein)
+        return ERRORMSG("%s : Failed to open file %s", __func__, path.string());
+
+    int64_t dataSize = boost::filesystem::file_size(path) - sizeof(uint256);
+    if (dataSize < 0)
+        return ERRORMSG("%s : File %s is truncated", __func__, path.string());
+
+    vector<uint8_t> vchData(dataSize);
+    uint256 hashIn;
+    try {
+        filein.read((char *)vchData.data(), dataSize);
+        filein >> hashIn;
+    } catch (std::exception &e) {
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+    filein.fclose();
+
+    CDataStream ssPool(vchData, SER_DISK, CLIENT_VERSION);
+    if (hashIn != Hash(ssPool.begin(), ssPool.end()))
+        return ERRORMSG("%s : Checksum mismatch, data corrupted", __func__);
+
+    uint8_t pchMsgTmp[4];
+    int32_t version;
+    try {
+        ssPool >> FLATDATA(pchMsgTmp);
+        if (memcmp(pchMsgTmp, SysCfg().MessageStart(), sizeof(pchMsgTmp)))
+            return ERRORMSG("%s : Invalid network magic number", __func__);
+
+        ssPool >> version;
+        if (version != MEMPOOL_DUMP_VERSION)
+            return ERRORMSG("%s : Unsupported version %d of %s", __func__, version, path.string());
+
+        uint64_t count = ReadCompactSize(ssPool);
+        entries.resize(count);
+        for (auto &entry : entries) {
+            ssPool >> entry.pTx;
+            ssPool >> entry.nTime;
+            ssPool >> entry.height;
+        }
+    } catch (std::exception &e) {
+        entries.clear();
+        return ERRORMSG("%s : Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    return true;
+}
@@ -15,12 +15,25 @@
 #include <map>
 #include <memory>
 
+#include <boost/filesystem/path.hpp>
+
 using namespace std;
 
 class CValidationState;
 class CBaseTx;
 class uint256;
 
+static const char *const MEMPOOL_FILE_NAME         = "mempool.dat";
+static const bool DEFAULT_PERSIST_MEMPOOL          = true;
+static const int64_t DEFAULT_MEMPOOL_DUMP_INTERVAL = 900;  // seconds, 0 to dump only on shutdown
+
+/** A tx of mempool.dat with the time and height it entered the mempool */
+struct CTxMemPoolDumpEntry {
+    std::shared_ptr<CBaseTx> pTx;
+    int64_t nTime   = 0;
+    uint32_t height = 0;
+};
+
 /*
  * CTxMemPool stores these:
  */
@@ -83,6 +96,13 @@ public:
     bool Exists(const uint256 txid);
     std::shared_ptr<CBaseTx> Lookup(const uint256 txid) const;
 
+    /**
+     * Persist the txs of the pool in the order they entered it, so that a restarted node can put them back
+     * instead of waiting for the peers to relay them again. The txs are reloaded by LoadMempool().
+     */
+    bool Dump(const boost::filesystem::path &path) const;
+    static bool ReadDump(const boost::filesystem::path &path, vector<CTxMemPoolDumpEntry> &entries);
+
 private:
     bool fSanityCheck; // Normally false, true if -checkmempool or -regtest
 };
@@ -141,7 +141,7 @@ CWasmContractTx::get_accounts_from_signatures(CCacheWrapper& database, std::vect
         WASM_ASSERT(database.accountCache.GetAccount(nick_name(wasm::name(s.account).to_string()), account),
                     account_operation_exception, "%s",
                     "CWasmContractTx.get_accounts_from_signature, can not get account from public key")        
-        WASM_ASSERT(account.owner_pubkey.Verify(signature_hash, s.signature),
+        WASM_ASSERT(VerifySignature(signature_hash, s.signature, account.owner_pubkey),
                     account_operation_exception,
                     "%s",
                     "CWasmContractTx::get_accounts_from_signature, can not get public key from signature")
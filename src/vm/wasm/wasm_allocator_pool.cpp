@@ -0,0 +1,64 @@
+#include "wasm/wasm_allocator_pool.hpp"
+
+#include <sys/mman.h>
+#include <cstring>
+
+#include "commons/perfstats.h"
+
+namespace wasm {
+
+    void wasm_allocator_deleter::operator()(eosio::vm::wasm_allocator *walloc) const {
+        walloc->free();
+        delete walloc;
+    }
+
+    wasm_allocator_pool &wasm_allocator_pool::instance() {
+        static wasm_allocator_pool pool;
+        return pool;
+    }
+
+    wasm_allocator_ptr wasm_allocator_pool::acquire() {
+        perfStats.wasmAllocPool.acquired++;
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            if (!idle.empty()) {
+                wasm_allocator_ptr walloc = std::move(idle.back());
+                idle.pop_back();
+                perfStats.wasmAllocPool.reused++;
+                perfStats.wasmAllocPool.idle = idle.size();
+                return walloc;
+            }
+        }
+
+        return wasm_allocator_ptr(new eosio::vm::wasm_allocator());
+    }
+
+    void wasm_allocator_pool::release(wasm_allocator_ptr walloc) {
+        try {
+            // page is -1 after a module without memory, the allocator resets itself on the next use
+            int32_t pages = walloc->get_current_page();
+            if (pages > 0) {
+                char  *base = walloc->get_base_ptr<char>();
+                size_t size = pages * eosio::vm::page_size;
+#ifdef __linux__
+                walloc->free<char>(pages);
+                // private anonymous pages read as zero after MADV_DONTNEED on linux only
+                if (madvise(base, size, MADV_DONTNEED) != 0)
+                    return;
+#else
+                memset(base, 0, size);
+                walloc->free<char>(pages);
+#endif
+            }
+        } catch (eosio::vm::exception &e) {
+            // mprotect failed, the allocator is unmapped instead
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(cs);
+        if (idle.size() < max_idle_allocators)
+            idle.push_back(std::move(walloc));
+        perfStats.wasmAllocPool.idle = idle.size();
+    }
+
+}  // namespace wasm
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "eosio/vm/allocator.hpp"
+#include "eosio/vm/exceptions.hpp"
+
+namespace wasm {
+
+    // unmaps the reserved linear memory, which eosio::vm::wasm_allocator leaves to its owner
+    struct wasm_allocator_deleter {
+        void operator()(eosio::vm::wasm_allocator *walloc) const;
+    };
+
+    typedef std::unique_ptr<eosio::vm::wasm_allocator, wasm_allocator_deleter> wasm_allocator_ptr;
+
+    /**
+     * Pool of linear memory allocators, each of which reserves the max linear memory with mmap once.
+     * An allocator is handed out per wasm context, i.e. per action and inline transaction, and comes
+     * back when the context ends: the pages the module used are protected again and given back to
+     * the system with madvise(MADV_DONTNEED), which leaves them zero filled, instead of unmapping the
+     * whole reservation and mapping a new one for the next context.
+     */
+    class wasm_allocator_pool {
+    public:
+        // enough for the contexts nested by inline transactions, see max_inline_transaction_depth
+        static const size_t max_idle_allocators = 16;
+
+        static wasm_allocator_pool &instance();
+
+        wasm_allocator_ptr acquire();
+        void               release(wasm_allocator_ptr walloc);
+
+    private:
+        std::mutex                      cs;
+        std::vector<wasm_allocator_ptr> idle;
+    };
+
+}  // namespace wasm
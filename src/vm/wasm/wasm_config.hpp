@@ -25,6 +25,9 @@ namespace wasm {
     const static uint64_t wasmio_owner = N(wasmio.owner);
 
     const static uint64_t fuel_store_fee_per_byte = 600;
+    // an iteration step of the contract data, then the bytes of the key or value read
+    const static uint64_t fuel_db_iterate_fee      = 1000;
+    const static uint64_t fuel_db_read_fee_per_byte = 6;
 
 
     namespace wasm_constraints {
@@ -6,6 +6,8 @@
 #include "wasm/wasm_log.hpp"
 #include "entities/account.h"
 
+#include <mutex>
+
 using namespace std;
 using namespace wasm;
 // using std::chrono::microseconds;
@@ -122,13 +124,13 @@ namespace wasm {
 
     void wasm_context::initialize() {
 
-        static bool wasm_interface_inited = false;
-        if (!wasm_interface_inited) {
-            wasm_interface_inited = true;
+        // the contexts may run on several threads at once
+        static std::once_flag wasm_interface_inited;
+        std::call_once(wasm_interface_inited, [this]() {
             wasmif.initialize(wasm::vm_type::eos_vm_jit);
             register_native_handler(wasmio, N(setcode), wasmio_native_setcode);
             register_native_handler(wasmio_bank, N(transfer), wasmio_bank_native_transfer);
-        }
+        });
     }
 
     void wasm_context::execute(inline_transaction_trace &trace) {
@@ -164,6 +166,10 @@ namespace wasm {
         trace.trx      = trx;
         trace.receiver = _receiver;
 
+        // the iterators are over the data of the receiver
+        db_iterator_keys.clear();
+        db_iterator_handles.clear();
+
         auto native = find_native_handle(_receiver, trx.action);
 
         try {
@@ -254,4 +260,57 @@ namespace wasm {
 
     }
 
+    void wasm_context::update_iteration_usage(uint64_t size_in_bytes){
+
+        // charged by what the contract gets only, the same on every node whatever is cached or flushed
+        control_trx.nRunStep += fuel_db_iterate_fee + size_in_bytes * fuel_db_read_fee_per_byte;
+
+    }
+
+    bool wasm_context::next_data(uint64_t contract, string k, bool inclusive, string &next_k) {
+        CAccount contract_account;
+        wasm::name contract_name = wasm::name(contract);
+        WASM_ASSERT(database.accountCache.GetAccount(CNickID(contract_name.to_string()), contract_account),
+                    account_operation_exception,
+                    "wasm_context.next_data, contract account does not exist, contract = %s",
+                    contract_name.to_string().c_str())
+        WASM_ASSERT(k.size() <= CDBContractKey::MAX_KEY_SIZE, wasm_api_data_too_big, "%s",
+                    "key size too big")
+
+        string v;
+        if (inclusive && database.contractCache.GetContractData(contract_account.regid, k, v)) {
+            next_k = k;
+            return true;
+        }
+
+        std::vector<char> prefix = wasm::pack(contract);
+        auto pIt = database.contractCache.CreateContractDataIterator(contract_account.regid,
+                                                                     string(prefix.data(), prefix.size()));
+        if (!pIt || !pIt->SeekUpper(&k) || !pIt->IsValid())
+            return false;
+
+        next_k = pIt->GetContractKey();
+        return true;
+    }
+
+    bool wasm_context::previous_data(uint64_t contract, string k, string &prev_k) {
+        CAccount contract_account;
+        wasm::name contract_name = wasm::name(contract);
+        WASM_ASSERT(database.accountCache.GetAccount(CNickID(contract_name.to_string()), contract_account),
+                    account_operation_exception,
+                    "wasm_context.previous_data, contract account does not exist, contract = %s",
+                    contract_name.to_string().c_str())
+        WASM_ASSERT(k.size() <= CDBContractKey::MAX_KEY_SIZE, wasm_api_data_too_big, "%s",
+                    "key size too big")
+
+        std::vector<char> prefix = wasm::pack(contract);
+        auto pIt = database.contractCache.CreateContractDataIterator(contract_account.regid,
+                                                                     string(prefix.data(), prefix.size()));
+        if (!pIt || !pIt->SeekLower(k.empty() ? nullptr : &k) || !pIt->IsValid())
+            return false;
+
+        prev_k = pIt->GetContractKey();
+        return true;
+    }
+
 }
\ No newline at end of file
@@ -12,7 +12,7 @@
 #include "wasm/wasm_interface.hpp"
 #include "wasm/datastream.hpp"
 #include "wasm/wasm_trace.hpp"
-#include "eosio/vm/allocator.hpp"
+#include "wasm/wasm_allocator_pool.hpp"
 #include "persistence/cachewrapper.h"
 #include "entities/receipt.h"
 
@@ -36,7 +36,8 @@ namespace wasm {
         };
 
         ~wasm_context() {
-            wasm_alloc.free();
+            if (wasm_alloc)
+                wasm_allocator_pool::instance().release(std::move(wasm_alloc));
         };
 
     public:
@@ -101,6 +102,27 @@ namespace wasm {
             return database.contractCache.EraseContractData(contract_account.regid, k);
         }
 
+        // the keys of the contract data in order, the first key >= k or > k, the last key < k or of all if k is empty
+        bool next_data(uint64_t contract, string k, bool inclusive, string &next_k);
+        bool previous_data(uint64_t contract, string k, string &prev_k);
+
+        // the db iterators of the receiver are handles to their keys, the same key gets the same handle
+        int32_t cache_db_iterator(string k) {
+            auto it = db_iterator_handles.find(k);
+            if (it != db_iterator_handles.end())
+                return it->second;
+            int32_t iterator = db_iterator_keys.size();
+            db_iterator_handles.emplace(k, iterator);
+            db_iterator_keys.push_back(std::move(k));
+            return iterator;
+        }
+
+        const string* get_db_iterator(int32_t iterator) {
+            if (iterator < 0 || (size_t)iterator >= db_iterator_keys.size())
+                return nullptr;
+            return &db_iterator_keys[iterator];
+        }
+
         bool contracts_console() {
             return SysCfg().GetBoolArg("-contracts_console", false) && control_trx.validating_tx_in_mem_pool;
         }
@@ -109,9 +131,15 @@ namespace wasm {
             _pending_console_output << val;
         }
 
-        vm::wasm_allocator*       get_wasm_allocator() { return &wasm_alloc; }
+        vm::wasm_allocator*       get_wasm_allocator() {
+            // the native contracts run no module, take an allocator only for the first wasm call
+            if (!wasm_alloc)
+                wasm_alloc = wasm_allocator_pool::instance().acquire();
+            return wasm_alloc.get();
+        }
         std::chrono::milliseconds get_transaction_duration() { return transaction_duration_timeout; }
         void                      update_storage_usage(uint64_t account, int64_t size_in_bytes);
+        void                      update_iteration_usage(uint64_t size_in_bytes);
         void                      pause_billing_timer() { control_trx.pause_billing_timer(); };
         void                      resume_billing_timer() { control_trx.resume_billing_timer(); };
 
@@ -125,7 +153,7 @@ namespace wasm {
         vector<inline_transaction> inline_transactions;
 
         wasm::wasm_interface       wasmif;
-        vm::wasm_allocator         wasm_alloc;
+        wasm_allocator_ptr         wasm_alloc;
         uint64_t                   _receiver;
 
         std::chrono::milliseconds  transaction_duration_timeout = std::chrono::milliseconds(
@@ -133,5 +161,7 @@ namespace wasm {
 
     private:
         std::ostringstream         _pending_console_output;
+        vector<string>             db_iterator_keys;
+        map<string, int32_t>       db_iterator_handles;
     };
 }
@@ -34,6 +34,10 @@ namespace wasm {
         virtual bool set_data( uint64_t contract, string k, string v ) { return 0; }
         virtual bool get_data( uint64_t contract, string k, string &v ) { return 0; }
         virtual bool erase_data( uint64_t contract, string k ) { return 0; }
+        virtual bool next_data( uint64_t contract, string k, bool inclusive, string &next_k ) { return 0; }
+        virtual bool previous_data( uint64_t contract, string k, string &prev_k ) { return 0; }
+        virtual int32_t     cache_db_iterator( string k ) { return -1; }
+        virtual const string* get_db_iterator( int32_t iterator ) { return nullptr; }
         virtual bool contracts_console() { return true; }
         virtual void console_append( string val ) {}
         virtual bool is_account( uint64_t account ) { return true; }
@@ -44,6 +48,7 @@ namespace wasm {
         virtual vm::wasm_allocator*       get_wasm_allocator(){ return nullptr; }
         virtual std::chrono::milliseconds get_transaction_duration(){ return std::chrono::milliseconds(max_wasm_execute_time_observe); }
         virtual void update_storage_usage(uint64_t account, int64_t size_in_bytes){}
+        virtual void update_iteration_usage(uint64_t size_in_bytes){}
 
         virtual void pause_billing_timer(){};
         virtual void resume_billing_timer(){};
@@ -15,6 +15,8 @@
 
 #include "crypto/hash.h"
 
+#include <mutex>
+
 using namespace eosio;
 using namespace eosio::vm;
 
@@ -22,6 +24,7 @@ namespace wasm {
     using code_version       = uint256;
     using backend_validate_t = backend<wasm::wasm_context_interface, vm::interpreter>;
     using rhf_t              = eosio::vm::registered_host_functions<wasm_context_interface>;
+    std::mutex cs_wasm_instantiation_cache;
     std::map <code_version, std::shared_ptr<wasm_instantiated_module_interface>> wasm_instantiation_cache;
     std::shared_ptr <wasm_runtime_interface> runtime_interface;
 
@@ -34,18 +37,19 @@ namespace wasm {
 
     std::shared_ptr <wasm_instantiated_module_interface> get_instantiated_backend(const vector <uint8_t> &code) {
 
-        try {
-            auto code_id = Hash(code.begin(), code.end());
+        auto code_id = Hash(code.begin(), code.end());
+        {
+            std::lock_guard<std::mutex> lock(cs_wasm_instantiation_cache);
             auto it = wasm_instantiation_cache.find(code_id);
-            if (it == wasm_instantiation_cache.end()) {
-                wasm_instantiation_cache[code_id] = runtime_interface->instantiate_module((const char*)code.data(), code.size());
-                return wasm_instantiation_cache[code_id];
-            }
-            return it->second;
-        } catch (...) {
-            throw;
+            if (it != wasm_instantiation_cache.end())
+                return it->second;
         }
 
+        // parse the code outside the lock, the module of the first thread to finish is kept
+        auto pInstantiated_module = runtime_interface->instantiate_module((const char*)code.data(), code.size());
+        std::lock_guard<std::mutex> lock(cs_wasm_instantiation_cache);
+        return wasm_instantiation_cache.emplace(code_id, pInstantiated_module).first->second;
+
     }
 
     void wasm_interface::execute(const vector <uint8_t> &code, wasm_context_interface *pWasmContext) {
@@ -104,6 +108,20 @@ namespace wasm {
             k = string((const char *) key.data(), key.size()) + k;
         }
 
+        int32_t db_seek( const void *key, uint32_t key_len, bool inclusive ) {
+            WASM_ASSERT(key_len < max_wasm_api_data_size, wasm_api_data_too_big, "%s",
+                        "key size too big");
+
+            string k = string((const char *) key, key_len);
+            AddPrefix(pWasmContext->receiver(), k);
+
+            string next_k;
+            bool found = pWasmContext->next_data(pWasmContext->receiver(), k, inclusive, next_k);
+            pWasmContext->update_iteration_usage(next_k.size());
+
+            return found ? pWasmContext->cache_db_iterator(next_k) : db_end();
+        }
+
         //system
         void abort() {
             WASM_ASSERT(false, abort_called, "wasm-assert-fail:%s", "abort() called")
@@ -255,6 +273,79 @@ namespace wasm {
             return 1;
         }
 
+        // the iterators of the receiver data in key order, db_end() is after the last key
+        int32_t db_lowerbound( const void *key, uint32_t key_len ) {
+            return db_seek(key, key_len, true);
+        }
+
+        int32_t db_upperbound( const void *key, uint32_t key_len ) {
+            return db_seek(key, key_len, false);
+        }
+
+        int32_t db_end() {
+            return -1;
+        }
+
+        int32_t db_next( int32_t iterator ) {
+            WASM_ASSERT(iterator != db_end(), invalid_db_iterator_exception, "%s",
+                        "cannot increment the end iterator")
+            const string *pKey = pWasmContext->get_db_iterator(iterator);
+            WASM_ASSERT(pKey != nullptr, invalid_db_iterator_exception, "invalid iterator %d", iterator)
+
+            string next_k;
+            bool found = pWasmContext->next_data(pWasmContext->receiver(), *pKey, false, next_k);
+            pWasmContext->update_iteration_usage(next_k.size());
+
+            return found ? pWasmContext->cache_db_iterator(next_k) : db_end();
+        }
+
+        // the previous of db_end() is the last key, the previous of the first key is db_end()
+        int32_t db_previous( int32_t iterator ) {
+            string k;
+            if (iterator != db_end()) {
+                const string *pKey = pWasmContext->get_db_iterator(iterator);
+                WASM_ASSERT(pKey != nullptr, invalid_db_iterator_exception, "invalid iterator %d", iterator)
+                k = *pKey;
+            }
+
+            string prev_k;
+            bool found = pWasmContext->previous_data(pWasmContext->receiver(), k, prev_k);
+            pWasmContext->update_iteration_usage(prev_k.size());
+
+            return found ? pWasmContext->cache_db_iterator(prev_k) : db_end();
+        }
+
+        int32_t db_iterator_key( int32_t iterator, void *key, uint32_t key_len ) {
+            const string *pKey = pWasmContext->get_db_iterator(iterator);
+            WASM_ASSERT(pKey != nullptr, invalid_db_iterator_exception, "invalid iterator %d", iterator)
+
+            // without the receiver prefix added by db_store
+            const size_t prefix_size = sizeof(uint64_t);
+            auto size = pKey->size() - prefix_size;
+            if (key_len == 0) return size;
+
+            auto key_size = key_len > size ? size : key_len;
+            memcpy(key, pKey->data() + prefix_size, key_size);
+            return size;
+        }
+
+        int32_t db_iterator_value( int32_t iterator, void *val, uint32_t val_len ) {
+            const string *pKey = pWasmContext->get_db_iterator(iterator);
+            WASM_ASSERT(pKey != nullptr, invalid_db_iterator_exception, "invalid iterator %d", iterator)
+
+            string v;
+            WASM_ASSERT(pWasmContext->get_data(pWasmContext->receiver(), *pKey, v), invalid_db_iterator_exception,
+                        "the data of iterator %d was removed", iterator)
+            pWasmContext->update_iteration_usage(v.size());
+
+            auto size = v.size();
+            if (val_len == 0) return size;
+
+            auto val_size = val_len > size ? size : val_len;
+            memcpy(val, v.data(), val_size);
+            return size;
+        }
+
 
         //memory
         void *memcpy( void *dest, const void *src, int len ) {
@@ -764,6 +855,13 @@ namespace wasm {
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_remove, db_remove)
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_get, db_get)
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_update, db_update)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_lowerbound, db_lowerbound)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_upperbound, db_upperbound)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_end, db_end)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_next, db_next)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_previous, db_previous)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_iterator_key, db_iterator_key)
+    REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, db_iterator_value, db_iterator_value)
 
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, memcpy, memcpy)
     REGISTER_WASM_VM_INTRINSIC(wasm_host_methods, env, memmove, memmove)
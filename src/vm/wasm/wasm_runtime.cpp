@@ -3,6 +3,9 @@
 #include"wasm/wasm_runtime.hpp"
 #include"eosio/vm/watchdog.hpp"
 #include"wasm/wasm_log.hpp"
+
+#include <mutex>
+#include <vector>
 //#include"wasm_context.hpp"
 
 
@@ -22,18 +25,36 @@ namespace wasm {
         using backend_t = backend<wasm::wasm_context_interface, Impl>;
     public:
 
-        wasm_vm_instantiated_module(wasm_vm_runtime <Impl> *runtime, std::shared_ptr <backend_t> mod) :
-                _runtime(runtime),
-                _instantiated_module(std::move(mod)) {}
+        wasm_vm_instantiated_module(std::vector <uint8_t> code, std::shared_ptr <backend_t> mod) :
+                _code(std::move(code)) {
+            _idle_backends.push_back(std::move(mod));
+        }
+
+        static std::shared_ptr <backend_t> instantiate(const std::vector <uint8_t> &code) {
+            try {
+                wasm_code_ptr code_ptr((uint8_t *) code.data(), code.size());
+                std::shared_ptr <backend_t> bkend = std::make_shared<backend_t>(code_ptr, code.size());
+                registered_host_functions<wasm_context_interface>::resolve(bkend->get_module());
+                return bkend;
+            } catch (vm::exception &e) {
+                WASM_THROW(wasm_execution_error, "Error building eos-vm interp: %s", e.what());
+            }
+        }
 
         void apply(wasm::wasm_context_interface *pContext) override {
 
+            std::shared_ptr <backend_t> bkend = checkout();
+            auto checkin_guard = scope_guard{[&]() {
+                wasm_vm_runtime<Impl>::_bkend = nullptr;
+                checkin(std::move(bkend));
+            }};
+
             //WASM_TRACE("receiver:%d contract:%d action:%d",pContext->receiver(), pContext->contract(), pContext->action() )
-            _instantiated_module->set_wasm_allocator(pContext->get_wasm_allocator());
-            _runtime->_bkend = _instantiated_module.get();
-            _runtime->_bkend->initialize(pContext);
+            bkend->set_wasm_allocator(pContext->get_wasm_allocator());
+            wasm_vm_runtime<Impl>::_bkend = bkend.get();
+            bkend->initialize(pContext);
             // clamp WASM memory to maximum_linear_memory/wasm_page_size
-            auto &module = _runtime->_bkend->get_module();
+            auto &module = bkend->get_module();
             if (module.memories.size() &&
                 ((module.memories.at(0).limits.maximum >
                   wasm_constraints::maximum_linear_memory / wasm_constraints::wasm_page_size)
@@ -43,14 +64,14 @@ namespace wasm {
                         wasm_constraints::maximum_linear_memory / wasm_constraints::wasm_page_size;
             }
             auto fn = [&]() {
-                const auto &res = _runtime->_bkend->call(
+                const auto &res = bkend->call(
                         pContext, "env", "apply", pContext->receiver(),
                         pContext->contract(),
                         pContext->action());
             };
             try {
                 watchdog wd(pContext->get_transaction_duration());
-                _runtime->_bkend->timed_run(wd, fn);
+                bkend->timed_run(wd, fn);
             } catch (vm::timeout_exception &) {
                 //pContext->trx_pContext->checktime();
                 WASM_THROW(wasm_timeout_exception, "%s", "timeout exception");
@@ -61,19 +82,44 @@ namespace wasm {
                 // FIXME: Do better translation
                 WASM_THROW(wasm_execution_error, "%s", "something went wrong...");
             }
-            _runtime->_bkend = nullptr;
         }
 
     private:
-        wasm_vm_runtime <Impl> *_runtime;
-        std::shared_ptr <backend_t> _instantiated_module;
+        std::shared_ptr <backend_t> checkout() {
+            {
+                std::lock_guard <std::mutex> lock(_cs);
+                if (!_idle_backends.empty()) {
+                    std::shared_ptr <backend_t> bkend = std::move(_idle_backends.back());
+                    _idle_backends.pop_back();
+                    return bkend;
+                }
+            }
+            // every backend is running on another thread, build one more
+            return instantiate(_code);
+        }
+
+        void checkin(std::shared_ptr <backend_t> bkend) {
+            // the allocator belongs to the wasm context, which ends after the run
+            bkend->set_wasm_allocator(nullptr);
+            std::lock_guard <std::mutex> lock(_cs);
+            if (_idle_backends.size() < wasm_vm_runtime<Impl>::max_idle_backends)
+                _idle_backends.push_back(std::move(bkend));
+        }
+
+        const std::vector <uint8_t>                _code;
+        std::mutex                                 _cs;
+        std::vector <std::shared_ptr <backend_t>>  _idle_backends;
     };
 
+    template<typename Impl>
+    thread_local backend <wasm::wasm_context_interface, Impl> *wasm_vm_runtime<Impl>::_bkend = nullptr;
+
     template<typename Impl>
     wasm_vm_runtime<Impl>::wasm_vm_runtime() {}
 
     template<typename Impl>
     void wasm_vm_runtime<Impl>::immediately_exit_currently_running_module() {
+        // unwinds the module running on the calling thread only
         throw wasm_exit{};
     }
 
@@ -83,15 +129,9 @@ namespace wasm {
     template<typename Impl>
     std::shared_ptr <wasm_instantiated_module_interface>
     wasm_vm_runtime<Impl>::instantiate_module(const char *code_bytes, size_t code_size) {
-        using backend_t = backend<wasm::wasm_context_interface, Impl>;
-        try {
-            wasm_code_ptr code((uint8_t *) code_bytes, code_size);
-            std::shared_ptr <backend_t> bkend = std::make_shared<backend_t>(code, code_size);
-            registered_host_functions<wasm_context_interface>::resolve(bkend->get_module());
-            return std::make_shared<wasm_vm_instantiated_module<Impl>>(this, std::move(bkend));
-        } catch (vm::exception &e) {
-            WASM_THROW(wasm_execution_error, "Error building eos-vm interp: %s", e.what());
-        }
+        std::vector <uint8_t> code((const uint8_t *) code_bytes, (const uint8_t *) code_bytes + code_size);
+        auto bkend = wasm_vm_instantiated_module<Impl>::instantiate(code);
+        return std::make_shared<wasm_vm_instantiated_module<Impl>>(std::move(code), std::move(bkend));
     }
 
     template
@@ -20,16 +20,26 @@ namespace wasm {
       virtual ~wasm_runtime_interface();
    };
 
+    /**
+     * The instantiated module of a code keeps the code and a pool of backends built from it. Each apply()
+     * checks out a backend of its own, i.e. the parsed module, the execution context with its stack and
+     * the allocator of the wasm context, so any number of threads may run the same module at once.
+     * eos-vm binds the parsed module to its execution context, hence a backend per concurrent run.
+     */
     template<typename Backend>
     class wasm_vm_runtime : public wasm_runtime_interface{
     public:
+        // backends kept per module for the next runs, more are built while they are all in use
+        static const size_t max_idle_backends = 4;
+
         wasm_vm_runtime();
         std::shared_ptr <wasm_instantiated_module_interface> instantiate_module(const char *code_bytes, size_t code_size) override;
         void immediately_exit_currently_running_module() override;
         void validate(const vector <uint8_t> &code) override;
 
     public:
-        backend <wasm::wasm_context_interface, Backend> *_bkend = nullptr;  // non owning pointer to allow for immediate exit
+        // non owning pointer to the backend running on this thread, to allow for immediate exit
+        static thread_local backend <wasm::wasm_context_interface, Backend> *_bkend;
     };
 
 } //wasm
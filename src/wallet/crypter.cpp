@@ -211,6 +211,7 @@ bool CCryptoKeyStore::AddCryptedKey(const CPubKey& vchPubKey, const vector<unsig
         if (!SetCrypted())
             return false;
         mapCryptedKeys[vchPubKey.GetKeyId()] = make_pair(vchPubKey, vchCryptedSecret);
+        setKeyIds.insert(vchPubKey.GetKeyId());
     }
     return true;
 }
@@ -113,64 +113,132 @@ void CWallet::SyncTransaction(const uint256 &hash, CBaseTx *pTx, const CBlock *p
     assert(pTx != nullptr || pBlock != nullptr);
 
     if (hash.IsNull() && pTx == nullptr) {  // this is block Sync
-        uint256 blockhash         = pBlock->GetHash();
-        auto GenesisBlockProgress = [&]() {};
+        AssertLockHeld(cs_main);
+        uint256 blockhash = pBlock->GetHash();
+
+        CWalletBlockNotify notify;
+        notify.pBlock = std::make_shared<const CBlock>(*pBlock);
+        // Connect or disconnect, decided now since the active chain may have moved on when the block is synced
+        notify.fConnected = mapBlockIndex.count(blockhash) && chainActive.Contains(mapBlockIndex[blockhash]);
+
+        if (fAsyncBlockNotify) {
+            ++nBlockNotifyPushed;
+            blockNotifyQueue.Push(std::move(notify));
+        } else {
+            SyncBlocks({notify});
+        }
+    }
+}
+
+void CWallet::SyncBlocks(const vector<CWalletBlockNotify> &notifies) {
+    // txs of each block which are mine, resolving the involved key ids needs the account db
+    vector<vector<std::shared_ptr<CBaseTx> > > blockTxsMine(notifies.size());
+    {
+        LOCK(cs_main);
+        CCacheWrapper cw(pCdMan);
+        for (size_t i = 0; i < notifies.size(); i++) {
+            const CBlock &block = *notifies[i].pBlock;
+            if (SysCfg().GetGenesisBlockHash() == block.GetHash())
+                continue;
+
+            for (const auto &sptx : block.vptx) {
+                if (!notifies[i].fConnected && sptx->IsBlockRewardTx())
+                    continue;
+
+                if (IsMine(cw, sptx.get()))
+                    blockTxsMine[i].push_back(sptx);
+            }
+        }
+    }
+
+    // update the wallet, all the records of the blocks are written in one db txn
+    LOCK(cs_wallet);
+    CWalletDB walletdb(strWalletFile);
+    bool fTxn = walletdb.TxnBegin();
+    for (size_t i = 0; i < notifies.size(); i++) {
+        const CBlock &block = *notifies[i].pBlock;
+        uint256 blockhash   = block.GetHash();
+        if (SysCfg().GetGenesisBlockHash() == blockhash)
+            continue;
+
+        if (notifies[i].fConnected) {
+            CAccountTx netTx(this, blockhash, block.GetHeight());
+            for (const auto &sptx : blockTxsMine[i])
+                netTx.AddTx(sptx->GetHash(), sptx.get());
 
-        auto ConnectBlockProgress = [&]() {
-            CAccountTx netTx(this, blockhash, pBlock->GetHeight());
-            for (const auto &sptx : pBlock->vptx) {
+            for (const auto &sptx : block.vptx) {
                 uint256 txid = sptx->GetHash();
-                // confirm the tx is mine
-                if (IsMine(sptx.get())) {
-                    netTx.AddTx(txid, sptx.get());
-                }
                 if (unconfirmedTx.count(txid) > 0) {
-                    CWalletDB(strWalletFile).EraseUnconfirmedTx(txid);
+                    walletdb.EraseUnconfirmedTx(txid);
                     unconfirmedTx.erase(txid);
                 }
             }
             if (netTx.GetTxSize() > 0) {          // write to disk
                 mapInBlockTx[blockhash] = netTx;  // add to map
-                netTx.WriteToDisk();
+                walletdb.WriteBlockTx(blockhash, netTx);
             }
-        };
-
-        auto DisConnectBlockProgress = [&]() {
-            for (const auto &sptx : pBlock->vptx) {
-                if (sptx->IsBlockRewardTx()) {
-                    continue;
-                }
-                if (IsMine(sptx.get())) {
-                    unconfirmedTx[sptx.get()->GetHash()] = sptx.get()->GetNewInstance();
-                    CWalletDB(strWalletFile).WriteUnconfirmedTx(sptx.get()->GetHash(), unconfirmedTx[sptx.get()->GetHash()]);
-                }
+        } else {
+            for (const auto &sptx : blockTxsMine[i]) {
+                uint256 txid        = sptx->GetHash();
+                unconfirmedTx[txid] = sptx->GetNewInstance();
+                walletdb.WriteUnconfirmedTx(txid, unconfirmedTx[txid]);
             }
             if (mapInBlockTx.count(blockhash)) {
-                CWalletDB(strWalletFile).EraseBlockTx(blockhash);
+                walletdb.EraseBlockTx(blockhash);
                 mapInBlockTx.erase(blockhash);
             }
-        };
-
-        auto IsConnect = [&]() {  // Connect or disconnect
-            return mapBlockIndex.count(blockhash) && chainActive.Contains(mapBlockIndex[blockhash]);
-        };
-
-        {
-            LOCK2(cs_main, cs_wallet);
-            // GenesisBlock progress
-            if (SysCfg().GetGenesisBlockHash() == blockhash) {
-                GenesisBlockProgress();
-            } else if (IsConnect()) {
-                // connect block
-                ConnectBlockProgress();
-            } else {
-                // disconnect block
-                DisConnectBlockProgress();
+        }
+    }
+    if (fTxn && !walletdb.TxnCommit())
+        LogPrint(BCLog::ERROR, "SyncBlocks() : failed to commit the wallet records of %u blocks\n", notifies.size());
+}
+
+void CWallet::ThreadBlockNotify() {
+    RenameThread("coin-walletnotify");
+    fAsyncBlockNotify = true;
+
+    vector<CWalletBlockNotify> notifies;
+    auto PopNotifies = [&]() {
+        notifies.clear();
+        CWalletBlockNotify notify;
+        while (notifies.size() < WALLET_NOTIFY_MAX_BATCH_SIZE &&
+               blockNotifyQueue.Pop(&notify, notifies.empty() ? POP_DEFAULT_TIMEOUT : MsgQueue<CWalletBlockNotify>::Timeout(0))) {
+            notifies.push_back(std::move(notify));
+        }
+    };
+
+    try {
+        while (true) {
+            boost::this_thread::interruption_point();
+
+            PopNotifies();
+            if (!notifies.empty()) {
+                SyncBlocks(notifies);
+                nBlockNotifyDone += notifies.size();
             }
         }
+    } catch (boost::thread_interrupted &) {
+        // the blocks are synced inline from now on, wait for the one being notified under cs_main
+        // and then sync the queued ones, so that the wallet does not miss any block
+        boost::this_thread::disable_interruption noInterruption;
+        fAsyncBlockNotify = false;
+        { LOCK(cs_main); }
+        for (PopNotifies(); !notifies.empty(); PopNotifies()) {
+            SyncBlocks(notifies);
+            nBlockNotifyDone += notifies.size();
+        }
+
+        LogPrint(BCLog::WALLET, "wallet block notify thread interrupted\n");
+        throw;
     }
 }
 
+void CWallet::SyncWithBlockNotify() {
+    uint64_t nPushed = nBlockNotifyPushed;
+    while (fAsyncBlockNotify && nBlockNotifyDone < nPushed)
+        MilliSleep(10);
+}
+
 void CWallet::EraseTransaction(const uint256 &hash) {
     if (!fFileBacked)
         return;
@@ -464,15 +532,18 @@ uint256 CWallet::GetCheckSum() const {
 }
 
 bool CWallet::IsMine(CBaseTx *pTx) const {
-    auto spCW = std::make_shared<CCacheWrapper>(pCdMan);
+    CCacheWrapper cw(pCdMan);
+    return IsMine(cw, pTx);
+}
 
+bool CWallet::IsMine(CCacheWrapper &cw, CBaseTx *pTx) const {
     set<CKeyID> keyIds;
-    if (!pTx->GetInvolvedKeyIds(*spCW, keyIds)) {
+    if (!pTx->GetInvolvedKeyIds(cw, keyIds)) {
         return false;
     }
 
     for (auto &keyid : keyIds) {
-        if (HaveKey(keyid) > 0) {
+        if (MayHaveKey(keyid) && HaveKey(keyid)) {
             return true;
         }
     }
@@ -497,7 +568,9 @@ bool CWallet::CleanAll() {
         for_each(mapKeys.begin(), mapKeys.end(), [&](std::map<CKeyID, CKeyCombi>::reference item) {
             CWalletDB(strWalletFile).EraseKeyStoreValue(item.first);
         });
+        LOCK(cs_KeyStore);
         mapKeys.clear();
+        setKeyIds.clear();
     } else {
         return ERRORMSG("wallet is encrypted hence clear data forbidden!");
     }
@@ -576,8 +649,10 @@ bool CWallet::AddKey(const CKey &key) {
 
 bool CWallet::RemoveKey(const CKey &key) {
     CKeyID keyId = key.GetPubKey().GetKeyId();
+    LOCK(cs_KeyStore);
     mapKeys.erase(keyId);
     if (!IsEncrypted()) {
+        setKeyIds.erase(keyId);
         CWalletDB(strWalletFile).EraseKeyStoreValue(keyId);
     } else {
         return ERRORMSG("wallet is encrypted hence remove key forbidden!");
@@ -606,7 +681,11 @@ bool CWallet::ClearAllMainKeysForCoolMiner() {
     return true;
 }
 
-CWallet::CWallet(string strWalletFileIn) {
+CWallet::CWallet(string strWalletFileIn)
+    : blockNotifyQueue(WALLET_NOTIFY_QUEUE_SIZE),
+      fAsyncBlockNotify(false),
+      nBlockNotifyPushed(0),
+      nBlockNotifyDone(0) {
     SetNull();
     strWalletFile = strWalletFileIn;
     fFileBacked   = true;
@@ -28,6 +28,19 @@
 #include "tx/contracttx.h"
 #include "tx/delegatetx.h"
 #include "tx/accountregtx.h"
+#include "commons/messagequeue.h"
+
+#include <atomic>
+
+static const bool DEFAULT_ASYNC_WALLET_NOTIFY      = true;
+static const uint32_t WALLET_NOTIFY_QUEUE_SIZE     = 1000;  // max blocks queued for the wallet notify thread
+static const uint32_t WALLET_NOTIFY_MAX_BATCH_SIZE = 100;   // max blocks synced into the wallet in one db txn
+
+// A block connected to or disconnected from the active chain, queued for the wallet
+struct CWalletBlockNotify {
+    std::shared_ptr<const CBlock> pBlock;
+    bool fConnected = false;
+};
 
 enum WalletFeature {
     FEATURE_BASE        = 0,      // initialize version
@@ -49,6 +62,13 @@ private:
     CBlockLocator  bestBlock;
     uint256 GetCheckSum() const;
 
+    MsgQueue<CWalletBlockNotify> blockNotifyQueue;
+    std::atomic<bool> fAsyncBlockNotify;        // whether the blocks are synced by ThreadWalletNotify
+    std::atomic<uint64_t> nBlockNotifyPushed;
+    std::atomic<uint64_t> nBlockNotifyDone;
+
+    void SyncBlocks(const vector<CWalletBlockNotify> &notifies);
+
 public:
     CPubKey vchDefaultKey ;
 
@@ -118,6 +138,12 @@ public:
     void ResendWalletTransactions();
 
     bool IsMine(CBaseTx*pTx)const;
+    bool IsMine(CCacheWrapper &cw, CBaseTx *pTx) const;
+
+    // the block notify thread syncs the queued blocks into the wallet, off the block validation path
+    void ThreadBlockNotify();
+    // wait for the blocks queued so far to be synced into the wallet, call it without holding cs_main
+    void SyncWithBlockNotify();
 
     void SetBestChain(const CBlockLocator& loc);
 